@@ -0,0 +1,293 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtGlobal>
+
+#include "CameraPath.h"
+
+Benchmark::Benchmark(const QVector<RenderParams>& views) :
+    renderer(std::make_unique<FractalRenderer>(nullptr)),
+    views(views)
+{
+    // Errors are only reported while the renderer initializes, which completes before the first render returns
+    QObject::connect(renderer.get(), &FractalRenderer::statusChanged,
+        [=](const QString& message)
+        {
+            rendererError = message;
+        });
+
+    for (auto& view : this->views) {
+        view.viewportSize = QSize(RESOLUTION_WIDTH, RESOLUTION_HEIGHT);
+    }
+}
+
+Benchmark::~Benchmark()
+{
+    renderer->stop();
+}
+
+bool Benchmark::run(const QString& fileName, QString& error)
+{
+    if (views.isEmpty()) {
+        error = "There are no views to benchmark";
+        return false;
+    }
+
+    renderer->start();
+
+    // Warm up the driver so shader compilation is not attributed to the first section
+    QImage image;
+    renderer->renderImage(views.first(), image);
+
+    if (!rendererError.isEmpty()) {
+        error = rendererError;
+        return false;
+    }
+
+    QJsonObject report;
+    report["resolution"] = QJsonArray { RESOLUTION_WIDTH, RESOLUTION_HEIGHT };
+    report["repeatCount"] = REPEAT_COUNT;
+    report["viewCount"] = views.size();
+    report["levelOfDetail"] = runLevelOfDetail();
+    report["antiAliasing"] = runAntiAliasing();
+    report["cameraPath"] = runCameraPath();
+    report["heatmap"] = runHeatmap();
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = "Cannot open benchmark report \"" + fileName + "\" for writing";
+        return false;
+    }
+
+    file.write(QJsonDocument(report).toJson());
+
+    return true;
+}
+
+QJsonObject Benchmark::runLevelOfDetail()
+{
+    QVector<QImage> references;
+
+    // Full detail everywhere is the reference all other settings are compared against
+    const double referenceTime = renderViews([](RenderParams& params) { params.sceneLevelOfDetail = 0.0f; }, references);
+
+    QJsonArray results;
+
+    for (float levelOfDetail : { 0.0f, 0.5f, 1.0f, 2.0f, 4.0f }) {
+        QVector<QImage> images;
+        double time = referenceTime;
+
+        if (levelOfDetail > 0.0f) {
+            time = renderViews([=](RenderParams& params) { params.sceneLevelOfDetail = levelOfDetail; }, images);
+        } else {
+            images = references;
+        }
+
+        const double psnr = getPeakSignalToNoiseRatio(images, references);
+        const double speedup = referenceTime / std::max(time, 1e-6);
+
+        QJsonObject result;
+        result["levelOfDetail"] = levelOfDetail;
+        result["milliseconds"] = time;
+        result["speedup"] = speedup;
+        result["psnr"] = psnr;
+
+        results.append(result);
+
+        qInfo("Level of detail %4.2f: %8.2f ms, %5.2fx speedup, %6.2f dB PSNR", levelOfDetail, time, speedup, psnr);
+    }
+
+    QJsonObject section;
+    section["results"] = results;
+
+    return section;
+}
+
+QJsonObject Benchmark::runAntiAliasing()
+{
+    QVector<QImage> references;
+
+    // Uniform 3x3 supersampling is the export quality adaptive anti-aliasing has to match
+    const double referenceTime = renderViews([](RenderParams& params)
+        {
+            params.sceneAdaptiveAntiAliasing = false;
+            params.sceneAntiAliasingSamples = 3.0f;
+        }, references);
+
+    QJsonArray results;
+
+    for (float samples : { 2.0f, 3.0f, 4.0f }) {
+        QVector<QImage> images;
+
+        const double time = renderViews([=](RenderParams& params)
+            {
+                params.sceneAdaptiveAntiAliasing = true;
+                params.sceneAntiAliasingSamples = samples;
+            }, images);
+
+        const double psnr = getPeakSignalToNoiseRatio(images, references);
+        const double speedup = referenceTime / std::max(time, 1e-6);
+
+        QJsonObject result;
+        result["samples"] = samples;
+        result["milliseconds"] = time;
+        result["speedup"] = speedup;
+        result["psnr"] = psnr;
+
+        results.append(result);
+
+        qInfo("Adaptive anti-aliasing %.0fx%.0f: %8.2f ms, %5.2fx speedup, %6.2f dB PSNR",
+            samples, samples, time, speedup, psnr);
+    }
+
+    QJsonObject section;
+    section["referenceMilliseconds"] = referenceTime;
+    section["results"] = results;
+
+    return section;
+}
+
+QJsonObject Benchmark::runCameraPath()
+{
+    QJsonArray results;
+
+    for (int32_t waypointCount : { 1000, 10000, 100000 }) {
+        // A random walk with gently changing look directions, like a long procedurally generated flight
+        std::mt19937 random(CAMERA_PATH_SEED);
+        std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+        CameraPath path;
+        QVector3D position;
+        QVector3D rotation;
+
+        for (int32_t i = 0; i < waypointCount; ++i) {
+            position += QVector3D(distribution(random), distribution(random), distribution(random));
+            rotation += QVector3D(distribution(random), distribution(random), distribution(random)) * 0.1f;
+
+            path.addWaypoint(position, rotation);
+        }
+
+        double milliseconds[2] = {};
+        float arcLength[2] = {};
+
+        // The single threaded compile is the reference the parallel compile is compared against
+        for (int32_t threads = 0; threads < 2; ++threads) {
+            for (int32_t j = 0; j < REPEAT_COUNT; ++j) {
+                QElapsedTimer timer;
+                timer.start();
+
+                path.compile(threads == 0 ? 1 : 0);
+
+                milliseconds[threads] += timer.nsecsElapsed() / 1e6 / REPEAT_COUNT;
+            }
+
+            arcLength[threads] = path.getArcLength();
+        }
+
+        const double speedup = milliseconds[0] / std::max(milliseconds[1], 1e-6);
+        const double relativeError = std::abs(arcLength[1] - arcLength[0]) / std::max(arcLength[0], 1e-6f);
+
+        QJsonObject result;
+        result["waypoints"] = waypointCount;
+        result["serialMilliseconds"] = milliseconds[0];
+        result["parallelMilliseconds"] = milliseconds[1];
+        result["speedup"] = speedup;
+        result["arcLengthRelativeError"] = relativeError;
+
+        results.append(result);
+
+        qInfo("Camera path %6d waypoints: %8.2f ms serial, %8.2f ms parallel, %5.2fx speedup",
+            waypointCount, milliseconds[0], milliseconds[1], speedup);
+    }
+
+    QJsonObject section;
+    section["results"] = results;
+
+    return section;
+}
+
+QJsonObject Benchmark::runHeatmap()
+{
+    QJsonArray results;
+
+    for (int32_t i = 0; i < views.size(); ++i) {
+        RenderParams params = views[i];
+        params.sceneHeatmap = FractalRenderer::HEATMAP_MARCH_STEPS;
+
+        QImage image;
+        HeatmapStatistics statistics;
+
+        const double milliseconds = renderer->renderImage(params, image, &statistics) / 1e6;
+
+        QJsonObject result = statistics.toJson();
+        result["view"] = i;
+        result["milliseconds"] = milliseconds;
+
+        results.append(result);
+
+        qInfo("View %3d: %8.2f ms, %s", i, milliseconds, qPrintable(statistics.getSummary()));
+    }
+
+    QJsonObject section;
+    section["results"] = results;
+
+    return section;
+}
+
+template <typename Function>
+double Benchmark::renderViews(Function&& modify, QVector<QImage>& images)
+{
+    images.resize(views.size());
+
+    qint64 elapsed = 0;
+
+    for (int32_t i = 0; i < views.size(); ++i) {
+        RenderParams params = views[i];
+        modify(params);
+
+        for (int32_t j = 0; j < REPEAT_COUNT; ++j) {
+            elapsed += renderer->renderImage(params, images[i]);
+        }
+    }
+
+    return elapsed / 1e6 / (views.size() * REPEAT_COUNT);
+}
+
+double Benchmark::getPeakSignalToNoiseRatio(const QVector<QImage>& images, const QVector<QImage>& references)
+{
+    double squaredError = 0.0;
+    qint64 count = 0;
+
+    for (int32_t i = 0; i < images.size(); ++i) {
+        const QImage a = images[i].convertToFormat(QImage::Format_RGB32);
+        const QImage b = references[i].convertToFormat(QImage::Format_RGB32);
+
+        for (int32_t y = 0; y < a.height(); ++y) {
+            const QRgb* lineA = reinterpret_cast<const QRgb*>(a.constScanLine(y));
+            const QRgb* lineB = reinterpret_cast<const QRgb*>(b.constScanLine(y));
+
+            for (int32_t x = 0; x < a.width(); ++x) {
+                const double red = qRed(lineA[x]) - qRed(lineB[x]);
+                const double green = qGreen(lineA[x]) - qGreen(lineB[x]);
+                const double blue = qBlue(lineA[x]) - qBlue(lineB[x]);
+
+                squaredError += red * red + green * green + blue * blue;
+                count += 3;
+            }
+        }
+    }
+
+    if (squaredError == 0.0 || count == 0) {
+        return PSNR_MAX;
+    }
+
+    return std::min(10.0 * std::log10(255.0 * 255.0 / (squaredError / count)), PSNR_MAX);
+}
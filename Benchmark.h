@@ -0,0 +1,98 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <memory>
+
+#include <QImage>
+#include <QJsonObject>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+#include "FractalRenderer.h"
+#include "HeatmapStatistics.h"
+#include "RenderParams.h"
+
+/// \brief
+///     The benchmark renders a fixed set of views offscreen at a fixed resolution and writes a JSON report measuring
+///     the render time and image quality of the renderer. Every section of the report measures a single renderer
+///     feature by comparing renders with the feature tuned in various ways against a reference render.
+class Benchmark
+{
+public:
+
+    /// The resolution every view is rendered at.
+    static constexpr int32_t RESOLUTION_WIDTH = 640;
+    static constexpr int32_t RESOLUTION_HEIGHT = 360;
+
+    /// The number of times every view is rendered. The mean render time is reported.
+    static constexpr int32_t REPEAT_COUNT = 3;
+
+    /// The peak signal-to-noise ratio reported for images identical to the reference.
+    static constexpr double PSNR_MAX = 100.0;
+
+    /// The seed of the random walks the synthetic camera paths follow, so every run compiles the same paths.
+    static constexpr quint32 CAMERA_PATH_SEED = 1;
+
+public:
+
+    /// \brief
+    ///     Create a new benchmark of the specified views. Must be called on the GUI thread.
+    explicit Benchmark(const QVector<RenderParams>& views);
+
+    ~Benchmark();
+
+    /// \brief
+    ///     Runs all benchmark sections and writes the report to the specified file. A summary is also printed.
+    /// \param error
+    ///     The error message if the benchmark failed.
+    /// \return
+    ///     true if the benchmark completed and the report was written; false otherwise.
+    bool run(const QString& fileName, QString& error);
+
+private:
+
+    /// \brief
+    ///     Measures the render time and quality of various level of detail settings against full detail.
+    QJsonObject runLevelOfDetail();
+
+    /// \brief
+    ///     Measures the render time and quality of adaptive anti-aliasing against uniform 3x3 supersampling.
+    QJsonObject runAntiAliasing();
+
+    /// \brief
+    ///     Measures the time it takes to compile synthetic camera paths of various lengths on a single thread and on
+    ///     all hardware threads.
+    QJsonObject runCameraPath();
+
+    /// \brief
+    ///     Reports the heatmap statistics of every view, i.e. how many march steps its rays and its shadow and
+    ///     lighting rays take and how they are distributed across the pixels.
+    QJsonObject runHeatmap();
+
+    /// \brief
+    ///     Renders all views with the specified modification applied on top of each view.
+    /// \param images
+    ///     The last render of every view.
+    /// \return
+    ///     The mean time in milliseconds it took to render a view.
+    template <typename Function>
+    double renderViews(Function&& modify, QVector<QImage>& images);
+
+    /// \brief
+    ///     Computes the peak signal-to-noise ratio in decibels of a set of images against a set of reference images.
+    static double getPeakSignalToNoiseRatio(const QVector<QImage>& images, const QVector<QImage>& references);
+
+private:
+
+    /// The offscreen renderer drawing all views.
+    std::unique_ptr<FractalRenderer> renderer;
+
+    /// The views being rendered.
+    QVector<RenderParams> views;
+
+    /// The last error reported by the renderer.
+    QString rendererError;
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,160 @@
+#include "BlueNoise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    /// The standard deviation in pixels of the Gaussian used to measure how clustered the set pixels are.
+    constexpr float SIGMA = 1.5f;
+
+    /// The fraction of pixels set in the initial random pattern.
+    constexpr float INITIAL_DENSITY = 0.1f;
+
+    /// \brief
+    ///     A binary pattern on a torus along with the Gaussian energy every pixel receives from all set pixels. Set
+    ///     pixels with a high energy lie in a cluster and unset pixels with a low energy lie in a void.
+    class Pattern
+    {
+    public:
+
+        explicit Pattern(int32_t size) :
+            size(size),
+            kernel(size * size),
+            bits(size * size, 0),
+            energy(size * size, 0.0f)
+        {
+            for (int32_t y = 0; y < size; ++y) {
+                for (int32_t x = 0; x < size; ++x) {
+                    const float dx = std::min(x, size - x);
+                    const float dy = std::min(y, size - y);
+                    kernel[y * size + x] = std::exp(-(dx * dx + dy * dy) / (2.0f * SIGMA * SIGMA));
+                }
+            }
+        }
+
+        void set(int32_t index, bool value)
+        {
+            bits[index] = value;
+
+            const float sign = value ? 1.0f : -1.0f;
+            const int32_t px = index % size;
+            const int32_t py = index / size;
+
+            for (int32_t y = 0; y < size; ++y) {
+                const float* kernelRow = &kernel[((y - py + size) % size) * size];
+                float* energyRow = &energy[y * size];
+
+                for (int32_t x = 0; x < size; ++x) {
+                    energyRow[x] += sign * kernelRow[(x - px + size) % size];
+                }
+            }
+        }
+
+        bool get(int32_t index) const
+        {
+            return bits[index] != 0;
+        }
+
+        int32_t getTightestCluster() const
+        {
+            int32_t result = -1;
+
+            for (int32_t i = 0; i < static_cast<int32_t>(bits.size()); ++i) {
+                if (bits[i] && (result == -1 || energy[i] > energy[result])) {
+                    result = i;
+                }
+            }
+
+            return result;
+        }
+
+        int32_t getLargestVoid() const
+        {
+            int32_t result = -1;
+
+            for (int32_t i = 0; i < static_cast<int32_t>(bits.size()); ++i) {
+                if (!bits[i] && (result == -1 || energy[i] < energy[result])) {
+                    result = i;
+                }
+            }
+
+            return result;
+        }
+
+    private:
+
+        int32_t size;
+        std::vector<float> kernel;
+        std::vector<uint8_t> bits;
+        std::vector<float> energy;
+    };
+}
+
+QImage BlueNoise::generate(int32_t size, quint32 seed)
+{
+    const int32_t count = size * size;
+    const int32_t initialCount = std::max(1, static_cast<int32_t>(count * INITIAL_DENSITY));
+
+    Pattern pattern(size);
+
+    // Start from a random pattern
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int32_t> distribution(0, count - 1);
+
+    for (int32_t placed = 0; placed < initialCount;) {
+        const int32_t index = distribution(random);
+
+        if (!pattern.get(index)) {
+            pattern.set(index, true);
+            ++placed;
+        }
+    }
+
+    // Move pixels from the tightest cluster into the largest void until that no longer changes the pattern
+    for (int32_t i = 0; i < count; ++i) {
+        const int32_t cluster = pattern.getTightestCluster();
+        pattern.set(cluster, false);
+
+        const int32_t hole = pattern.getLargestVoid();
+        pattern.set(hole, true);
+
+        if (hole == cluster) {
+            break;
+        }
+    }
+
+    std::vector<int32_t> rank(count);
+
+    // Rank the pixels of the evenly distributed pattern by removing them tightest cluster first
+    Pattern prototype = pattern;
+
+    for (int32_t r = initialCount - 1; r >= 0; --r) {
+        const int32_t cluster = pattern.getTightestCluster();
+        pattern.set(cluster, false);
+        rank[cluster] = r;
+    }
+
+    // Rank the remaining pixels by filling the largest void first
+    pattern = prototype;
+
+    for (int32_t r = initialCount; r < count; ++r) {
+        const int32_t hole = pattern.getLargestVoid();
+        pattern.set(hole, true);
+        rank[hole] = r;
+    }
+
+    QImage image(size, size, QImage::Format_Grayscale8);
+
+    for (int32_t y = 0; y < size; ++y) {
+        uchar* line = image.scanLine(y);
+
+        for (int32_t x = 0; x < size; ++x) {
+            line[x] = static_cast<uchar>(static_cast<qint64>(rank[y * size + x]) * 256 / count);
+        }
+    }
+
+    return image;
+}
@@ -0,0 +1,26 @@
+#ifndef BLUENOISE_H
+#define BLUENOISE_H
+
+#include <QImage>
+
+/// \brief
+///     Generates tileable blue noise textures. Blue noise has no low frequency content, so neighbouring pixels using
+///     the texture as their random numbers get values which are far apart from each other. Noise from sampling is
+///     then spread evenly across the image instead of forming clumps, which looks far less noisy at low sample
+///     counts and is what accumulation over several frames converges from the fastest.
+class BlueNoise
+{
+public:
+
+    /// \brief
+    ///     Generates a square blue noise texture using the void-and-cluster method.
+    /// \param size
+    ///     The width and height of the texture in pixels.
+    /// \param seed
+    ///     The seed of the initial random pattern. The same seed always generates the same texture.
+    /// \return
+    ///     The texture in which every value in [0, 255] occurs equally often.
+    static QImage generate(int32_t size, quint32 seed = 0);
+};
+
+#endif // BLUENOISE_H
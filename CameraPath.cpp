@@ -0,0 +1,464 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QMatrix3x3>
+#include <QMatrix4x4>
+#include <QQuaternion>
+#include <QtMath>
+
+static QQuaternion exp(QQuaternion q)
+{
+    auto x = q.x();
+    auto y = q.y();
+    auto z = q.z();
+    auto w = q.scalar();
+
+    auto immaginaryNorm = std::sqrt((x * x) + (y * y) + (z * z));
+
+    auto r = std::exp(w) * std::cos(immaginaryNorm);
+    auto i = 0;
+    auto j = 0;
+    auto k = 0;
+
+    // Avoid division by 0
+    if (immaginaryNorm == 0) {
+        return QQuaternion(r, i, j, k);
+    } else {
+        i = std::exp(w) * (x * std::sin(immaginaryNorm)) / immaginaryNorm;
+        j = std::exp(w) * (y * std::sin(immaginaryNorm)) / immaginaryNorm;
+        k = std::exp(w) * (z * std::sin(immaginaryNorm)) / immaginaryNorm;
+
+        return QQuaternion(r, i, j, k);
+    }
+}
+
+/// \note
+///     This function assumes a branch cut (-inf, 0]
+static QQuaternion log(QQuaternion q)
+{
+    auto x = q.x();
+    auto y = q.y();
+    auto z = q.z();
+    auto w = q.scalar();
+
+    auto immaginaryNorm = std::sqrt((x * x) + (y * y) + (z * z));
+
+    // Avoid division by 0
+    if (immaginaryNorm == 0) {
+        auto r = std::log(q.length());
+        auto i = x * std::atan2(immaginaryNorm, w);
+        auto j = y * std::atan2(immaginaryNorm, w);
+        auto k = z * std::atan2(immaginaryNorm, w);
+
+        return QQuaternion(r, i, j, k);
+    } else {
+        auto r = std::log(q.length());
+        auto i = (x * std::atan2(immaginaryNorm, w)) / immaginaryNorm;
+        auto j = (y * std::atan2(immaginaryNorm, w)) / immaginaryNorm;
+        auto k = (z * std::atan2(immaginaryNorm, w)) / immaginaryNorm;
+
+        return QQuaternion(r, i, j, k);
+    }
+}
+
+static QMatrix3x3 toRotationMatrix(QVector3D r)
+{
+    auto rx = QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, r.x() / (M_PI / 180.0f));
+    auto ry = QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, r.y() / (M_PI / 180.0f));
+    auto rz = QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, r.z() / (M_PI / 180.0f));
+
+    return (rx * ry * rz).toRotationMatrix();
+}
+
+void CameraPath::compile(int32_t threadCount)
+{
+    const int32_t segmentCount = std::max(positionWaypoints.size() - 1, 0);
+    const int32_t entryCount = segmentCount * ARC_LENGTH_STEPS;
+
+    // The derivative within every segment is a quadratic polynomial, so its coefficients are computed once instead of
+    // going through the spline matrix for every quadrature sample
+    std::vector<SegmentDerivative> derivatives(segmentCount);
+
+    for (int32_t i = 0; i < segmentCount; ++i) {
+        derivatives[i] = getSegmentDerivative(i);
+    }
+
+    if (threadCount <= 0) {
+        threadCount = static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    }
+
+    threadCount = std::clamp(entryCount / COMPILE_ENTRIES_PER_THREAD_MIN, 1, threadCount);
+
+    s2uTable.resize(entryCount);
+    t2sTable.clear();
+    auto* table = s2uTable.data();
+
+    // Every thread works on a contiguous chunk of the table, the first one on the calling thread
+    const auto getChunkBegin = [&](int32_t chunk)
+    {
+        return static_cast<int32_t>(static_cast<int64_t>(entryCount) * chunk / threadCount);
+    };
+
+    const auto forEachChunk = [&](const std::function<void(int32_t)>& function)
+    {
+        std::vector<std::future<void>> futures;
+
+        for (int32_t chunk = 1; chunk < threadCount; ++chunk) {
+            futures.push_back(std::async(std::launch::async, function, chunk));
+        }
+
+        function(0);
+
+        for (auto& future : futures) {
+            future.get();
+        }
+    };
+
+    // Integrate the steps of every chunk into arc lengths relative to the start of the chunk
+    std::vector<double> chunkLengths(threadCount);
+
+    forEachChunk([&](int32_t chunk)
+    {
+        double s = 0.0;
+
+        for (int32_t k = getChunkBegin(chunk); k < getChunkBegin(chunk + 1); ++k) {
+            const int32_t segment = k / ARC_LENGTH_STEPS;
+            const int32_t step = k % ARC_LENGTH_STEPS;
+
+            table[k] = { static_cast<float>(s), segment + static_cast<float>(step) / ARC_LENGTH_STEPS };
+            s += getStepLength(derivatives[segment], step);
+        }
+
+        chunkLengths[chunk] = s;
+    });
+
+    // Offset every chunk by the arc length of all chunks before it
+    if (threadCount > 1) {
+        std::vector<double> chunkOffsets(threadCount, 0.0);
+
+        for (int32_t chunk = 1; chunk < threadCount; ++chunk) {
+            chunkOffsets[chunk] = chunkOffsets[chunk - 1] + chunkLengths[chunk - 1];
+        }
+
+        forEachChunk([&](int32_t chunk)
+        {
+            for (int32_t k = getChunkBegin(chunk); k < getChunkBegin(chunk + 1); ++k) {
+                table[k].first = static_cast<float>(table[k].first + chunkOffsets[chunk]);
+            }
+        });
+    }
+
+    compiled = true;
+}
+
+float CameraPath::s2u(float s) const
+{
+    auto const comp = [](const decltype(s2uTable)::value_type& a, const decltype(s2uTable)::value_type& b) -> bool
+    {
+        return a.first < b.first;
+    };
+
+    auto i1 = std::upper_bound(s2uTable.begin(), s2uTable.end() - 1, QPair(s, 0.0f), comp);
+    auto i0 = i1--;
+
+    auto u0 = i0->second;
+    auto u1 = i1->second;
+
+    auto s0 = i0->first;
+    auto s1 = i1->first;
+
+    // https://en.wikipedia.org/wiki/Linear_interpolation#Linear_interpolation_between_two_known_points
+    auto a = (s - s0) / (s1 - s0);
+
+    return (1 - a) * u0 + a * u1;
+}
+
+void CameraPath::setSpeedProfile(QVector<float> table)
+{
+    t2sTable = std::move(table);
+}
+
+bool CameraPath::hasSpeedProfile() const
+{
+    return !t2sTable.isEmpty();
+}
+
+float CameraPath::t2s(float t) const
+{
+    t = std::clamp(t, 0.0f, 1.0f);
+
+    if (t2sTable.size() < 2) {
+        return t * getArcLength();
+    }
+
+    // The table is evenly spaced in time so the entries around `t` are found directly
+    const float x = t * (t2sTable.size() - 1);
+    const int32_t i = std::min(static_cast<int32_t>(x), t2sTable.size() - 2);
+    const float a = x - i;
+
+    return (1 - a) * t2sTable[i] + a * t2sTable[i + 1];
+}
+
+QVector3D CameraPath::interpolatePosition(float t, bool takeDerivative) const
+{
+    if (t <= 0) {
+        return positionWaypoints.first();
+    }
+
+    if (t >= positionWaypoints.size() - 1) {
+        return positionWaypoints.last();
+    }
+
+    const int32_t i = std::floor(t);
+
+    float u_0 = 1.0f;
+    float u_1 = t - i;
+    float u_2 = u_1 * u_1;
+    float u_3 = u_2 * u_1;
+
+    if (takeDerivative) {
+        u_0 = 0.0f;
+        u_1 = 1.0f;
+        u_2 = 2 * (t - i);
+        u_3 = 3 * (t - i) * (t - i);
+    }
+
+    QVector4D u(u_0, u_1, u_2, u_3);
+
+    QMatrix4x4 B(0, -1, 2, -1, 2, 0, -5, 3, 0, 1, 4, -3, 0, 0, -1, 1);
+    QMatrix4x4 G;
+
+    QVector3D points[4];
+    getControlPoints(i, points);
+
+    G.setColumn(0, {points[0], 0});
+    G.setColumn(1, {points[1], 0});
+    G.setColumn(2, {points[2], 0});
+    G.setColumn(3, {points[3], 0});
+
+    const float tau = 0.5f;
+
+    return (G * B * tau * u).toVector3D();
+}
+
+void CameraPath::getControlPoints(int32_t i, QVector3D (&points)[4]) const
+{
+    // Catmull-Rom splines require at least four points for interpolation. In reality we should be able to interpolate
+    // between two points in 3D space, i.e. the interpolation should be a straight line. To handle this situation we
+    // use the recorded look direction to compute two additional points; one at the start and one at the end, which we
+    // will use as the interpolation control points. Using the look directions ensures that the tangent at the start
+    // and end points is identical to the look direction, which will ensure we end up at the same positions and
+    // rotations recorded.
+
+    points[0] = (i != 0) ?
+        positionWaypoints[i - 1] :
+        positionWaypoints[i + 0] - getLookDirectionFromRotation(rotationWaypoints[i + 0]);
+
+    points[1] = positionWaypoints[i + 0];
+    points[2] = positionWaypoints[i + 1];
+
+    points[3] = (i != positionWaypoints.size() - 2) ?
+        positionWaypoints[i + 2] :
+        positionWaypoints[i + 1] + getLookDirectionFromRotation(rotationWaypoints[i + 1]);
+}
+
+CameraPath::SegmentDerivative CameraPath::getSegmentDerivative(int32_t i) const
+{
+    QVector3D p[4];
+    getControlPoints(i, p);
+
+    // The derivative of `G * B * tau * (1, h, h^2, h^3)` as used by interpolatePosition, multiplied out
+    const float tau = 0.5f;
+
+    SegmentDerivative derivative;
+    derivative.a = tau * (p[2] - p[0]);
+    derivative.b = 2 * tau * (2 * p[0] - 5 * p[1] + 4 * p[2] - p[3]);
+    derivative.c = 3 * tau * (3 * p[1] - p[0] - 3 * p[2] + p[3]);
+
+    return derivative;
+}
+
+float CameraPath::getStepLength(const SegmentDerivative& derivative, int32_t step)
+{
+    // https://en.wikipedia.org/wiki/Gaussian_quadrature
+    // Precalculated 5th order Gauss–Legendre quadrature coefficients
+    static constexpr std::pair<float,float> coefficients[] =
+    {
+        {  0.00000000f, 0.56888890f },
+        { -0.53846930f, 0.47862867f },
+        {  0.53846930f, 0.47862867f },
+        { -0.90617985f, 0.23692688f },
+        {  0.90617985f, 0.23692688f },
+    };
+
+    constexpr float width = 1.0f / ARC_LENGTH_STEPS;
+    const float center = (step + 0.5f) * width;
+
+    float s = 0.0f;
+
+    // Change of interval formula
+    for (auto [xi, wi] : coefficients) {
+        const float h = center + width / 2 * xi;
+        s += wi * (derivative.a + derivative.b * h + derivative.c * (h * h)).length();
+    }
+
+    return s * (width / 2);
+}
+
+QVector3D CameraPath::interpolateRotation(float t) const
+{
+    if (t <= 0) {
+        return rotationWaypoints.first();
+    }
+
+    if (t >= rotationWaypoints.size() - 1) {
+        return rotationWaypoints.last();
+    }
+
+    const int32_t i = std::floor(t);
+
+    // fromEulerAngles
+    QQuaternion qi0 =
+        QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints[i].y() / (M_PI / 180.0f)) *
+        QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints[i].x() / (M_PI / 180.0f)) *
+        QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints[i].z() / (M_PI / 180.0f));
+
+    QQuaternion qi1 =
+        QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints[i + 1].y() / (M_PI / 180.0f)) *
+        QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints[i + 1].x() / (M_PI / 180.0f)) *
+        QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints[i + 1].z() / (M_PI / 180.0f));
+
+    QQuaternion si0;
+
+    if (i <= 1) {
+        si0 = qi0;
+    } else {
+        QQuaternion qim1 =
+            QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints[i - 1].y() / (M_PI / 180.0f)) *
+            QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints[i - 1].x() / (M_PI / 180.0f)) *
+            QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints[i - 1].z() / (M_PI / 180.0f));
+
+        // Section 6.2.1, Definition 17, (6.15) pg. 51 of https://web.mit.edu/2.998/www/QuaternionReport1.pdf
+        si0 = qi0 * exp(-(log(qi0.inverted() * qi1) + log(qi0.inverted() * qim1)) / 4);
+    }
+
+    QQuaternion si1;
+
+    if (i >= rotationWaypoints.size() - 3) {
+        si1 =
+            QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints.last().y() / (M_PI / 180.0f)) *
+            QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints.last().x() / (M_PI / 180.0f)) *
+            QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints.last().z() / (M_PI / 180.0f));
+    } else {
+        QQuaternion qip2 =
+            QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints[i + 2].y() / (M_PI / 180.0f)) *
+            QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints[i + 2].x() / (M_PI / 180.0f)) *
+            QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints[i + 2].z() / (M_PI / 180.0f));
+
+        // Section 6.2.1, Definition 17, (6.15) pg. 51 of https://web.mit.edu/2.998/www/QuaternionReport1.pdf
+        si1 = qi1 * exp(-(log(qi1.inverted() * qip2) + log(qi1.inverted() * qi0)) / 4);
+    }
+
+    auto h = t - i;
+
+    // Section 6.2.1, Definition 17, (6.14) pg. 51 of https://web.mit.edu/2.998/www/QuaternionReport1.pdf
+    auto squad = QQuaternion::slerp(QQuaternion::slerp(qi0, qi1, h), QQuaternion::slerp(si0, si1, h), 2 * h * (1 - h));
+
+    return squad.toEulerAngles() * static_cast<float>(M_PI / 180.0f);
+}
+
+void CameraPath::addWaypoint(QVector3D position, QVector3D rotation)
+{
+    positionWaypoints.append(position);
+    rotationWaypoints.append(rotation);
+
+    compiled = false;
+}
+
+void CameraPath::removeLastWaypoint()
+{
+    if (!positionWaypoints.isEmpty()) {
+        positionWaypoints.removeLast();
+        rotationWaypoints.removeLast();
+    }
+
+    compiled = false;
+}
+
+void CameraPath::setPositionWaypoint(int32_t index, QVector3D position)
+{
+    positionWaypoints[index] = position;
+
+    compiled = false;
+}
+
+void CameraPath::clear()
+{
+    positionWaypoints.clear();
+    rotationWaypoints.clear();
+    s2uTable.clear();
+    t2sTable.clear();
+
+    compiled = false;
+}
+
+int32_t CameraPath::size() const
+{
+    return positionWaypoints.size();
+}
+
+const QList<QVector3D>& CameraPath::getPositionWaypoints() const
+{
+    return positionWaypoints;
+}
+
+const QList<QVector3D>& CameraPath::getRotationWaypoints() const
+{
+    return rotationWaypoints;
+}
+
+bool CameraPath::isCompiled() const
+{
+    return compiled;
+}
+
+float CameraPath::getArcLength() const
+{
+    return s2uTable.isEmpty() ? 0.0f : s2uTable.last().first;
+}
+
+QVector3D CameraPath::getLookDirectionFromRotation(QVector3D rotation)
+{
+    auto rotationMatrix = toRotationMatrix(rotation);
+    return QVector3D(rotationMatrix(0, 2), rotationMatrix(1, 2), rotationMatrix(2, 2));
+}
+
+QMatrix3x3 CameraPath::getCameraRotationMatrix(QVector3D r)
+{
+    auto rx = QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, r.x() / (M_PI / 180.0f));
+    auto ry = QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, r.y() / (M_PI / 180.0f));
+    auto rz = QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, r.z() / (M_PI / 180.0f));
+
+    // Quaternion multiplication is not commutative. We want our camera to be a first person view and not a flight
+    // simulator camera. As such we want to rotate through the y-axis first and then through the x-axis. That is,
+    // we want to fix the y-axis to be the natural gravitational y-axis.
+    //
+    // We can make a simple example with head rotations. Pretend you had a virtual stick going through your ears
+    // which represents the x-axis. Similarly pretend you had a virtual stick going through the top of your head
+    // and through your neck which represents the y-axis. Rotate the y-axis stick to the right. The x-axis stick
+    // will rotate with your head. Now rotate the x-axis stick to the right. This will make your head tilt down.
+    //
+    // Now let's do the opposite. Rotate the x-axis stick to the right. Your head should tilt down. The y-axis
+    // stick will rotate with your head and should no longer be in the gravitational vertical position. Now rotate
+    // the y-axis stick to the right. Your neck should tilt in an awkward way. The rotation you end up with will
+    // not be the same as the previous exercise.
+    //
+    // As an exercise, switch the order of multiplication in the line below and test how the camera behaves.
+    return (ry * rx * rz).toRotationMatrix();
+}
@@ -0,0 +1,166 @@
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#include <QList>
+#include <QMatrix3x3>
+#include <QPair>
+#include <QVector>
+#include <QVector3D>
+
+/// \brief
+///     A camera path is a sequence of position and rotation waypoints through which the camera is interpolated at a
+///     constant speed. Positions are interpolated using a Catmull-Rom spline and rotations using Squad.
+///
+///     A path must be compiled via `compile` before it can be sampled at a given arc length. Compilation does not
+///     touch any shared state so a path can be compiled on a worker thread while another path is being animated.
+///
+///     See https://github.com/fjeremic/fractal-pioneer for an explanation of how interpolation is implemented.
+class CameraPath
+{
+public:
+
+    /// The number of arc length table entries per segment between two waypoints.
+    static constexpr int32_t ARC_LENGTH_STEPS = 100;
+
+    /// The minimum number of arc length table entries integrated per thread while compiling. Shorter paths are
+    /// compiled on fewer threads since starting a thread costs more than integrating this many entries.
+    static constexpr int32_t COMPILE_ENTRIES_PER_THREAD_MIN = 16384;
+
+public:
+
+    /// \brief
+    ///     Adds a waypoint to the end of the path and invalidates the compiled arc length table.
+    /// \param position
+    ///     The position of the camera in X, Y, Z coordinates.
+    /// \param rotation
+    ///     The rotation of the camera in yaw, pitch, roll coordinates.
+    void addWaypoint(QVector3D position, QVector3D rotation);
+
+    /// \brief
+    ///     Removes the last waypoint of the path, if any, and invalidates the compiled arc length table.
+    void removeLastWaypoint();
+
+    /// \brief
+    ///     Moves the position of an existing waypoint and invalidates the compiled arc length table.
+    void setPositionWaypoint(int32_t index, QVector3D position);
+
+    /// \brief
+    ///     Clears all waypoints and the compiled arc length table.
+    void clear();
+
+    /// \brief
+    ///     Gets the number of waypoints in this path.
+    int32_t size() const;
+
+    /// \brief
+    ///     Gets the list of position waypoints.
+    const QList<QVector3D>& getPositionWaypoints() const;
+
+    /// \brief
+    ///     Gets the list of rotation waypoints.
+    const QList<QVector3D>& getRotationWaypoints() const;
+
+    /// \brief
+    ///     Builds the table mapping arc length of the spline to interpolation parameters. The path must have at least
+    ///     two waypoints. The arc length of every table entry is integrated in parallel, followed by a parallel
+    ///     prefix sum turning the lengths into arc lengths.
+    /// \param threadCount
+    ///     The maximum number of threads to compile on, or 0 to use all hardware threads.
+    void compile(int32_t threadCount = 0);
+
+    /// \brief
+    ///     Determines whether the path has been compiled since it was last modified.
+    bool isCompiled() const;
+
+    /// \brief
+    ///     Gets the total arc length of the compiled spline.
+    float getArcLength() const;
+
+    /// \brief
+    ///     Maps an arc length along the compiled spline to an interpolation parameter.
+    float s2u(float s) const;
+
+    /// \brief
+    ///     Sets the speed profile of the compiled path, which is cleared again whenever the path is compiled.
+    /// \param table
+    ///     The arc length at evenly spaced fractions of the animation time, from 0 at the start to the arc length of
+    ///     the spline at the end. An empty table moves the camera at a constant speed.
+    void setSpeedProfile(QVector<float> table);
+
+    /// \brief
+    ///     Determines whether the path has a speed profile or moves the camera at a constant speed.
+    bool hasSpeedProfile() const;
+
+    /// \brief
+    ///     Maps a fraction of the animation time in [0, 1] to an arc length along the compiled spline using the speed
+    ///     profile.
+    float t2s(float t) const;
+
+    /// \brief
+    ///     Interpolates the position (or its derivative) at interpolation parameter `t` in [0, size() - 1].
+    QVector3D interpolatePosition(float t, bool takeDerivative) const;
+
+    /// \brief
+    ///     Interpolates the rotation in Euler angles at interpolation parameter `t` in [0, size() - 1].
+    QVector3D interpolateRotation(float t) const;
+
+    /// \brief
+    ///     Gets the look direction from a rotation.
+    /// \param rotation
+    ///     A rotation vector representing Euler angles in radians.
+    /// \return
+    ///     The Z-axis vector of the rotation matrix generated from the given rotation.
+    static QVector3D getLookDirectionFromRotation(QVector3D rotation);
+
+    /// \brief
+    ///     Gets the first person camera rotation matrix from a rotation.
+    /// \param rotation
+    ///     A rotation vector representing Euler angles in radians.
+    /// \return
+    ///     The rotation matrix which rotates through the y-axis, then the x-axis, then the z-axis.
+    static QMatrix3x3 getCameraRotationMatrix(QVector3D rotation);
+
+private:
+
+    /// \brief
+    ///     The derivative `a + b * h + c * h^2` of the spline within a segment at `h` in [0, 1].
+    struct SegmentDerivative
+    {
+        QVector3D a;
+        QVector3D b;
+        QVector3D c;
+    };
+
+    /// \brief
+    ///     Gets the four Catmull-Rom control points of the segment between waypoint `i` and `i + 1`.
+    void getControlPoints(int32_t i, QVector3D (&points)[4]) const;
+
+    /// \brief
+    ///     Gets the derivative of the spline within the segment between waypoint `i` and `i + 1`.
+    SegmentDerivative getSegmentDerivative(int32_t i) const;
+
+    /// \brief
+    ///     Integrates the arc length of a step of a segment using Gauss-Legendre quadrature.
+    /// \param step
+    ///     The index of the step in [0, ARC_LENGTH_STEPS) within the segment.
+    static float getStepLength(const SegmentDerivative& derivative, int32_t step);
+
+private:
+
+    /// The list of position waypoints.
+    QList<QVector3D> positionWaypoints;
+
+    /// The list of rotation waypoints.
+    QList<QVector3D> rotationWaypoints;
+
+    /// Maps arc length of the spline generated by the waypoints to interpolation parameters at those arc lengths.
+    QVector<QPair<float, float>> s2uTable;
+
+    /// Maps evenly spaced fractions of the animation time to arc length, or empty for a constant speed.
+    QVector<float> t2sTable;
+
+    /// Determines whether `s2uTable` reflects the current waypoints.
+    bool compiled = false;
+};
+
+#endif // CAMERAPATH_H
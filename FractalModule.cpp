@@ -0,0 +1,256 @@
+#include "FractalModule.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QVector4D>
+
+namespace
+{
+    /// The number of fractal iterations at full detail. Matches `MAX_ITERATIONS` in frag.glsl.
+    constexpr int32_t MAX_ITERATIONS = 16;
+
+    /// \brief
+    ///     The cosine and sine of the fractal rotation about the X and Z axes, as uploaded to the shader.
+    struct Rotation
+    {
+        explicit Rotation(const RenderParams& params) :
+            cx(std::cos(params.fractalRotation.x())),
+            sx(std::sin(params.fractalRotation.x())),
+            cz(std::cos(params.fractalRotation.z())),
+            sz(std::sin(params.fractalRotation.z()))
+        {
+        }
+
+        void rotateX(QVector4D& p) const
+        {
+            p = QVector4D(p.x(), cx * p.y() + sx * p.z(), cx * p.z() - sx * p.y(), p.w());
+        }
+
+        void rotateZ(QVector4D& p) const
+        {
+            p = QVector4D(cz * p.x() + sz * p.y(), cz * p.y() - sz * p.x(), p.z(), p.w());
+        }
+
+        float cx;
+        float sx;
+        float cz;
+        float sz;
+    };
+
+    QVector4D componentAbs(const QVector4D& p)
+    {
+        return QVector4D(std::abs(p.x()), std::abs(p.y()), std::abs(p.z()), std::abs(p.w()));
+    }
+
+    float mengerDistanceEstimate(QVector3D position, const RenderParams& params)
+    {
+        const Rotation rotation(params);
+        QVector4D p(position, 1.0f);
+
+        for (int32_t i = 0; i < MAX_ITERATIONS; ++i) {
+            p = componentAbs(p);
+            rotation.rotateZ(p);
+
+            // Sort the coordinates in descending order, same as mengerFold
+            if (p.x() < p.y()) {
+                p = QVector4D(p.y(), p.x(), p.z(), p.w());
+            }
+
+            if (p.x() < p.z()) {
+                p = QVector4D(p.z(), p.y(), p.x(), p.w());
+            }
+
+            if (p.y() < p.z()) {
+                p = QVector4D(p.x(), p.z(), p.y(), p.w());
+            }
+
+            rotation.rotateX(p);
+
+            p *= params.fractalScale;
+            p += QVector4D(params.fractalPosition, 0.0f);
+        }
+
+        const QVector3D a = componentAbs(p).toVector3D() - QVector3D(6.0f, 6.0f, 6.0f);
+        const QVector3D outside(std::max(a.x(), 0.0f), std::max(a.y(), 0.0f), std::max(a.z(), 0.0f));
+
+        return (std::min(std::max({ a.x(), a.y(), a.z() }), 0.0f) + outside.length()) / p.w();
+    }
+
+    float mandelbulbDistanceEstimate(QVector3D position, const RenderParams& params)
+    {
+        // Matches MANDELBULB_SIZE and MANDELBULB_BAILOUT in mandelbulb.glsl
+        constexpr float SIZE = 2.0f;
+        constexpr float BAILOUT = 2.0f;
+
+        const Rotation rotation(params);
+        const float power = params.fractalScale;
+        const QVector3D c = position / SIZE;
+
+        QVector4D z(c, 1.0f);
+        float dr = 1.0f;
+
+        for (int32_t i = 0; i < MAX_ITERATIONS && z.toVector3D().lengthSquared() <= BAILOUT * BAILOUT; ++i) {
+            const float r = z.toVector3D().length();
+            const float theta = std::acos(std::clamp(z.z() / r, -1.0f, 1.0f)) * power;
+            const float phi = std::atan2(z.y(), z.x()) * power;
+            const float rn = std::pow(r, power - 1.0f);
+
+            dr = rn * std::abs(power) * dr + 1.0f;
+
+            const QVector3D bulb(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+            z = QVector4D(rn * r * bulb + c + params.fractalPosition, 1.0f);
+
+            rotation.rotateZ(z);
+            rotation.rotateX(z);
+        }
+
+        const float r = std::max(z.toVector3D().length(), 1e-6f);
+        return 0.5f * std::log(r) * r / dr * SIZE;
+    }
+
+    float mandelboxDistanceEstimate(QVector3D position, const RenderParams& params)
+    {
+        // Matches MANDELBOX_MIN_RADIUS2 and MANDELBOX_FIXED_RADIUS2 in mandelbox.glsl
+        constexpr float MIN_RADIUS2 = 0.25f;
+        constexpr float FIXED_RADIUS2 = 1.0f;
+
+        const Rotation rotation(params);
+        const float scale = params.fractalScale;
+
+        QVector4D p(position, 1.0f);
+
+        for (int32_t i = 0; i < MAX_ITERATIONS; ++i) {
+            p = QVector4D(std::clamp(p.x(), -1.0f, 1.0f) * 2.0f - p.x(),
+                          std::clamp(p.y(), -1.0f, 1.0f) * 2.0f - p.y(),
+                          std::clamp(p.z(), -1.0f, 1.0f) * 2.0f - p.z(),
+                          p.w());
+
+            p *= FIXED_RADIUS2 / std::clamp(p.toVector3D().lengthSquared(), MIN_RADIUS2, FIXED_RADIUS2);
+
+            rotation.rotateZ(p);
+            rotation.rotateX(p);
+
+            p = p * QVector4D(scale, scale, scale, std::abs(scale)) + QVector4D(position + params.fractalPosition, 1.0f);
+        }
+
+        return p.toVector3D().length() / std::abs(p.w());
+    }
+
+    float sierpinskiDistanceEstimate(QVector3D position, const RenderParams& params)
+    {
+        // Matches SIERPINSKI_SIZE in sierpinski.glsl
+        constexpr float SIZE = 2.0f;
+
+        const Rotation rotation(params);
+        const float scale = params.fractalScale;
+
+        QVector4D p(position / SIZE, 1.0f);
+
+        for (int32_t i = 0; i < MAX_ITERATIONS; ++i) {
+            rotation.rotateZ(p);
+
+            if (p.x() + p.y() < 0.0f) {
+                p = QVector4D(-p.y(), -p.x(), p.z(), p.w());
+            }
+
+            if (p.x() + p.z() < 0.0f) {
+                p = QVector4D(-p.z(), p.y(), -p.x(), p.w());
+            }
+
+            if (p.y() + p.z() < 0.0f) {
+                p = QVector4D(p.x(), -p.z(), -p.y(), p.w());
+            }
+
+            rotation.rotateX(p);
+
+            p = QVector4D(p.toVector3D() * scale - params.fractalPosition * (scale - 1.0f), p.w() * std::abs(scale));
+        }
+
+        return p.toVector3D().length() / p.w() * SIZE;
+    }
+
+    float kifsDistanceEstimate(QVector3D position, const RenderParams& params)
+    {
+        // Matches KIFS_SIZE in kifs.glsl
+        constexpr float SIZE = 2.0f;
+
+        const Rotation rotation(params);
+        const float scale = params.fractalScale;
+
+        QVector4D p(position / SIZE, 1.0f);
+
+        for (int32_t i = 0; i < MAX_ITERATIONS; ++i) {
+            rotation.rotateZ(p);
+
+            if (p.x() + p.y() < 0.0f) {
+                p = QVector4D(-p.y(), -p.x(), p.z(), p.w());
+            }
+
+            if (p.x() + p.z() < 0.0f) {
+                p = QVector4D(-p.z(), p.y(), -p.x(), p.w());
+            }
+
+            if (p.x() - p.y() < 0.0f) {
+                p = QVector4D(p.y(), p.x(), p.z(), p.w());
+            }
+
+            if (p.x() - p.z() < 0.0f) {
+                p = QVector4D(p.z(), p.y(), p.x(), p.w());
+            }
+
+            rotation.rotateX(p);
+
+            p = QVector4D(p.toVector3D() * scale - params.fractalPosition * (scale - 1.0f), p.w() * std::abs(scale));
+        }
+
+        return p.toVector3D().length() / p.w() * SIZE;
+    }
+}
+
+const QVector<FractalModule>& FractalModule::getModules()
+{
+    static const QVector<FractalModule> modules
+    {
+        {
+            "menger", "Menger", ":/menger.glsl", "Scale",
+            1.77f, { -2.08f, -1.42f, -1.93f }, { 5.52f, 0.0f, -0.22f },
+            true, mengerDistanceEstimate
+        },
+        {
+            "mandelbulb", "Mandelbulb", ":/mandelbulb.glsl", "Power",
+            8.0f, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f },
+            false, mandelbulbDistanceEstimate
+        },
+        {
+            "mandelbox", "Mandelbox", ":/mandelbox.glsl", "Scale",
+            -1.5f, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f },
+            false, mandelboxDistanceEstimate
+        },
+        {
+            "sierpinski", "Sierpinski Tetrahedron", ":/sierpinski.glsl", "Scale",
+            2.0f, { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f, 0.0f },
+            false, sierpinskiDistanceEstimate
+        },
+        {
+            "kifs", "Kaleidoscopic IFS", ":/kifs.glsl", "Scale",
+            2.0f, { 1.0f, 0.0f, 0.0f }, { 0.3f, 0.0f, 0.2f },
+            false, kifsDistanceEstimate
+        },
+    };
+
+    return modules;
+}
+
+int32_t FractalModule::findModule(const QString& name)
+{
+    const auto& modules = getModules();
+
+    for (int32_t i = 0; i < modules.size(); ++i) {
+        if (modules[i].name == name) {
+            return i;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,64 @@
+#ifndef FRACTALMODULE_H
+#define FRACTALMODULE_H
+
+#include <QString>
+#include <QVector>
+#include <QVector3D>
+
+#include "RenderParams.h"
+
+/// \brief
+///     A fractal module describes one family of fractals the renderer can draw. Every module provides a GLSL source
+///     defining the distance estimate and orbit trap colour of the fractal, which is spliced into the fragment shader
+///     in place of `#include "fractal"`, and optionally a C++ twin of the distance estimate for use on the CPU.
+///
+///     All modules share the fractal scale, shift and rotation parameters but interpret them in their own way, so
+///     every module also declares the label of its scale parameter and the default values of all three which show off
+///     the fractal well.
+struct FractalModule
+{
+    /// \brief
+    ///     Computes the distance from the specified point to the surface of the fractal on the CPU using the fractal
+    ///     parameters in `params`. Matches the distance estimate of the GLSL source at full detail.
+    using DistanceEstimator = float (*)(QVector3D p, const RenderParams& params);
+
+    /// The unique name of the module used to refer to it in scene files.
+    QString name;
+
+    /// The name of the module shown to the user.
+    QString title;
+
+    /// The resource containing the GLSL source of the module.
+    QString shaderFileName;
+
+    /// The label of the scale parameter shown to the user.
+    QString scaleLabel;
+
+    /// The default fractal scale.
+    float defaultScale = 0.0f;
+
+    /// The default fractal shift.
+    QVector3D defaultShift;
+
+    /// The default fractal rotation.
+    QVector3D defaultRotation;
+
+    /// Determines whether the module computes its first iterations in double-float precision in deep zoom mode.
+    bool deepZoom = false;
+
+    /// The distance estimate of the module on the CPU, or nullptr if the module has none.
+    DistanceEstimator distanceEstimate = nullptr;
+
+    /// \brief
+    ///     Gets the registry of all fractal modules. A module is identified by its index in the registry at runtime,
+    ///     the first module is the default.
+    static const QVector<FractalModule>& getModules();
+
+    /// \brief
+    ///     Finds the module with the specified name.
+    /// \return
+    ///     The index of the module in the registry, or -1 if there is no such module.
+    static int32_t findModule(const QString& name);
+};
+
+#endif // FRACTALMODULE_H
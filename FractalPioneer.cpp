@@ -1,129 +1,23 @@
 #include "FractalPioneer.h"
 
+#include "Benchmark.h"
+#include "FractalModule.h"
+#include "FrameWriter.h"
+
 #include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QOpenGLShaderProgram>
+#include <QSignalBlocker>
 #include <QtMath>
 
-/// Current index into `preloadedWaypointLambdas` being animated/previewed
-static size_t preloadedWaypointIndex = 0;
-
-/// A hardcoded sequence of lambdas which when executed will setup the fractal scene with waypoints, durations,
-/// keyframe start/end, etc. to be animated or previewed
-static std::vector<std::function<void(Ui::FractalPioneer&)>> preloadedWaypointLambdas =
-{
-    [](Ui::FractalPioneer& ui)
-    {
-        ui.fractal->setFractalKeyframe(0);
-        ui.fractal->setOutputTargetDuration(30.0);
-
-        ui.fractal->clearWayPoints();
-        ui.fractal->addWaypoint({ -0.4263f, 3.8537f,  0.0012f }, { -1.5708f, 1.5241f, 0.0227f });
-        ui.fractal->addWaypoint({ -0.6596f, 2.9323f, -0.0066f }, { -0.9658f, 1.5591f, 0.0227f });
-        ui.fractal->addWaypoint({ -0.9293f, 2.7172f, -0.0032f }, { -0.4158f, 1.5741f, 0.0227f });
-        ui.fractal->addWaypoint({ -1.1480f, 2.6489f, -0.0021f }, { -0.2908f, 1.5791f, 0.0227f });
-
-        ui.fractalColor->setColor(QColor(107, 97, 49));
-    },
-    [](Ui::FractalPioneer& ui)
-    {
-        ui.fractal->setFractalKeyframe(15200);
-        ui.fractal->setOutputTargetDuration(80.0);
-
-        ui.fractal->clearWayPoints();
-        ui.fractal->addWaypoint({ -1.2249f, 2.6549f,  4.9257f }, { -0.5145f, -0.2654f, -0.0001f });
-        ui.fractal->addWaypoint({ -0.7853f, 2.0185f,  3.3638f }, { -0.0995f, -0.2754f, -0.0001f });
-        ui.fractal->addWaypoint({ -0.6051f, 2.2410f,  2.5274f }, {  0.4505f, -0.1954f, -0.0001f });
-        ui.fractal->addWaypoint({ -0.5785f, 2.5718f,  2.0423f }, {  0.6855f,  0.0896f, -0.0001f });
-        ui.fractal->addWaypoint({ -0.6372f, 2.7899f,  1.6986f }, {  0.2355f,  0.0696f, -0.0001f });
-        ui.fractal->addWaypoint({ -0.5848f, 2.7727f,  1.0036f }, { -0.2445f, -0.1354f, -0.0001f });
-        ui.fractal->addWaypoint({ -0.5437f, 2.6545f,  0.5407f }, { -0.3145f, -0.1504f, -0.0001f });
-        ui.fractal->addWaypoint({ -0.2516f, 2.5000f,  0.1323f }, { -0.2845f, -0.9104f, -0.0001f });
-        ui.fractal->addWaypoint({  0.3408f, 2.4094f, -0.0148f }, { -0.0045f, -1.6104f, -0.0001f });
-        ui.fractal->addWaypoint({  0.8788f, 2.4490f, -0.0034f }, {  0.1555f, -1.5504f, -0.0001f });
-        ui.fractal->addWaypoint({  1.1429f, 2.5484f,  0.0511f }, {  0.4905f, -2.2954f, -0.0001f });
-
-        ui.fractalColor->setColor(QColor(255, 233, 228));
-    },
-
-    [](Ui::FractalPioneer& ui)
-    {
-        ui.fractal->setFractalKeyframe(13400);
-        ui.fractal->setOutputTargetDuration(60.0);
-
-        ui.fractal->clearWayPoints();
-        ui.fractal->addWaypoint({ 2.9407f, 1.7401f,  1.5511f }, {  0.1000f, -0.0400f, -1.0000f });
-        ui.fractal->addWaypoint({ 2.8531f, 2.0577f,  1.1114f }, { -0.6050f, -0.5700f, -1.0000f });
-        ui.fractal->addWaypoint({ 3.0181f, 2.3891f,  0.6425f }, { -1.5708f, -1.9800f, -1.0000f });
-        ui.fractal->addWaypoint({ 2.8726f, 2.7665f,  0.4462f }, { -1.4008f, -3.2450f, -1.0000f });
-        ui.fractal->addWaypoint({ 2.3794f, 2.3435f,  0.1638f }, { -0.2158f, -5.1800f,  0.0000f });
-        ui.fractal->addWaypoint({ 1.9404f, 2.3968f, -0.0743f }, {  0.3092f, -5.2800f,  0.0000f });
-        ui.fractal->addWaypoint({ 1.6924f, 2.4949f, -0.2324f }, {  0.3242f, -5.2850f,  0.0000f });
-
-        ui.fractalColor->setColor(QColor(255, 233, 228));
-    },
-
-    [](Ui::FractalPioneer& ui)
-    {
-        ui.fractal->setFractalKeyframe(10600);
-        ui.fractal->setOutputTargetDuration(19.0);
-
-        ui.fractal->clearWayPoints();
-        ui.fractal->addWaypoint({ -0.9148f, 2.3194f, 2.6425f }, {  0.3288f, -0.2672f,  0.0000f });
-        ui.fractal->addWaypoint({ -0.9890f, 2.3783f, 2.4988f }, { -0.0212f, -1.6872f, -0.8300f });
-        ui.fractal->addWaypoint({ -1.0620f, 2.4562f, 2.4283f }, { -0.2912f, -1.8522f, -0.8300f });
-
-        ui.fractalColor->setColor(QColor(107, 97, 49));
-    },
-
-    [](Ui::FractalPioneer& ui)
-    {
-        ui.fractal->setFractalKeyframe(9800);
-        ui.fractal->setOutputTargetDuration(20.0);
-
-        ui.fractal->clearWayPoints();
-        ui.fractal->addWaypoint({ -3.1948f, 1.9987f, -0.7018f }, { -0.3510f, -1.7920f, -0.0081f });
-        ui.fractal->addWaypoint({ -3.5543f, 2.1470f, -0.9175f }, { -0.3160f, -2.5670f,  0.0000f });
-
-        ui.fractalColor->setColor(QColor(107, 97, 49));
-    },
-
-    [](Ui::FractalPioneer& ui)
-    {
-        ui.fractal->setFractalKeyframe(9300);
-        ui.fractal->setOutputTargetDuration(80.0);
-
-        ui.fractal->clearWayPoints();
-        ui.fractal->addWaypoint({ -2.5021f, 3.4674f, -1.9231f }, { -1.027f, 3.8919f,  0.0000f });
-        ui.fractal->addWaypoint({ -2.1855f, 2.7128f, -1.5945f }, { -1.017f, 3.9269f,  0.0000f });
-        ui.fractal->addWaypoint({ -2.0827f, 2.5088f, -1.5200f }, { -0.962f, 3.8469f,  0.0000f });
-        ui.fractal->addWaypoint({ -2.0675f, 2.3624f, -1.4011f }, { -0.802f, 3.1169f,  0.0000f });
-        ui.fractal->addWaypoint({ -2.1030f, 2.2254f, -1.2335f }, { -0.507f, 2.7569f,  0.0000f });
-        ui.fractal->addWaypoint({ -2.1985f, 2.1652f, -1.0946f }, { -0.192f, 2.5019f,  0.0000f });
-        ui.fractal->addWaypoint({ -2.3125f, 2.1607f, -0.9566f }, {  0.093f, 2.4719f,  0.0000f });
-        ui.fractal->addWaypoint({ -2.6032f, 2.1634f, -0.7882f }, { -0.042f, 1.9719f, -0.3800f });
-
-        ui.fractalColor->setColor(QColor(107, 97, 49));
-    },
-
-    [](Ui::FractalPioneer& ui)
-    {
-        ui.fractal->setFractalKeyframe(11300);
-        ui.fractal->setOutputTargetDuration(60.0);
-
-        ui.fractal->clearWayPoints();
-        ui.fractal->addWaypoint({ -2.9284f, 1.8557f, 1.1644f }, { 0.1992f, 0.3609f, 0.0000f });
-        ui.fractal->addWaypoint({ -2.6099f, 1.6737f, 2.0016f }, { 0.1992f, 0.3609f, 0.0000f });
-
-        ui.fractalColor->setColor(QColor(255, 233, 228));
-    },
-};
-
 FractalPioneer::FractalPioneer(QWidget* parent)
     : QMainWindow(parent)
 {
     ui.setupUi(this);
 
+    renderQueue = new RenderQueue(ui.fractal, [=](const Scene& scene) { setScene(scene); }, this);
+
     QObject::connect(ui.fractal, &FractalWidget::statusChanged,
         [=](const QString& message)
         {
@@ -133,6 +27,11 @@ FractalPioneer::FractalPioneer(QWidget* parent)
     QObject::connect(ui.fractal, &FractalWidget::cameraPositionChaged,
         [=](const QVector3D& value)
         {
+            // The spin boxes only display the camera position, so they must not feed their rounded values back
+            const QSignalBlocker blockerX(ui.cameraPositionX);
+            const QSignalBlocker blockerY(ui.cameraPositionY);
+            const QSignalBlocker blockerZ(ui.cameraPositionZ);
+
             ui.cameraPositionX->setValue(value.x());
             ui.cameraPositionY->setValue(value.y());
             ui.cameraPositionZ->setValue(value.z());
@@ -141,14 +40,28 @@ FractalPioneer::FractalPioneer(QWidget* parent)
     QObject::connect(ui.fractal, &FractalWidget::cameraRotationChaged,
         [=](const QVector3D& value)
         {
+            const QSignalBlocker blockerX(ui.cameraRotationX);
+            const QSignalBlocker blockerY(ui.cameraRotationY);
+            const QSignalBlocker blockerZ(ui.cameraRotationZ);
+
             ui.cameraRotationX->setValue(value.x());
             ui.cameraRotationY->setValue(value.y());
             ui.cameraRotationZ->setValue(value.z());
         });
 
+    QObject::connect(ui.fractal, &FractalWidget::cameraZoomChanged,
+        [=](const float& value)
+        {
+            const QSignalBlocker blocker(ui.cameraZoom);
+
+            ui.cameraZoom->setValue(value);
+        });
+
     QObject::connect(ui.fractal, &FractalWidget::fractalKeyframeChanged,
         [=](const int32_t& value)
         {
+            const QSignalBlocker blocker(ui.fractalKeyframeSlider);
+
             ui.fractalKeyframeSlider->setValue(value);
 
             auto text = QString::number(value);
@@ -173,15 +86,10 @@ FractalPioneer::FractalPioneer(QWidget* parent)
             statusBar()->showMessage("Preview cancelled");
         });
 
-    QObject::connect(ui.fractal, &FractalWidget::previewKeyframesFinished,
-        [=]()
+    QObject::connect(renderQueue, &RenderQueue::statusChanged,
+        [=](const QString& message)
         {
-            if (ui.outputUsePreloadedWaypoints->isChecked()) {
-                if (preloadedWaypointIndex < preloadedWaypointLambdas.size()) {
-                    preloadedWaypointLambdas[preloadedWaypointIndex++](ui);
-                    ui.fractal->previewKeyframes();
-                }
-            }
+            statusBar()->showMessage(message);
         });
 
     QObject::connect(ui.cameraPositionX, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
@@ -244,6 +152,68 @@ FractalPioneer::FractalPioneer(QWidget* parent)
             ui.fractal->setCameraRotation({x, y, z});
         });
 
+    QObject::connect(ui.cameraDeepZoom, &QCheckBox::stateChanged,
+        [=](const int32_t& value)
+        {
+            if (value == Qt::Checked) {
+                ui.fractal->setDeepZoom(true);
+                ui.cameraDeepZoom->setText("Enabled");
+            } else {
+                ui.fractal->setDeepZoom(false);
+                ui.cameraDeepZoom->setText("Disabled");
+            }
+        });
+
+    QObject::connect(ui.cameraZoom, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+        [=](const double& value)
+        {
+            ui.fractal->setCameraZoom(value);
+        });
+
+    QObject::connect(ui.cameraAutoSpeed, &QCheckBox::stateChanged,
+        [=](const int32_t& value)
+        {
+            if (value == Qt::Checked) {
+                ui.fractal->setCameraAutoSpeed(true);
+                ui.cameraAutoSpeed->setText("Enabled");
+            } else {
+                ui.fractal->setCameraAutoSpeed(false);
+                ui.cameraAutoSpeed->setText("Disabled");
+            }
+        });
+
+    QObject::connect(ui.cameraPathClearance, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+        [=](const double& value)
+        {
+            ui.fractal->setCameraPathClearance(value);
+        });
+
+    for (const auto& module : FractalModule::getModules()) {
+        ui.fractalModule->addItem(module.title, module.name);
+    }
+
+    QObject::connect(ui.fractalModule, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        [=](const int& index)
+        {
+            ui.fractal->setFractalModule(index);
+            ui.fractalScaleLabel->setText(FractalModule::getModules()[index].scaleLabel);
+        });
+
+    // Only a fractal picked by the user resets the parameters, scenes bring their own
+    QObject::connect(ui.fractalModule, QOverload<int>::of(&QComboBox::activated),
+        [=](const int& index)
+        {
+            const auto& module = FractalModule::getModules()[index];
+
+            ui.fractalScale->setValue(module.defaultScale);
+            ui.fractalShiftX->setValue(module.defaultShift.x());
+            ui.fractalShiftY->setValue(module.defaultShift.y());
+            ui.fractalShiftZ->setValue(module.defaultShift.z());
+            ui.fractalRotationX->setValue(module.defaultRotation.x());
+            ui.fractalRotationY->setValue(module.defaultRotation.y());
+            ui.fractalRotationZ->setValue(module.defaultRotation.z());
+        });
+
     QObject::connect(ui.fractalScale, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
         [=](const double& value)
         {
@@ -263,7 +233,7 @@ FractalPioneer::FractalPioneer(QWidget* parent)
     QObject::connect(ui.fractalShiftY, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
         [=](const double& value)
         {
-            float x = ui.fractalShiftZ->value();
+            float x = ui.fractalShiftX->value();
             float y = value;
             float z = ui.fractalShiftZ->value();
 
@@ -273,7 +243,7 @@ FractalPioneer::FractalPioneer(QWidget* parent)
     QObject::connect(ui.fractalShiftZ, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
         [=](const double& value)
         {
-            float x = ui.fractalShiftZ->value();
+            float x = ui.fractalShiftX->value();
             float y = ui.fractalShiftY->value();
             float z = value;
 
@@ -328,6 +298,18 @@ FractalPioneer::FractalPioneer(QWidget* parent)
             ui.fractal->setFractalKeyframe(value);
         });
 
+    QObject::connect(ui.sceneAdaptiveAntiAliasing, &QCheckBox::stateChanged,
+        [=](const int32_t& value)
+        {
+            if (value == Qt::Checked) {
+                ui.fractal->setSceneAdaptiveAntiAliasing(true);
+                ui.sceneAdaptiveAntiAliasing->setText("Enabled");
+            } else {
+                ui.fractal->setSceneAdaptiveAntiAliasing(false);
+                ui.sceneAdaptiveAntiAliasing->setText("Disabled");
+            }
+        });
+
     QObject::connect(ui.sceneAmbientOcclusionDelta, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
         [=](const double& value)
         {
@@ -394,6 +376,30 @@ FractalPioneer::FractalPioneer(QWidget* parent)
             }
         });
 
+    QObject::connect(ui.sceneLevelOfDetail, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+        [=](const double& value)
+        {
+            ui.fractal->setSceneLevelOfDetail(value);
+        });
+
+    QObject::connect(ui.sceneSampledLighting, &QCheckBox::stateChanged,
+        [=](const int32_t& value)
+        {
+            if (value == Qt::Checked) {
+                ui.fractal->setSceneSampledLighting(true);
+                ui.sceneSampledLighting->setText("Enabled");
+            } else {
+                ui.fractal->setSceneSampledLighting(false);
+                ui.sceneSampledLighting->setText("Disabled");
+            }
+        });
+
+    QObject::connect(ui.sceneLightingSamples, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+        [=](const double& value)
+        {
+            ui.fractal->setSceneLightingSamples(value);
+        });
+
     QObject::connect(ui.sceneLightColor, &ColorPushButton::valueChanged,
         [=](const QColor& value)
         {
@@ -490,6 +496,56 @@ FractalPioneer::FractalPioneer(QWidget* parent)
             ui.fractal->setOutputDirectory(text);
         });
 
+    ui.outputFormat->addItem("8-bit PNG", FrameWriter::getFormatName(FrameWriter::Format::RGB8));
+    ui.outputFormat->addItem("16-bit PNG", FrameWriter::getFormatName(FrameWriter::Format::RGB16));
+    ui.outputFormat->addItem("Linear Float PFM", FrameWriter::getFormatName(FrameWriter::Format::Float));
+    ui.outputFormat->addItem("Frame Sequence", FrameWriter::getFormatName(FrameWriter::Format::Sequence));
+
+    QObject::connect(ui.outputFormat, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        [=](const int& index)
+        {
+            auto format = FrameWriter::Format::RGB8;
+            if (FrameWriter::findFormat(ui.outputFormat->itemData(index).toString(), format)) {
+                ui.fractal->setOutputFormat(format);
+            }
+        });
+
+    QObject::connect(ui.outputMotionBlurSamples, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+        [=](const double& value)
+        {
+            ui.fractal->setOutputMotionBlurSamples(value);
+        });
+
+    QObject::connect(ui.outputShutter, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+        [=](const double& value)
+        {
+            ui.fractal->setOutputShutter(value);
+        });
+
+    QObject::connect(ui.outputAdaptiveSpeed, &QCheckBox::stateChanged,
+        [=](const int32_t& value)
+        {
+            if (value == Qt::Checked) {
+                ui.fractal->setOutputAdaptiveSpeed(true);
+                ui.outputAdaptiveSpeed->setText("Enabled");
+            } else {
+                ui.fractal->setOutputAdaptiveSpeed(false);
+                ui.outputAdaptiveSpeed->setText("Disabled");
+            }
+        });
+
+    QObject::connect(ui.outputRenderPasses, &QCheckBox::stateChanged,
+        [=](const int32_t& value)
+        {
+            if (value == Qt::Checked) {
+                ui.fractal->setOutputRenderPasses(true);
+                ui.outputRenderPasses->setText("Enabled");
+            } else {
+                ui.fractal->setOutputRenderPasses(false);
+                ui.outputRenderPasses->setText("Disabled");
+            }
+        });
+
     QObject::connect(ui.outputUsePreloadedWaypoints, &QCheckBox::stateChanged,
         [=](const int32_t& value)
         {
@@ -505,34 +561,113 @@ FractalPioneer::FractalPioneer(QWidget* parent)
         [=](const bool&)
         {
             if (ui.outputUsePreloadedWaypoints->isChecked()) {
-                preloadedWaypointIndex = 0;
-
-                if (preloadedWaypointIndex < preloadedWaypointLambdas.size()) {
-                    preloadedWaypointLambdas[preloadedWaypointIndex++](ui);
-                }
+                renderQueue->setScenes(resolveSceneQueue());
+                renderQueue->start(RenderQueue::Mode::Animate);
+            } else {
+                ui.fractal->animateKeyframes();
             }
-
-            ui.fractal->animateKeyframes();
         });
 
     QObject::connect(ui.outputPreviewKeyframes, &QPushButton::clicked,
         [=](const bool&)
         {
             if (ui.outputUsePreloadedWaypoints->isChecked()) {
-                preloadedWaypointIndex = 0;
+                renderQueue->setScenes(resolveSceneQueue());
+                renderQueue->start(RenderQueue::Mode::Preview);
+            } else {
+                ui.fractal->previewKeyframes();
+            }
+        });
 
-                if (preloadedWaypointIndex < preloadedWaypointLambdas.size()) {
-                    preloadedWaypointLambdas[preloadedWaypointIndex++](ui);
-                }
+    QObject::connect(ui.actionOpenScene, &QAction::triggered,
+        [=](const bool&)
+        {
+            QString fileName = QFileDialog::getOpenFileName(this, "Open Scene", QDir::currentPath(),
+                "Scene Files (*.json *.fpscene);;All Files (*)");
+
+            if (!fileName.isEmpty()) {
+                openScene(fileName);
             }
+        });
+
+    QObject::connect(ui.actionSaveScene, &QAction::triggered,
+        [=](const bool&)
+        {
+            QString fileName = QFileDialog::getSaveFileName(this, "Save Scene", QDir::currentPath(),
+                "JSON Scene Files (*.json);;Binary Scene Files (*.fpscene)");
+
+            if (!fileName.isEmpty()) {
+                saveScene(fileName);
+            }
+        });
+
+    QObject::connect(ui.actionPlaySequence, &QAction::triggered,
+        [=](const bool&)
+        {
+            QString fileName = QFileDialog::getOpenFileName(this, "Play Frame Sequence", QDir::currentPath(),
+                "Frame Sequences (*.fpseq);;All Files (*)");
+
+            if (!fileName.isEmpty()) {
+                ui.fractal->playSequence(fileName);
+            }
+        });
+
+    QObject::connect(ui.actionEnforcePathClearance, &QAction::triggered,
+        [=](const bool&)
+        {
+            ui.fractal->enforceCameraPathClearance();
+        });
+
+    QObject::connect(ui.actionExplorePath, &QAction::triggered,
+        [=](const bool&)
+        {
+            ui.fractal->exploreCameraPath();
+        });
+
+    // At most one heatmap is drawn, so checking one unchecks the other
+    const auto updateHeatmap = [=]()
+    {
+        if (ui.actionMarchStepHeatmap->isChecked()) {
+            ui.fractal->setSceneHeatmap(FractalRenderer::HEATMAP_MARCH_STEPS);
+        } else if (ui.actionShadowStepHeatmap->isChecked()) {
+            ui.fractal->setSceneHeatmap(FractalRenderer::HEATMAP_SHADOW_STEPS);
+        } else {
+            ui.fractal->setSceneHeatmap(FractalRenderer::HEATMAP_NONE);
+        }
+    };
+
+    QObject::connect(ui.actionMarchStepHeatmap, &QAction::toggled,
+        [=](const bool& checked)
+        {
+            if (checked) {
+                ui.actionShadowStepHeatmap->setChecked(false);
+            }
+
+            updateHeatmap();
+        });
+
+    QObject::connect(ui.actionShadowStepHeatmap, &QAction::toggled,
+        [=](const bool& checked)
+        {
+            if (checked) {
+                ui.actionMarchStepHeatmap->setChecked(false);
+            }
+
+            updateHeatmap();
+        });
 
-            ui.fractal->previewKeyframes();
+    QObject::connect(ui.actionExit, &QAction::triggered,
+        [=](const bool&)
+        {
+            close();
         });
 
     // Initialize some aesthetically pleasing initial values
     ui.cameraPositionY->setValue(1.32);
     ui.cameraPositionZ->setValue(3.46);
     ui.cameraPositionX->setValue(2.80);
+    ui.cameraPathClearance->setValue(0.02);
+    ui.cameraAutoSpeed->setCheckState(Qt::Checked);
 
     ui.fractalScale->setValue(1.77);
     ui.fractalShiftX->setValue(-2.08);
@@ -547,6 +682,7 @@ FractalPioneer::FractalPioneer(QWidget* parent)
     ui.fractalKeyframeSlider->setMaximum(2 * M_PI / FractalWidget::ANIMATION_SIN_INNER_FACTOR);
     ui.fractalKeyframeSlider->setValue(0);
 
+    ui.sceneAdaptiveAntiAliasing->setCheckState(Qt::Checked);
     ui.sceneAmbientOcclusionDelta->setValue(0.7);
     ui.sceneAmbientOcclusionStrength->setValue(0.008);
     ui.sceneAntiAliasingSamples->setValue(2);
@@ -555,6 +691,8 @@ FractalPioneer::FractalPioneer(QWidget* parent)
     ui.sceneFiltering->setCheckState(Qt::Checked);
     ui.sceneFocalDistance->setValue(1.73205080757);
     ui.sceneFog->setCheckState(Qt::Checked);
+    ui.sceneLevelOfDetail->setValue(1.0);
+    ui.sceneLightingSamples->setValue(2);
     ui.sceneLightColor->setColor(QColor(255, 255, 126));
     ui.sceneShadows->setCheckState(Qt::Checked);
     ui.sceneShadowDarkness->setValue(0.9);
@@ -564,6 +702,269 @@ FractalPioneer::FractalPioneer(QWidget* parent)
 
     ui.outputTargetFPS->setValue(60);
     ui.outputTargetDuration->setValue(10);
+    ui.outputMotionBlurSamples->setValue(1);
+    ui.outputShutter->setValue(0.5);
 
     ui.fractal->setSceneLightDirection({-0.36f, 0.8f, 0.48f});
+
+    QString error;
+    if (!Scene::load(":/PreloadedScenes.json", sceneQueue, error)) {
+        statusBar()->showMessage(error);
+    }
+}
+
+Scene FractalPioneer::getScene() const
+{
+    Scene scene;
+
+    scene.cameraPosition = ui.fractal->getCameraPosition();
+    scene.cameraRotation = ui.fractal->getCameraRotation();
+
+    scene.fractalModule = ui.fractalModule->currentData().toString();
+    scene.fractalScale = ui.fractalScale->value();
+    scene.fractalPosition = QVector3D(ui.fractalShiftX->value(), ui.fractalShiftY->value(), ui.fractalShiftZ->value());
+    scene.fractalRotation = QVector3D(ui.fractalRotationX->value(), ui.fractalRotationY->value(), ui.fractalRotationZ->value());
+    scene.fractalExposure = ui.fractalExposure->value();
+    scene.fractalColor = ui.fractalColor->getColor();
+    scene.fractalKeyframe = ui.fractalKeyframeSlider->value();
+
+    scene.sceneAdaptiveAntiAliasing = ui.sceneAdaptiveAntiAliasing->isChecked();
+    scene.sceneAmbientOcclusionDelta = ui.sceneAmbientOcclusionDelta->value();
+    scene.sceneAmbientOcclusionStrength = ui.sceneAmbientOcclusionStrength->value();
+    scene.sceneAntiAliasingSamples = ui.sceneAntiAliasingSamples->value();
+    scene.sceneBackgroundColor = ui.sceneBackgroundColor->getColor();
+    scene.sceneDiffuseLighting = ui.sceneDiffuseLighting->isChecked();
+    scene.sceneFiltering = ui.sceneFiltering->isChecked();
+    scene.sceneFocalDistance = ui.sceneFocalDistance->value();
+    scene.sceneFog = ui.sceneFog->isChecked();
+    scene.sceneLevelOfDetail = ui.sceneLevelOfDetail->value();
+    scene.sceneSampledLighting = ui.sceneSampledLighting->isChecked();
+    scene.sceneLightingSamples = ui.sceneLightingSamples->value();
+    scene.sceneLightColor = ui.sceneLightColor->getColor();
+    scene.sceneLightDirection = ui.fractal->getSceneLightDirection();
+    scene.sceneShadows = ui.sceneShadows->isChecked();
+    scene.sceneShadowDarkness = ui.sceneShadowDarkness->value();
+    scene.sceneShadowSharpness = ui.sceneShadowSharpness->value();
+    scene.sceneSpecularHighlight = ui.sceneSpecularHighlight->value();
+    scene.sceneSpecularMultiplier = ui.sceneSpecularMultiplier->value();
+
+    QStringList resolutionSplit = ui.outputResultion->currentText().split(' ', Qt::SkipEmptyParts);
+    if (resolutionSplit.size() == 3) {
+        scene.outputResolution = QVector2D(resolutionSplit[0].toFloat(), resolutionSplit[2].toFloat());
+    }
+
+    scene.outputTargetFPS = ui.outputTargetFPS->value();
+    scene.outputTargetDuration = ui.outputTargetDuration->value();
+    scene.outputDirectory = ui.outputDirectory->currentText();
+    scene.outputFormat = ui.outputFormat->currentData().toString();
+    scene.outputMotionBlurSamples = ui.outputMotionBlurSamples->value();
+    scene.outputShutter = ui.outputShutter->value();
+    scene.outputAdaptiveSpeed = ui.outputAdaptiveSpeed->isChecked();
+    scene.outputRenderPasses = ui.outputRenderPasses->isChecked();
+
+    scene.positionWaypoints = ui.fractal->getPositionWaypoints();
+    scene.rotationWaypoints = ui.fractal->getRotationWaypoints();
+
+    return scene;
+}
+
+void FractalPioneer::setScene(const Scene& scene)
+{
+    ui.fractal->setCameraPosition(scene.cameraPosition);
+    ui.fractal->setCameraRotation(scene.cameraRotation);
+
+    auto moduleIndex = ui.fractalModule->findData(scene.fractalModule);
+    if (moduleIndex != -1) {
+        ui.fractalModule->setCurrentIndex(moduleIndex);
+    } else {
+        statusBar()->showMessage("Unknown fractal module \"" + scene.fractalModule + "\"");
+    }
+
+    ui.fractalScale->setValue(scene.fractalScale);
+    ui.fractalShiftX->setValue(scene.fractalPosition.x());
+    ui.fractalShiftY->setValue(scene.fractalPosition.y());
+    ui.fractalShiftZ->setValue(scene.fractalPosition.z());
+    ui.fractalRotationX->setValue(scene.fractalRotation.x());
+    ui.fractalRotationY->setValue(scene.fractalRotation.y());
+    ui.fractalRotationZ->setValue(scene.fractalRotation.z());
+    ui.fractalExposure->setValue(scene.fractalExposure);
+    ui.fractalColor->setColor(scene.fractalColor);
+    ui.fractal->setFractalKeyframe(scene.fractalKeyframe);
+
+    ui.sceneAdaptiveAntiAliasing->setCheckState(scene.sceneAdaptiveAntiAliasing ? Qt::Checked : Qt::Unchecked);
+    ui.sceneAmbientOcclusionDelta->setValue(scene.sceneAmbientOcclusionDelta);
+    ui.sceneAmbientOcclusionStrength->setValue(scene.sceneAmbientOcclusionStrength);
+    ui.sceneAntiAliasingSamples->setValue(scene.sceneAntiAliasingSamples);
+    ui.sceneBackgroundColor->setColor(scene.sceneBackgroundColor);
+    ui.sceneDiffuseLighting->setCheckState(scene.sceneDiffuseLighting ? Qt::Checked : Qt::Unchecked);
+    ui.sceneFiltering->setCheckState(scene.sceneFiltering ? Qt::Checked : Qt::Unchecked);
+    ui.sceneFocalDistance->setValue(scene.sceneFocalDistance);
+    ui.sceneFog->setCheckState(scene.sceneFog ? Qt::Checked : Qt::Unchecked);
+    ui.sceneLevelOfDetail->setValue(scene.sceneLevelOfDetail);
+    ui.sceneSampledLighting->setCheckState(scene.sceneSampledLighting ? Qt::Checked : Qt::Unchecked);
+    ui.sceneLightingSamples->setValue(scene.sceneLightingSamples);
+    ui.sceneLightColor->setColor(scene.sceneLightColor);
+    ui.fractal->setSceneLightDirection(scene.sceneLightDirection);
+    ui.sceneShadows->setCheckState(scene.sceneShadows ? Qt::Checked : Qt::Unchecked);
+    ui.sceneShadowDarkness->setValue(scene.sceneShadowDarkness);
+    ui.sceneShadowSharpness->setValue(scene.sceneShadowSharpness);
+    ui.sceneSpecularHighlight->setValue(scene.sceneSpecularHighlight);
+    ui.sceneSpecularMultiplier->setValue(scene.sceneSpecularMultiplier);
+
+    // The resolution combo box only notifies us of user interaction so we update the fractal directly
+    if (scene.outputResolution.x() > 0 && scene.outputResolution.y() > 0) {
+        auto text = QString("%1 x %2").arg(scene.outputResolution.x()).arg(scene.outputResolution.y());
+
+        auto index = ui.outputResultion->findText(text);
+        if (index == -1) {
+            ui.outputResultion->addItem(text);
+            index = ui.outputResultion->count() - 1;
+        }
+
+        ui.outputResultion->setCurrentIndex(index);
+        ui.fractal->setOutputResultion(scene.outputResolution);
+    }
+
+    ui.outputTargetFPS->setValue(scene.outputTargetFPS);
+    ui.outputTargetDuration->setValue(scene.outputTargetDuration);
+
+    if (!scene.outputDirectory.isEmpty()) {
+        auto index = ui.outputDirectory->findText(scene.outputDirectory);
+        if (index == -1) {
+            ui.outputDirectory->addItem(scene.outputDirectory);
+            index = ui.outputDirectory->count() - 1;
+        }
+
+        ui.outputDirectory->setCurrentIndex(index);
+    }
+
+    auto formatIndex = ui.outputFormat->findData(scene.outputFormat);
+    if (formatIndex != -1) {
+        ui.outputFormat->setCurrentIndex(formatIndex);
+    } else {
+        statusBar()->showMessage("Unknown output format \"" + scene.outputFormat + "\"");
+    }
+
+    ui.outputMotionBlurSamples->setValue(scene.outputMotionBlurSamples);
+    ui.outputShutter->setValue(scene.outputShutter);
+    ui.outputAdaptiveSpeed->setCheckState(scene.outputAdaptiveSpeed ? Qt::Checked : Qt::Unchecked);
+    ui.outputRenderPasses->setCheckState(scene.outputRenderPasses ? Qt::Checked : Qt::Unchecked);
+
+    ui.fractal->clearWayPoints();
+    for (int32_t i = 0; i < scene.positionWaypoints.size() && i < scene.rotationWaypoints.size(); ++i) {
+        ui.fractal->addWaypoint(scene.positionWaypoints[i], scene.rotationWaypoints[i]);
+    }
+}
+
+bool FractalPioneer::openScene(const QString& fileName)
+{
+    QVector<QJsonObject> scenes;
+    QString error;
+
+    if (!Scene::load(fileName, scenes, error)) {
+        statusBar()->showMessage(error);
+        return false;
+    }
+
+    if (scenes.isEmpty()) {
+        statusBar()->showMessage("Scene file \"" + fileName + "\" does not contain any scenes");
+        return false;
+    }
+
+    sceneQueue = scenes;
+
+    // Show the first scene right away, animating/previewing always restarts the queue from the beginning
+    setScene(Scene::fromJson(sceneQueue.first(), getScene()));
+
+    ui.outputUsePreloadedWaypoints->setCheckState(Qt::Checked);
+
+    statusBar()->showMessage(QString("Loaded %1 scene(s) from \"%2\"").arg(scenes.size()).arg(fileName));
+    return true;
+}
+
+bool FractalPioneer::saveScene(const QString& fileName)
+{
+    QString error;
+
+    auto scene = getScene();
+    scene.name = QFileInfo(fileName).completeBaseName();
+
+    if (!Scene::save(fileName, { scene }, error)) {
+        statusBar()->showMessage(error);
+        return false;
+    }
+
+    statusBar()->showMessage("Saved scene to \"" + fileName + "\"");
+    return true;
+}
+
+bool FractalPioneer::renderScenes(const QString& fileName)
+{
+    if (!openScene(fileName)) {
+        return false;
+    }
+
+    renderQueue->setScenes(resolveSceneQueue());
+    return renderQueue->start(RenderQueue::Mode::Animate);
+}
+
+bool FractalPioneer::runBenchmark(const QString& fileName)
+{
+    QVector<Scene> scenes = resolveSceneQueue();
+
+    if (scenes.isEmpty()) {
+        scenes.append(getScene());
+    }
+
+    QVector<RenderParams> views;
+
+    for (const auto& scene : scenes) {
+        RenderParams params = scene.getRenderParams();
+        params.fractalRotation = FractalWidget::getAnimatedFractalRotation(params.fractalRotation, scene.fractalKeyframe);
+
+        if (scene.positionWaypoints.isEmpty()) {
+            views.append(params);
+        }
+
+        for (int32_t i = 0; i < scene.positionWaypoints.size() && i < scene.rotationWaypoints.size(); ++i) {
+            params.cameraPosition = scene.positionWaypoints[i];
+            params.cameraRotation = scene.rotationWaypoints[i];
+            views.append(params);
+        }
+    }
+
+    QString error;
+    Benchmark benchmark(views);
+
+    if (!benchmark.run(fileName, error)) {
+        qWarning("%s", qPrintable(error));
+        statusBar()->showMessage(error);
+        return false;
+    }
+
+    statusBar()->showMessage("Saved benchmark report to \"" + fileName + "\"");
+    return true;
+}
+
+const RenderQueue* FractalPioneer::getRenderQueue() const
+{
+    return renderQueue;
+}
+
+void FractalPioneer::setRenderCacheCapacity(qint64 bytes)
+{
+    ui.fractal->setRenderCacheCapacity(bytes);
+}
+
+QVector<Scene> FractalPioneer::resolveSceneQueue() const
+{
+    QVector<Scene> scenes;
+    Scene scene = getScene();
+
+    for (const auto& json : sceneQueue) {
+        scene = Scene::fromJson(json, scene);
+        scenes.append(scene);
+    }
+
+    return scenes;
 }
@@ -1,8 +1,12 @@
 #ifndef FRACTALPIONEER_H
 #define FRACTALPIONEER_H
 
+#include <QJsonObject>
 #include <QMainWindow>
+#include <QVector>
 
+#include "RenderQueue.h"
+#include "Scene.h"
 #include "ui_FractalPioneer.h"
 
 class FractalPioneer : public QMainWindow
@@ -14,9 +18,64 @@ public:
     ///     Create a window showing the FractalWidget along with all control inputs.
     explicit FractalPioneer(QWidget* parent = nullptr);
 
+    /// \brief
+    ///     Captures the current state of all control inputs, the camera and the recorded waypoints.
+    Scene getScene() const;
+
+    /// \brief
+    ///     Updates all control inputs, the camera and the recorded waypoints to reflect the specified scene.
+    void setScene(const Scene& scene);
+
+    /// \brief
+    ///     Loads the scenes from a scene file into the scene queue which is animated/previewed when the
+    ///     `Use Preloaded Waypoints` checkbox is checked. The first scene in the file is applied immediately.
+    /// \return
+    ///     true if the scene file was loaded successfully; false otherwise.
+    bool openScene(const QString& fileName);
+
+    /// \brief
+    ///     Saves the current scene to a scene file.
+    /// \return
+    ///     true if the scene file was saved successfully; false otherwise.
+    bool saveScene(const QString& fileName);
+
+    /// \brief
+    ///     Loads the scenes from a scene file and animates all of them back-to-back without user interaction.
+    /// \return
+    ///     true if the render queue has started; false otherwise.
+    bool renderScenes(const QString& fileName);
+
+    /// \brief
+    ///     Renders every waypoint of the queued scenes, or the current camera view if there are none, offscreen and
+    ///     writes a report of the render time and image quality to the specified file.
+    /// \return
+    ///     true if the benchmark completed and the report was written; false otherwise.
+    bool runBenchmark(const QString& fileName);
+
+    /// \brief
+    ///     Gets the render queue which animates/previews the queued scenes.
+    const RenderQueue* getRenderQueue() const;
+
+    /// \brief
+    ///     Sets the maximum size in bytes of the render cache keeping frames which were drawn before.
+    void setRenderCacheCapacity(qint64 bytes);
+
+private:
+
+    /// \brief
+    ///     Resolves the scene queue into complete scenes by applying each scene on top of the one before it, starting
+    ///     from the current scene.
+    QVector<Scene> resolveSceneQueue() const;
+
 private:
 
     /// The main window instance
     Ui::FractalPioneer ui;
+
+    /// The sequence of scenes to be animated/previewed, each applied on top of the scene before it.
+    QVector<QJsonObject> sceneQueue;
+
+    /// Renders the resolved scene queue back-to-back.
+    RenderQueue* renderQueue = nullptr;
 };
 #endif // FRACTALPIONEER_H
@@ -0,0 +1,1251 @@
+#include "FractalRenderer.h"
+
+#include "BlueNoise.h"
+#include "CameraPath.h"
+#include "FractalModule.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QSurfaceFormat>
+#include <QThread>
+
+FractalRenderer::Backend FractalRenderer::selectedBackend = FractalRenderer::BACKEND_LEGACY;
+
+QString FractalRenderer::getBackendName(Backend backend)
+{
+    switch (backend) {
+        case BACKEND_LEGACY:
+            return "legacy";
+
+        case BACKEND_COMPUTE:
+            return "compute";
+    }
+
+    return QString();
+}
+
+bool FractalRenderer::findBackend(const QString& name, Backend& backend)
+{
+    for (auto candidate : { BACKEND_LEGACY, BACKEND_COMPUTE }) {
+        if (getBackendName(candidate) == name) {
+            backend = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void FractalRenderer::setBackend(Backend backend)
+{
+    selectedBackend = backend;
+
+    if (backend == BACKEND_COMPUTE) {
+        // Compute shaders and image stores are core in OpenGL 4.3
+        QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+        format.setVersion(4, 3);
+        format.setProfile(QSurfaceFormat::CoreProfile);
+
+        QSurfaceFormat::setDefaultFormat(format);
+    }
+}
+
+FractalRenderer::FractalRenderer(QOpenGLContext* shareContext, QObject* parent) :
+    QObject(parent)
+{
+    context = new QOpenGLContext();
+
+    if (shareContext != nullptr) {
+        context->setFormat(shareContext->format());
+        context->setShareContext(shareContext);
+    } else {
+        context->setFormat(QSurfaceFormat::defaultFormat());
+    }
+
+    context->create();
+
+    // Offscreen surfaces must be created and destroyed on the GUI thread but may be used on any thread
+    surface = new QOffscreenSurface();
+    surface->setFormat(context->format());
+    surface->create();
+
+    thread = new QThread();
+    thread->setObjectName("FractalRenderer");
+
+    writer = std::make_unique<FrameWriter>();
+
+    // Forward errors straight from the writer thread, receivers of our signal queue them to their own thread
+    QObject::connect(writer.get(), &FrameWriter::statusChanged, this, &FractalRenderer::statusChanged,
+        Qt::DirectConnection);
+
+    cache = std::make_unique<RenderCache>(RenderCache::getDefaultDirectory());
+
+    QObject::connect(cache.get(), &RenderCache::statusChanged, this, &FractalRenderer::statusChanged,
+        Qt::DirectConnection);
+}
+
+FractalRenderer::~FractalRenderer()
+{
+    stop();
+
+    delete thread;
+    delete context;
+    delete surface;
+}
+
+void FractalRenderer::start()
+{
+    if (!thread->isRunning()) {
+        setParent(nullptr);
+        moveToThread(thread);
+        context->moveToThread(thread);
+
+        thread->start();
+
+        QMetaObject::invokeMethod(this, &FractalRenderer::initialize, Qt::QueuedConnection);
+    }
+}
+
+void FractalRenderer::stop()
+{
+    if (thread->isRunning()) {
+        QMetaObject::invokeMethod(this, &FractalRenderer::shutdown, Qt::BlockingQueuedConnection);
+
+        thread->quit();
+        thread->wait();
+    }
+}
+
+void FractalRenderer::setParameters(const RenderParams& params, const QString& outputFileName,
+    const RenderParams* subFrames, int32_t subFrameCount, bool cacheFrame, const QString& renderPassFileName,
+    bool restartSequence)
+{
+    auto& request = requests.getWriteBuffer();
+    request.params = params;
+    request.outputFileName = outputFileName;
+    request.renderPassFileName = renderPassFileName;
+    request.cacheFrame = cacheFrame;
+    request.restartSequence = restartSequence;
+    request.subFrameCount = subFrames != nullptr ? std::clamp(subFrameCount, 0, MOTION_BLUR_SAMPLES_MAX) : 0;
+
+    std::copy(subFrames, subFrames + request.subFrameCount, request.subFrames.begin());
+
+    requests.publish();
+}
+
+void FractalRenderer::setCacheCapacity(qint64 capacity)
+{
+    cache->setCapacity(capacity);
+}
+
+void FractalRenderer::requestFrame()
+{
+    if (!framePending.exchange(true)) {
+        QMetaObject::invokeMethod(this, &FractalRenderer::render, Qt::QueuedConnection);
+    }
+}
+
+GLuint FractalRenderer::acquireFrame()
+{
+    frames.update();
+
+    auto& frame = frames.getReadBuffer();
+    return frame ? frame->texture() : 0;
+}
+
+qint64 FractalRenderer::renderImage(const RenderParams& params, QImage& image, HeatmapStatistics* statistics)
+{
+    qint64 elapsed = 0;
+
+    QMetaObject::invokeMethod(this, [&]()
+    {
+        context->makeCurrent(surface);
+
+        auto linear = createLinearBuffer(params.viewportSize);
+        QOpenGLFramebufferObject fractalFBO(params.viewportSize);
+
+        // Make sure no previous work is still in flight so we only measure this frame
+        glFinish();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        const bool heatmap = statistics != nullptr && params.sceneHeatmap != HEATMAP_NONE;
+
+        linear->bind();
+        if (heatmap) {
+            bindStatistics(params.viewportSize);
+        }
+        draw(params, params.viewportSize);
+        if (heatmap) {
+            releaseStatistics();
+        }
+        linear->release();
+
+        toneMap(params, linear.get(), &fractalFBO, true);
+        glFinish();
+
+        elapsed = timer.nsecsElapsed();
+
+        image = fractalFBO.toImage();
+
+        if (heatmap) {
+            *statistics = reduceStatistics(params.viewportSize);
+        }
+
+        context->doneCurrent();
+    }, Qt::BlockingQueuedConnection);
+
+    return elapsed;
+}
+
+void FractalRenderer::initialize()
+{
+    context->makeCurrent(surface);
+    initializeOpenGLFunctions();
+
+    // Set global information
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    if (selectedBackend == BACKEND_COMPUTE) {
+        const auto version = context->format().version();
+        computeMarching = version >= qMakePair(4, 3);
+
+        if (computeMarching) {
+            glGenBuffers(1, &tileQueue);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileQueue);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        } else {
+            emit statusChanged(QString("The compute backend needs OpenGL 4.3 but only OpenGL %1.%2 is available, "
+                "falling back to the fragment shader").arg(version.first).arg(version.second));
+        }
+    }
+
+    // Create the blue noise texture, which tiles the viewport
+    blueNoise = std::make_unique<QOpenGLTexture>(BlueNoise::generate(BLUE_NOISE_SIZE), QOpenGLTexture::DontGenerateMipMaps);
+    blueNoise->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+    blueNoise->setWrapMode(QOpenGLTexture::Repeat);
+
+    toneMapProgram = std::make_unique<QOpenGLShaderProgram>();
+    toneMapProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, readShader(":/vert.glsl", QOpenGLShader::Vertex));
+    toneMapProgram->addShaderFromSourceCode(QOpenGLShader::Fragment,
+        readShader(":/tonemap.glsl", QOpenGLShader::Fragment));
+
+    if (!toneMapProgram->link()) {
+        emit statusChanged("Cannot link the tone mapping shader: " + toneMapProgram->log());
+    }
+
+    histogramProgram = std::make_unique<QOpenGLShaderProgram>();
+    histogramProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, readShader(":/vert.glsl", QOpenGLShader::Vertex));
+    histogramProgram->addShaderFromSourceCode(QOpenGLShader::Fragment,
+        readShader(":/histogram.glsl", QOpenGLShader::Fragment));
+
+    if (!histogramProgram->link()) {
+        emit statusChanged("Cannot link the histogram shader: " + histogramProgram->log());
+    }
+
+    // Create Vertex Buffer Object (VBO)
+    fractalVBO.create();
+    fractalVBO.bind();
+    fractalVBO.setUsagePattern(QOpenGLBuffer::StaticDraw);
+
+    // Create Vertex Array Object (VAO)
+    fractalVAO.create();
+
+    fractalVBO.release();
+
+    context->doneCurrent();
+}
+
+void FractalRenderer::render()
+{
+    framePending = false;
+
+    requests.update();
+    const auto& request = requests.getReadBuffer();
+    const auto& p = request.params;
+
+    // Keyframes only need the output size, so they are still exported while the viewport is hidden or minimized.
+    // Without a keyframe to export there is nothing to do, so the render loop stops until the viewport has a size.
+    if (p.viewportSize.isEmpty()) {
+        if (!request.outputFileName.isEmpty()) {
+            context->makeCurrent(surface);
+            exportKeyframe(request);
+            context->doneCurrent();
+
+            emit frameReady();
+        }
+
+        return;
+    }
+
+    context->makeCurrent(surface);
+
+    auto& frame = frames.getWriteBuffer();
+    if (!frame || frame->size() != p.viewportSize) {
+        frame = std::make_unique<QOpenGLFramebufferObject>(p.viewportSize);
+    }
+
+    const bool heatmap = p.sceneHeatmap != HEATMAP_NONE;
+
+    if (p.sceneSampledLighting) {
+        accumulate(p);
+        toneMap(p, accumulation.get(), frame.get(), true);
+
+        if (heatmap) {
+            emit statusChanged(reduceStatistics(p.viewportSize).getSummary());
+        }
+    } else {
+        accumulatedFrames = 0;
+
+        // Frames which only differ in exposure are tone mapped again without marching any rays
+        if (!linearFrame || linearFrame->size() != p.viewportSize || !isSameLinearFrame(p, linearFrameParams)) {
+            if (!linearFrame || linearFrame->size() != p.viewportSize) {
+                linearFrame = createLinearBuffer(p.viewportSize);
+            }
+
+            // Frames displayed before, e.g. when previewing keyframes again, are read from the render cache. Heatmaps
+            // are always drawn since the cache does not keep their statistics.
+            const auto key = getCacheKey(p.viewportSize, GL_RGBA16F, 1, &p, 1);
+
+            if (heatmap || !loadCachedFrame(key, linearFrame.get(), GL_RGBA16F)) {
+                linearFrame->bind();
+                if (heatmap) {
+                    bindStatistics(p.viewportSize);
+                }
+                draw(p, p.viewportSize);
+                if (heatmap) {
+                    releaseStatistics();
+                }
+                linearFrame->release();
+
+                if (request.cacheFrame) {
+                    storeCachedFrame(key, linearFrame.get(), GL_RGBA16F);
+                }
+            }
+
+            linearFrameParams = p;
+
+            if (heatmap) {
+                emit statusChanged(reduceStatistics(p.viewportSize).getSummary());
+            }
+        }
+
+        toneMap(p, linearFrame.get(), frame.get(), true);
+    }
+
+    exportKeyframe(request);
+
+    // The frame is sampled by the GUI thread from another context so it must be complete before we publish it
+    glFinish();
+    frames.publish();
+
+    context->doneCurrent();
+
+    emit frameReady();
+}
+
+void FractalRenderer::exportKeyframe(const FrameRequest& request)
+{
+    const auto& p = request.params;
+
+    if (request.outputFileName.isEmpty() || p.outputSize.isEmpty()) {
+        return;
+    }
+
+    const auto format = static_cast<FrameWriter::Format>(p.outputFormat);
+
+    // Linear float output gets the full precision of the frame
+    const GLenum keyframeFormat = format == FrameWriter::Format::Float ? GL_RGBA32F : GL_RGBA16F;
+
+    // Render passes are drawn along with the colour into additional float attachments of the keyframe, which are
+    // blended exactly like the colour. The render cache only keeps the colour, so they are always drawn.
+    const bool renderPasses = !request.renderPassFileName.isEmpty();
+    const int32_t attachmentCount = renderPasses ? RENDER_PASS_TARGETS : 1;
+
+    // Keyframes of an animation all have the same size and format, so the buffers are only recreated when they do
+    if (!keyframeBuffer || keyframeBuffer->size() != p.outputSize ||
+        keyframeBuffer->format().internalTextureFormat() != keyframeFormat ||
+        keyframeBuffer->textures().size() != attachmentCount) {
+        keyframeBuffer = createLinearBuffer(p.outputSize, keyframeFormat);
+
+        for (int32_t i = 1; i < attachmentCount; ++i) {
+            keyframeBuffer->addColorAttachment(p.outputSize, GL_RGBA32F);
+        }
+    }
+
+    const GLenum outputFormat = getOutputTextureFormat(format);
+
+    if (!keyframeOutput || keyframeOutput->size() != p.outputSize ||
+        keyframeOutput->format().internalTextureFormat() != outputFormat) {
+        QOpenGLFramebufferObjectFormat fboFormat;
+        fboFormat.setInternalTextureFormat(outputFormat);
+
+        keyframeOutput = std::make_unique<QOpenGLFramebufferObject>(p.outputSize, fboFormat);
+    }
+
+    // Keyframes are stills, so sampled lighting accumulates each one on its own until it has converged. Motion
+    // blur averages the sub-frames, whose samples are spread across the pixel so they also anti-alias each other.
+    // Every sub-frame is drawn equally often so that all of them carry the same weight.
+    const int32_t subFrameCount = std::max(request.subFrameCount, 1);
+    const int32_t frameCount = p.sceneSampledLighting ?
+        (KEYFRAME_ACCUMULATION_FRAMES + subFrameCount - 1) / subFrameCount * subFrameCount : subFrameCount;
+
+    // Exporting the same keyframes again, e.g. in a different format or with a different exposure, only reads them
+    // from the render cache
+    const auto* keyframeParams = request.subFrameCount > 1 ? request.subFrames.data() : &p;
+    const auto key = getCacheKey(p.outputSize, keyframeFormat, frameCount, keyframeParams, subFrameCount,
+        renderPasses);
+
+    if (renderPasses || !loadCachedFrame(key, keyframeBuffer.get(), keyframeFormat)) {
+        keyframeBuffer->bind();
+
+        if (renderPasses) {
+            const GLenum attachments[] = {
+                GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3
+            };
+
+            context->extraFunctions()->glDrawBuffers(RENDER_PASS_TARGETS, attachments);
+        }
+
+        for (int32_t i = 0; i < frameCount; ++i) {
+            if (request.subFrameCount > 1) {
+                // The R2 low-discrepancy sequence, same as the one sampled lighting steps through, centered
+                const QVector2D offset(std::fmod(0.5f + i * 0.7548776662f, 1.0f) - 0.5f,
+                                       std::fmod(0.5f + i * 0.5698402910f, 1.0f) - 0.5f);
+                draw(request.subFrames[i % subFrameCount], p.outputSize, i, 1.0f / (i + 1), offset,
+                    renderPasses);
+            } else {
+                draw(p, p.outputSize, i, 1.0f / (i + 1), QVector2D(), renderPasses);
+            }
+        }
+        keyframeBuffer->release();
+
+        storeCachedFrame(key, keyframeBuffer.get(), keyframeFormat);
+    }
+
+    toneMap(p, keyframeBuffer.get(), keyframeOutput.get(), format != FrameWriter::Format::Float);
+
+    keyframeOutput->bind();
+    writer->write(this, p.outputSize, format, request.outputFileName, -1, request.restartSequence);
+    keyframeOutput->release();
+
+    if (renderPasses) {
+        writeRenderPasses(keyframeBuffer.get(), request.renderPassFileName);
+    }
+}
+
+void FractalRenderer::shutdown()
+{
+    writer->flush();
+
+    context->makeCurrent(surface);
+
+    for (int32_t i = 0; i < 3; ++i) {
+        frames.getAllBuffers()[i].reset();
+    }
+
+    accumulation.reset();
+    firstPass.reset();
+    linearFrame.reset();
+    keyframeBuffer.reset();
+    keyframeOutput.reset();
+    statistics.reset();
+    histogramSegments.reset();
+    histogramRows.reset();
+    histogram.reset();
+    blueNoise.reset();
+    toneMapProgram.reset();
+    histogramProgram.reset();
+
+    fractalVAO.destroy();
+    fractalVBO.destroy();
+    fractalPrograms.clear();
+    computePrograms.clear();
+
+    if (tileQueue != 0) {
+        glDeleteBuffers(1, &tileQueue);
+        tileQueue = 0;
+    }
+
+    context->doneCurrent();
+
+    // Hand ourselves back to the GUI thread so we can be safely destroyed there once the render thread has stopped
+    auto guiThread = QCoreApplication::instance()->thread();
+    context->moveToThread(guiThread);
+    moveToThread(guiThread);
+}
+
+QOpenGLShaderProgram* FractalRenderer::getFractalProgram(int32_t module)
+{
+    auto iterator = fractalPrograms.find(module);
+
+    if (iterator != fractalPrograms.end()) {
+        return iterator->second.get();
+    }
+
+    // Failed modules are cached as well so they are only reported once
+    auto& program = fractalPrograms[module];
+
+    QByteArray source;
+
+    if (!readFractalSource(module, source)) {
+        return nullptr;
+    }
+
+    fractalSourceHashes[module] = QCryptographicHash::hash(source, QCryptographicHash::Sha1);
+
+    program = std::make_unique<QOpenGLShaderProgram>();
+    program->addShaderFromSourceCode(QOpenGLShader::Vertex, readShader(":/vert.glsl", QOpenGLShader::Vertex));
+    program->addShaderFromSourceCode(QOpenGLShader::Fragment, translateShader(source, QOpenGLShader::Fragment));
+
+    if (!program->link()) {
+        const auto& title = FractalModule::getModules()[module].title;
+        emit statusChanged("Cannot link the shader of fractal module \"" + title + "\": " + program->log());
+        program.reset();
+    }
+
+    return program.get();
+}
+
+QOpenGLShaderProgram* FractalRenderer::getComputeProgram(int32_t module)
+{
+    if (!computeMarching) {
+        return nullptr;
+    }
+
+    auto iterator = computePrograms.find(module);
+
+    if (iterator != computePrograms.end()) {
+        return iterator->second.get();
+    }
+
+    // Failed modules are cached as well so they are only reported once
+    auto& program = computePrograms[module];
+
+    QByteArray fractalSource;
+
+    if (!readFractalSource(module, fractalSource)) {
+        return nullptr;
+    }
+
+    QFile computeFile(":/compute.glsl");
+
+    if (!computeFile.open(QIODevice::ReadOnly)) {
+        emit statusChanged("Cannot read the compute shader");
+        return nullptr;
+    }
+
+    // The compute shader declares its own version and splices in the fragment shader without its main function
+    fractalSource.replace("#version 120", "");
+
+    QByteArray source = computeFile.readAll();
+    source.replace("#include \"frag.glsl\"", fractalSource);
+
+    computeSourceHashes[module] = QCryptographicHash::hash(source, QCryptographicHash::Sha1);
+
+    program = std::make_unique<QOpenGLShaderProgram>();
+    program->addShaderFromSourceCode(QOpenGLShader::Compute, translateShader(source, QOpenGLShader::Compute));
+
+    if (!program->link()) {
+        const auto& title = FractalModule::getModules()[module].title;
+        emit statusChanged("Cannot link the compute shader of fractal module \"" + title +
+            "\", drawing it with the fragment shader instead: " + program->log());
+        program.reset();
+    }
+
+    return program.get();
+}
+
+QOpenGLShaderProgram* FractalRenderer::getMarchProgram(const RenderParams& p, bool renderPasses)
+{
+    const bool adaptiveAntiAliasing = p.sceneAdaptiveAntiAliasing && p.sceneAntiAliasingSamples > 1.0f;
+    return adaptiveAntiAliasing || renderPasses ? nullptr : getComputeProgram(p.fractalModule);
+}
+
+bool FractalRenderer::readFractalSource(int32_t module, QByteArray& source)
+{
+    const auto& modules = FractalModule::getModules();
+
+    if (module < 0 || module >= modules.size()) {
+        emit statusChanged("Cannot draw unknown fractal module " + QString::number(module));
+        return false;
+    }
+
+    QFile fragmentFile(":/frag.glsl");
+    QFile moduleFile(modules[module].shaderFileName);
+
+    if (!fragmentFile.open(QIODevice::ReadOnly) || !moduleFile.open(QIODevice::ReadOnly)) {
+        emit statusChanged("Cannot read the shader of fractal module \"" + modules[module].title + "\"");
+        return false;
+    }
+
+    source = fragmentFile.readAll();
+    source.replace("#include \"fractal\"", moduleFile.readAll());
+
+    return true;
+}
+
+QByteArray FractalRenderer::translateShader(QByteArray source, QOpenGLShader::ShaderType type) const
+{
+    const bool coreProfile = context->format().profile() == QSurfaceFormat::CoreProfile;
+
+    // The compute shader is written in GLSL 4.30 but splices in the fragment shader, which is written in GLSL 1.20
+    if (!coreProfile && type != QOpenGLShader::Compute) {
+        return source;
+    }
+
+    source.replace("texture2D(", "texture(");
+
+    if (type == QOpenGLShader::Compute) {
+        return source;
+    }
+
+    const auto version = context->format().version();
+    QByteArray declarations = "#version " + QByteArray::number(version.first * 100 + version.second * 10) + " core\n";
+
+    if (type == QOpenGLShader::Vertex) {
+        // The viewport rectangle is bound to the first vertex attribute, which gl_Vertex aliases in GLSL 1.20
+        declarations += "layout(location = 0) in vec4 in_vertex;\n";
+        source.replace("gl_Vertex", "in_vertex");
+    } else if (type == QOpenGLShader::Fragment) {
+        declarations += "out vec4 out_frag_data[gl_MaxDrawBuffers];\n";
+        source.replace("gl_FragData", "out_frag_data");
+        source.replace("gl_FragColor", "out_frag_data[0]");
+    }
+
+    source.replace("#version 120", declarations);
+
+    return source;
+}
+
+QByteArray FractalRenderer::readShader(const QString& fileName, QOpenGLShader::ShaderType type) const
+{
+    // Shaders which cannot be read fail to link, which reports the error
+    QFile file(fileName);
+    file.open(QIODevice::ReadOnly);
+
+    return translateShader(file.readAll(), type);
+}
+
+bool FractalRenderer::isSameLinearFrame(const RenderParams& a, const RenderParams& b)
+{
+    RenderParams exposed = a;
+    exposed.fractalExposure = b.fractalExposure;
+
+    return exposed == b;
+}
+
+void FractalRenderer::accumulate(const RenderParams& p)
+{
+    if (!accumulation || accumulation->size() != p.viewportSize) {
+        accumulation = createLinearBuffer(p.viewportSize);
+        accumulatedFrames = 0;
+    }
+
+    // Older frames no longer show what is being rendered, so only keep a short history of them. Exposure is applied
+    // after accumulation so changing it keeps all of them.
+    if (!isSameLinearFrame(p, accumulationParams)) {
+        accumulatedFrames = std::min(accumulatedFrames, TEMPORAL_FRAMES);
+    }
+
+    accumulationParams = p;
+
+    // The statistics of heatmaps are blended just like the colour, so they average all accumulated frames
+    const bool heatmap = p.sceneHeatmap != HEATMAP_NONE;
+
+    accumulation->bind();
+    if (heatmap) {
+        bindStatistics(p.viewportSize);
+    }
+    draw(p, p.viewportSize, nextFrameIndex, 1.0f / (accumulatedFrames + 1));
+    if (heatmap) {
+        releaseStatistics();
+    }
+    accumulation->release();
+
+    accumulatedFrames = std::min(accumulatedFrames + 1, ACCUMULATION_FRAMES_MAX);
+    nextFrameIndex = (nextFrameIndex + 1) % FRAME_INDEX_PERIOD;
+}
+
+std::unique_ptr<QOpenGLFramebufferObject> FractalRenderer::createLinearBuffer(const QSize& size, GLenum internalFormat)
+{
+    QOpenGLFramebufferObjectFormat format;
+    format.setInternalTextureFormat(internalFormat);
+
+    return std::make_unique<QOpenGLFramebufferObject>(size, format);
+}
+
+void FractalRenderer::writeRenderPasses(QOpenGLFramebufferObject* source, const QString& fileName)
+{
+    struct RenderPass
+    {
+        const char* name;
+        int32_t attachment;
+        int32_t channel;
+    };
+
+    // Matches the additional render targets written by frag.glsl
+    static constexpr RenderPass renderPasses[] = {
+        { "depth", 1, 0 },
+        { "steps", 1, 1 },
+        { "shadow", 1, 2 },
+        { "normal", 2, -1 },
+        { "trap", 3, -1 },
+    };
+
+    auto* extra = context->extraFunctions();
+
+    source->bind();
+
+    for (const auto& pass : renderPasses) {
+        const QString passFileName = fileName + "." + pass.name + "." +
+            FrameWriter::getFileExtension(FrameWriter::Format::Float);
+
+        extra->glReadBuffer(GL_COLOR_ATTACHMENT0 + pass.attachment);
+        writer->write(this, source->size(), FrameWriter::Format::Float, passFileName, pass.channel);
+    }
+
+    extra->glReadBuffer(GL_COLOR_ATTACHMENT0);
+    source->release();
+}
+
+GLenum FractalRenderer::getOutputTextureFormat(FrameWriter::Format format)
+{
+    switch (format) {
+        case FrameWriter::Format::RGB8:
+        case FrameWriter::Format::Sequence:
+            return GL_RGBA8;
+
+        case FrameWriter::Format::RGB16:
+            return GL_RGBA16;
+
+        case FrameWriter::Format::Float:
+            return GL_RGBA32F;
+    }
+
+    return GL_RGBA8;
+}
+
+std::unique_ptr<QOpenGLFramebufferObject> FractalRenderer::createFirstPassBuffer(const QSize& size,
+    GLenum internalFormat)
+{
+    // The colour is recorded before exposure and the geometry holds unbounded distances, so all of them need floats
+    QOpenGLFramebufferObjectFormat format;
+    format.setInternalTextureFormat(internalFormat);
+
+    auto buffer = std::make_unique<QOpenGLFramebufferObject>(size, format);
+    buffer->addColorAttachment(size, internalFormat);
+    buffer->addColorAttachment(size, internalFormat);
+    buffer->addColorAttachment(size, internalFormat);
+
+    return buffer;
+}
+
+void FractalRenderer::draw(const RenderParams& p, const QSize& size, int32_t frameIndex, float weight,
+    const QVector2D& pixelOffset, bool renderPasses)
+{
+    auto program = getFractalProgram(p.fractalModule);
+
+    if (program == nullptr) {
+        return;
+    }
+
+    const bool adaptiveAntiAliasing = p.sceneAdaptiveAntiAliasing && p.sceneAntiAliasingSamples > 1.0f;
+    auto computeProgram = getMarchProgram(p, renderPasses);
+
+    if (computeProgram != nullptr) {
+        march(computeProgram, p, size, frameIndex, weight, pixelOffset);
+        return;
+    }
+
+    glViewport(0, 0, size.width(), size.height());
+
+    if (weight >= 1.0f) {
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    program->bind();
+    bindViewportRectangle(program, size);
+    setSceneUniforms(program, p, size, frameIndex, pixelOffset);
+
+    if (adaptiveAntiAliasing) {
+        GLint target = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target);
+
+        // Render passes are read from the centre sample of the first pass, so they get its precision
+        const GLenum firstPassFormat = renderPasses ? GL_RGBA32F : GL_RGBA16F;
+
+        if (!firstPass || firstPass->size() != size || firstPass->format().internalTextureFormat() != firstPassFormat) {
+            firstPass = createFirstPassBuffer(size, firstPassFormat);
+        }
+
+        const GLenum attachments[] = {
+            GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3
+        };
+
+        firstPass->bind();
+        context->extraFunctions()->glDrawBuffers(4, attachments);
+
+        program->setUniformValue("in_anti_aliasing_pass", ANTI_ALIASING_DETECT);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+
+        const auto textures = firstPass->textures();
+
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, textures[0]);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, textures[1]);
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, textures[2]);
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_2D, textures[3]);
+        glActiveTexture(GL_TEXTURE0);
+
+        program->setUniformValue("in_first_pass_colour", 1);
+        program->setUniformValue("in_first_pass_geometry", 2);
+        program->setUniformValue("in_first_pass_material", 3);
+        program->setUniformValue("in_first_pass_cost", 4);
+        program->setUniformValue("in_anti_aliasing_pass", ANTI_ALIASING_REFINE);
+    } else {
+        program->setUniformValue("in_anti_aliasing_pass", ANTI_ALIASING_UNIFORM);
+    }
+
+    if (weight < 1.0f) {
+        // Blend the frame into the framebuffer as `weight * frame + (1 - weight) * framebuffer`
+        glEnable(GL_BLEND);
+        glBlendColor(0.0f, 0.0f, 0.0f, weight);
+        glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+    }
+
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    glDisable(GL_BLEND);
+    blueNoise->release(0);
+
+    if (adaptiveAntiAliasing) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    fractalVAO.release();
+    program->release();
+}
+
+void FractalRenderer::march(QOpenGLShaderProgram* program, const RenderParams& p, const QSize& size,
+    int32_t frameIndex, float weight, const QVector2D& pixelOffset)
+{
+    auto* extra = context->extraFunctions();
+
+    // The frame is stored straight into the colour texture of the bound framebuffer, in the format of the texture
+    GLint target = 0;
+    GLint targetFormat = 0;
+
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME,
+        &target);
+
+    glBindTexture(GL_TEXTURE_2D, target);
+    extra->glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &targetFormat);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    program->bind();
+    setSceneUniforms(program, p, size, frameIndex, pixelOffset);
+
+    // Previous contents are read through samplers so the images need no format matching the textures in the shader
+    glActiveTexture(GL_TEXTURE5);
+    glBindTexture(GL_TEXTURE_2D, target);
+    extra->glBindImageTexture(0, target, 0, GL_FALSE, 0, GL_WRITE_ONLY, targetFormat);
+
+    if (statisticsBound) {
+        glActiveTexture(GL_TEXTURE6);
+        glBindTexture(GL_TEXTURE_2D, statistics->textureId());
+        extra->glBindImageTexture(1, statistics->textureId(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+
+    program->setUniformValue("in_previous_frame", 5);
+    program->setUniformValue("in_previous_statistics", 6);
+    program->setUniformValue("in_weight", weight);
+    program->setUniformValue("in_statistics", statisticsBound);
+
+    // Every frame starts taking tiles from the front of the queue
+    const GLuint firstTile = 0;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileQueue);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(firstTile), &firstTile);
+    extra->glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, tileQueue);
+
+    const int32_t tileCount = ((size.width() + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE) *
+        ((size.height() + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE);
+
+    extra->glDispatchCompute(static_cast<GLuint>(std::min(tileCount, COMPUTE_WORK_GROUPS_MAX)), 1, 1);
+
+    // Image stores are incoherent, so later passes sampling, blending into or reading back the frame must wait for them
+    extra->glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+        GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+
+    extra->glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    extra->glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    extra->glBindImageTexture(1, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+
+    glActiveTexture(GL_TEXTURE5);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE6);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    blueNoise->release(0);
+    program->release();
+}
+
+void FractalRenderer::setSceneUniforms(QOpenGLShaderProgram* program, const RenderParams& p, const QSize& size,
+    int32_t frameIndex, const QVector2D& pixelOffset)
+{
+    program->setUniformValue("in_resolution", QVector2D(size.width(), size.height()));
+    program->setUniformValue("in_pixel_offset", pixelOffset);
+
+    program->setUniformValue("in_camera_position", p.cameraPosition);
+    program->setUniformValue("in_camera_position_low", p.cameraPositionLow);
+    program->setUniformValue("in_camera_rotation", CameraPath::getCameraRotationMatrix(p.cameraRotation));
+
+    // Every fractal iteration magnifies the detail being resolved by the fractal scale. Iterations run in double-float
+    // precision until the detail is as large as the minimum distance at zoom depth 0, which float resolves fine.
+    const float zoom = p.deepZoom ? p.cameraZoom : 0.0f;
+    const float zoomScale = std::exp2(-zoom);
+    const float iterationsPerOctave = 1.0f / std::log2(std::max(std::abs(p.fractalScale), 1.01f));
+    // Modules without double-float iterations still march rays in double-float precision but iterate in float
+    const auto& module = FractalModule::getModules()[p.fractalModule];
+    const int32_t deepZoomIterations = module.deepZoom ? static_cast<int32_t>(std::ceil(zoom * iterationsPerOctave)) : 0;
+
+    program->setUniformValue("in_deep_zoom", p.deepZoom);
+    program->setUniformValue("in_deep_zoom_iterations", deepZoomIterations);
+    program->setUniformValue("in_scene_min_distance", SCENE_MIN_DISTANCE * zoomScale);
+
+    program->setUniformValue("in_fractal_scale", p.fractalScale);
+    program->setUniformValue("in_fractal_inverse_log_scale", 1.0f / std::log(std::max(p.fractalScale, 1.01f)));
+    // The rotation is the same for every fractal iteration of every pixel so only compute its sine and cosine once
+    const float rotationX = p.fractalRotation.x();
+    const float rotationZ = p.fractalRotation.z();
+
+    program->setUniformValue("in_fractal_rotation_x", QVector2D(std::cos(rotationX), std::sin(rotationX)));
+    program->setUniformValue("in_fractal_rotation_z", QVector2D(std::cos(rotationZ), std::sin(rotationZ)));
+    program->setUniformValue("in_fractal_shift", p.fractalPosition);
+    program->setUniformValue("in_fractal_color", p.fractalColor);
+
+    program->setUniformValue("in_scene_ambient_occlusion_delta", p.sceneAmbientOcclusionDelta);
+    program->setUniformValue("in_scene_ambient_occlusion_strength", p.sceneAmbientOcclusionStrength);
+    program->setUniformValue("in_scene_anti_aliasing_samples", p.sceneAntiAliasingSamples);
+    program->setUniformValue("in_scene_background_color", p.sceneBackgroundColor);
+    program->setUniformValue("in_scene_diffuse_lighting", p.sceneDiffuseLighting);
+    program->setUniformValue("in_scene_filtering", p.sceneFiltering);
+    program->setUniformValue("in_scene_focal_distance", p.sceneFocalDistance);
+    program->setUniformValue("in_scene_fog", p.sceneFog);
+    program->setUniformValue("in_scene_level_of_detail", p.sceneLevelOfDetail);
+    program->setUniformValue("in_scene_light_color", p.sceneLightColor);
+    program->setUniformValue("in_scene_light_direction", p.sceneLightDirection);
+    program->setUniformValue("in_scene_lighting_samples", p.sceneLightingSamples);
+    program->setUniformValue("in_scene_sampled_lighting", p.sceneSampledLighting);
+    program->setUniformValue("in_scene_shadows", p.sceneShadows);
+    program->setUniformValue("in_scene_shadow_darkness", p.sceneShadowDarkness);
+    program->setUniformValue("in_scene_shadow_sharpness", p.sceneShadowSharpness);
+    program->setUniformValue("in_scene_specular_highlight", p.sceneSpecularHighlight);
+    program->setUniformValue("in_scene_specular_multiplier", p.sceneSpecularMultiplier);
+    program->setUniformValue("in_scene_heatmap", p.sceneHeatmap);
+
+    blueNoise->bind(0);
+    program->setUniformValue("in_blue_noise", 0);
+    program->setUniformValue("in_frame_index", static_cast<GLfloat>(frameIndex));
+}
+
+void FractalRenderer::toneMap(const RenderParams& p, QOpenGLFramebufferObject* source,
+    QOpenGLFramebufferObject* target, bool toneMapping)
+{
+    const QSize size = target->size();
+
+    target->bind();
+    glViewport(0, 0, size.width(), size.height());
+
+    toneMapProgram->bind();
+    bindViewportRectangle(toneMapProgram.get(), size);
+
+    glBindTexture(GL_TEXTURE_2D, source->texture());
+
+    toneMapProgram->setUniformValue("in_frame", 0);
+    toneMapProgram->setUniformValue("in_resolution", QVector2D(size.width(), size.height()));
+    // Heatmaps keep their colours no matter the exposure
+    const float exposure = p.sceneHeatmap != HEATMAP_NONE ? 1.0f : p.fractalExposure;
+    toneMapProgram->setUniformValue("in_fractal_exposure", exposure);
+    toneMapProgram->setUniformValue("in_tone_mapping", toneMapping);
+
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    fractalVAO.release();
+    toneMapProgram->release();
+    target->release();
+}
+
+void FractalRenderer::bindStatistics(const QSize& size)
+{
+    if (!statistics || statistics->width() != size.width() || statistics->height() != size.height()) {
+        // Sums of march steps over all samples of a pixel quickly exceed the integers half floats represent exactly
+        statistics = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+        statistics->setSize(size.width(), size.height());
+        statistics->setFormat(QOpenGLTexture::RGBA32F);
+        statistics->setMinMagFilters(QOpenGLTexture::Nearest, QOpenGLTexture::Nearest);
+        statistics->setWrapMode(QOpenGLTexture::ClampToEdge);
+        statistics->allocateStorage();
+    }
+
+    // The fractal shader writes the statistics to its fifth render target
+    const GLenum attachments[] = { GL_COLOR_ATTACHMENT0, GL_NONE, GL_NONE, GL_NONE, GL_COLOR_ATTACHMENT1 };
+
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, statistics->textureId(), 0);
+    context->extraFunctions()->glDrawBuffers(5, attachments);
+
+    statisticsBound = true;
+}
+
+void FractalRenderer::releaseStatistics()
+{
+    const GLenum attachments[] = { GL_COLOR_ATTACHMENT0 };
+
+    context->extraFunctions()->glDrawBuffers(1, attachments);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, 0, 0);
+
+    statisticsBound = false;
+}
+
+HeatmapStatistics FractalRenderer::reduceStatistics(const QSize& size)
+{
+    HeatmapStatistics result;
+    result.pixels = static_cast<double>(size.width()) * size.height();
+
+    if (!statistics || !histogramProgram->isLinked()) {
+        return result;
+    }
+
+    static_assert(HeatmapStatistics::BIN_COUNT == 32, "histogram.glsl packs the counts of 16 bins into every target");
+
+    // Every segment of a row gets a column, which holds the packed counts of its bins in four targets followed by the
+    // sums of its statistics in a fifth
+    const QSize segmentsSize((size.width() + HISTOGRAM_SEGMENT_LENGTH - 1) / HISTOGRAM_SEGMENT_LENGTH, size.height());
+
+    if (!histogramSegments || histogramSegments->size() != segmentsSize) {
+        histogramSegments = createLinearBuffer(segmentsSize, GL_RGBA32F);
+
+        for (int32_t i = 1; i < HISTOGRAM_SEGMENT_TARGETS; ++i) {
+            histogramSegments->addColorAttachment(segmentsSize, GL_RGBA32F);
+        }
+    }
+
+    // Every bin gets a column, followed by a column summing up all pixels
+    constexpr int32_t columns = HeatmapStatistics::BIN_COUNT + 1;
+
+    if (!histogramRows || histogramRows->height() != size.height()) {
+        histogramRows = createLinearBuffer(QSize(columns, size.height()), GL_RGBA32F);
+    }
+
+    if (!histogram) {
+        histogram = createLinearBuffer(QSize(columns, 1), GL_RGBA32F);
+    }
+
+    histogramProgram->bind();
+    histogramProgram->setUniformValue("in_source", 0);
+    histogramProgram->setUniformValue("in_march_bins_low", 0);
+    histogramProgram->setUniformValue("in_march_bins_high", 1);
+    histogramProgram->setUniformValue("in_shadow_bins_low", 2);
+    histogramProgram->setUniformValue("in_shadow_bins_high", 3);
+    histogramProgram->setUniformValue("in_totals", 4);
+    histogramProgram->setUniformValue("in_bin_count", static_cast<GLfloat>(HeatmapStatistics::BIN_COUNT));
+
+    QOpenGLFramebufferObject* const targets[] = { histogramSegments.get(), histogramRows.get(), histogram.get() };
+    const auto segments = histogramSegments->textures();
+
+    QSize sourceSize = size;
+
+    for (int32_t pass = HISTOGRAM_SEGMENTS; pass <= HISTOGRAM_SUM; ++pass) {
+        auto* target = targets[pass];
+        const QSize targetSize = target->size();
+
+        target->bind();
+        glViewport(0, 0, targetSize.width(), targetSize.height());
+        bindViewportRectangle(histogramProgram.get(), targetSize);
+
+        if (pass == HISTOGRAM_SEGMENTS) {
+            const GLenum attachments[] = {
+                GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3,
+                GL_COLOR_ATTACHMENT4
+            };
+
+            context->extraFunctions()->glDrawBuffers(HISTOGRAM_SEGMENT_TARGETS, attachments);
+            glBindTexture(GL_TEXTURE_2D, statistics->textureId());
+        } else if (pass == HISTOGRAM_ROWS) {
+            // Every target of the segments gets its own texture unit, ending with the first one on unit 0
+            for (int32_t i = HISTOGRAM_SEGMENT_TARGETS - 1; i >= 0; --i) {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D, segments[i]);
+            }
+        } else {
+            glBindTexture(GL_TEXTURE_2D, histogramRows->texture());
+        }
+
+        histogramProgram->setUniformValue("in_resolution", QVector2D(targetSize.width(), targetSize.height()));
+        histogramProgram->setUniformValue("in_source_size", QVector2D(sourceSize.width(), sourceSize.height()));
+        histogramProgram->setUniformValue("in_histogram_pass", pass);
+
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        sourceSize = targetSize;
+    }
+
+    std::array<GLfloat, columns * 4> bins = {};
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, columns, 1, GL_RGBA, GL_FLOAT, bins.data());
+
+    // The targets of the segments are drawn into again by the next heatmap, so they must not stay bound
+    for (int32_t i = HISTOGRAM_SEGMENT_TARGETS - 1; i >= 0; --i) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    fractalVAO.release();
+    histogramProgram->release();
+    histogram->release();
+
+    for (int32_t bin = 0; bin < HeatmapStatistics::BIN_COUNT; ++bin) {
+        result.marchStepHistogram[bin] = bins[bin * 4 + 0];
+        result.shadowStepHistogram[bin] = bins[bin * 4 + 1];
+    }
+
+    const GLfloat* totals = bins.data() + HeatmapStatistics::BIN_COUNT * 4;
+
+    result.marchSteps = totals[0];
+    result.shadowSteps = totals[1];
+    result.samples = totals[2];
+    result.hits = totals[3];
+
+    return result;
+}
+
+void FractalRenderer::bindViewportRectangle(QOpenGLShaderProgram* program, const QSize& size)
+{
+    fractalVAO.bind();
+
+    if (fractalVBOSize != size) {
+        fractalVBOSize = size;
+
+        const GLfloat w = size.width();
+        const GLfloat h = size.height();
+
+        // Create a rectangle using two triangles which covers the entire viewport
+        GLfloat vertices[] =
+        {
+            // 1st triangle
+            -w, +h,
+            +w, +h,
+            +w, -h,
+
+            // 2nd triangle
+            +w, -h,
+            -w, -h,
+            -w, +h,
+        };
+
+        fractalVBO.bind();
+        fractalVBO.allocate(vertices, sizeof(vertices));
+
+        program->enableAttributeArray(0);
+        program->setAttributeBuffer(0, GL_FLOAT, sizeof(GLfloat) * 0, 2, sizeof(GLfloat) * 2);
+
+        fractalVBO.release();
+    }
+}
+
+QByteArray FractalRenderer::getCacheKey(const QSize& size, GLenum internalFormat, int32_t accumulationFrames,
+    const RenderParams* params, int32_t paramCount, bool renderPasses)
+{
+    if (getFractalProgram(params[0].fractalModule) == nullptr) {
+        return QByteArray();
+    }
+
+    // The sampling pattern of sampled lighting and motion blur depends on the number of frames blended together
+    QByteArray variant = fractalSourceHashes[params[0].fractalModule];
+
+    // Frames marched by the compute shader are kept apart from frames drawn by the fragment shader. All frames blended
+    // together are drawn by the same shader, since they only differ in the camera and the animation.
+    if (getMarchProgram(params[0], renderPasses) != nullptr) {
+        variant += computeSourceHashes[params[0].fractalModule];
+    }
+
+    variant += QByteArray::number(internalFormat) + ":" + QByteArray::number(accumulationFrames);
+
+    return RenderCache::getKey(variant, size, params, paramCount);
+}
+
+bool FractalRenderer::loadCachedFrame(const QByteArray& key, QOpenGLFramebufferObject* target, GLenum internalFormat)
+{
+    const GLenum type = getCachePixelType(internalFormat);
+    const qint64 bytes = static_cast<qint64>(target->width()) * target->height() * (type == GL_FLOAT ? 16 : 8);
+
+    if (key.isEmpty() || !cache->load(key, cachePixels, bytes)) {
+        return false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, target->texture());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, target->width(), target->height(), GL_RGBA, type, cachePixels.constData());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return true;
+}
+
+void FractalRenderer::storeCachedFrame(const QByteArray& key, QOpenGLFramebufferObject* source, GLenum internalFormat)
+{
+    const GLenum type = getCachePixelType(internalFormat);
+    const qint64 bytes = static_cast<qint64>(source->width()) * source->height() * (type == GL_FLOAT ? 16 : 8);
+
+    // Reading back a frame drains the GPU, which is only worth it if the cache is going to keep the frame
+    if (key.isEmpty() || !cache->canStore(key, bytes)) {
+        return;
+    }
+
+    QByteArray pixels = cache->acquire(bytes);
+
+    source->bind();
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, source->width(), source->height(), GL_RGBA, type, pixels.data());
+    source->release();
+
+    cache->store(key, std::move(pixels));
+}
+
+GLenum FractalRenderer::getCachePixelType(GLenum internalFormat)
+{
+    // Frames are cached exactly as they were drawn, so half float buffers are read back without any conversion
+    return internalFormat == GL_RGBA32F ? GL_FLOAT : GL_HALF_FLOAT;
+}
@@ -0,0 +1,545 @@
+#ifndef FRACTALRENDERER_H
+#define FRACTALRENDERER_H
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+
+#include <QImage>
+#include <QObject>
+#include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QOpenGLVertexArrayObject>
+#include <QSize>
+#include <QString>
+
+#include "FrameWriter.h"
+#include "HeatmapStatistics.h"
+#include "RenderCache.h"
+#include "RenderParams.h"
+#include "TripleBuffer.h"
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QThread;
+
+/// \brief
+///     The fractal renderer draws the fractal on a dedicated render thread which owns its own OpenGL context. The
+///     context shares resources with the context of the widget displaying the fractal, so every completed frame is
+///     handed to the widget as a texture which it only has to composite.
+///
+///     Render parameters are passed from the GUI thread to the render thread, and completed frames from the render
+///     thread back to the GUI thread, via lock-free triple buffers so that neither thread ever waits on the other.
+///     Keyframe images are read back on the render thread and saved to disk by a frame writer on its own thread.
+///     Frames drawn before exposure are kept in a render cache on disk, so drawing the same frame again only reads it.
+class FractalRenderer : public QObject, protected QOpenGLFunctions
+{
+    Q_OBJECT
+
+public:
+
+    /// The minimum distance to the fractal surface at which a ray is considered to have hit it, at zoom depth 0.
+    static constexpr float SCENE_MIN_DISTANCE = 1e-5f;
+
+    /// The width and height of the blue noise texture sampled lighting draws its random numbers from.
+    static constexpr int32_t BLUE_NOISE_SIZE = 64;
+
+    /// The maximum number of frames averaged while the parameters do not change. Later frames are blended in with
+    /// a constant weight so the image keeps refining without losing precision.
+    static constexpr int32_t ACCUMULATION_FRAMES_MAX = 64;
+
+    /// The number of previous frames blended with every frame in sampled lighting mode while the parameters change,
+    /// e.g. during animations, which trades a short trail for less noise.
+    static constexpr int32_t TEMPORAL_FRAMES = 1;
+
+    /// The number of frames accumulated into every keyframe saved in sampled lighting mode.
+    static constexpr int32_t KEYFRAME_ACCUMULATION_FRAMES = 16;
+
+    /// The number of distinct frame indices the sampling pattern cycles through. Keeps the index exact in the shader.
+    static constexpr int32_t FRAME_INDEX_PERIOD = 256;
+
+    /// The maximum number of sub-frames blended into every keyframe saved with motion blur.
+    static constexpr int32_t MOTION_BLUR_SAMPLES_MAX = 16;
+
+    /// The number of render targets keyframes saved with render passes are drawn into, including the colour.
+    static constexpr int32_t RENDER_PASS_TARGETS = 4;
+
+    /// The number of pixels of a row the first pass of the histogram shader bins in every fragment. Keeps the counts of
+    /// a segment small enough to be packed four to a channel. Matches `SEGMENT_LENGTH` in histogram.glsl.
+    static constexpr int32_t HISTOGRAM_SEGMENT_LENGTH = 63;
+
+    /// The number of render targets the first pass of the histogram shader writes the counts and sums of a segment to.
+    static constexpr int32_t HISTOGRAM_SEGMENT_TARGETS = 5;
+
+    /// The width and height in pixels of the tiles the compute backend marches, one work group per tile at a time.
+    /// Matches `TILE_SIZE` in compute.glsl.
+    static constexpr int32_t COMPUTE_TILE_SIZE = 8;
+
+    /// The maximum number of persistent work groups the compute backend dispatches per frame, which is enough to keep
+    /// every core of current GPUs busy. Every group keeps taking tiles from the shared queue until the frame is done.
+    static constexpr int32_t COMPUTE_WORK_GROUPS_MAX = 512;
+
+    /// \brief
+    ///     The backends the renderer draws the fractal with, selected once at startup.
+    enum Backend
+    {
+        /// Draws the fractal with the GLSL 1.20 fragment shader on any OpenGL 2.1 context.
+        BACKEND_LEGACY = 0,
+
+        /// Marches the fractal with a compute shader on an OpenGL 4.3 core profile context. Frames drawn with adaptive
+        /// anti-aliasing or render passes still use the fragment shader, translated for the core profile.
+        BACKEND_COMPUTE = 1,
+    };
+
+    /// \brief
+    ///     The diagnostic heatmaps drawn instead of the lit fractal. Matches the `HEATMAP_*` definitions in frag.glsl.
+    enum Heatmap
+    {
+        /// Draws the lit fractal.
+        HEATMAP_NONE = 0,
+
+        /// Colours every pixel by the number of march steps of its rays.
+        HEATMAP_MARCH_STEPS = 1,
+
+        /// Colours every pixel by the number of march steps of its shadow and lighting rays.
+        HEATMAP_SHADOW_STEPS = 2,
+    };
+
+public:
+
+    /// \brief
+    ///     Gets the name of the specified backend as passed on the command line.
+    static QString getBackendName(Backend backend);
+
+    /// \brief
+    ///     Finds the backend with the specified name.
+    /// \return
+    ///     true if the backend was found; false otherwise.
+    static bool findBackend(const QString& name, Backend& backend);
+
+    /// \brief
+    ///     Selects the backend of all renderers and sets the default surface format to the OpenGL context it needs.
+    ///     Must be called before any window or renderer is created.
+    static void setBackend(Backend backend);
+
+    /// \brief
+    ///     Create a new renderer whose context shares resources with the specified context, or a standalone renderer
+    ///     using the default surface format if no context is specified. Must be called on the GUI thread.
+    explicit FractalRenderer(QOpenGLContext* shareContext, QObject* parent = nullptr);
+
+    ~FractalRenderer() override;
+
+    /// \brief
+    ///     Starts the render thread and initializes the shaders on it. Must be called on the GUI thread.
+    void start();
+
+    /// \brief
+    ///     Releases all OpenGL resources and stops the render thread. Must be called on the GUI thread.
+    void stop();
+
+    /// \brief
+    ///     Publishes the parameters for the next frame. Must be called on the GUI thread.
+    /// \param outputFileName
+    ///     The file the keyframe image is saved to, or empty if the frame is not saved.
+    /// \param subFrames
+    ///     The parameters of the sub-frames spread over the shutter interval which are blended into the saved keyframe
+    ///     for motion blur, or nullptr if the keyframe is saved from `params` alone.
+    /// \param subFrameCount
+    ///     The number of sub-frames, at most `MOTION_BLUR_SAMPLES_MAX`.
+    /// \param cacheFrame
+    ///     Determines whether the frame displayed is kept in the render cache, e.g. while previewing keyframes which
+    ///     are likely to be displayed again. Keyframe images are always kept.
+    /// \param renderPassFileName
+    ///     The path, without extension, which the render passes of the keyframe are saved next to, or empty if the
+    ///     keyframe is saved without render passes. Every render pass is saved as a PFM image whose name appends the
+    ///     name of the pass to the path, e.g. `<path>.depth.pfm`.
+    /// \param restartSequence
+    ///     Determines whether the frame sequence the keyframe is saved to is started over with the keyframe, e.g. for
+    ///     the first keyframe of an animation, instead of the keyframe being appended to it.
+    void setParameters(const RenderParams& params, const QString& outputFileName = QString(),
+        const RenderParams* subFrames = nullptr, int32_t subFrameCount = 0, bool cacheFrame = false,
+        const QString& renderPassFileName = QString(), bool restartSequence = false);
+
+    /// \brief
+    ///     Sets the maximum size of the render cache in bytes. A capacity of 0 disables the cache.
+    void setCacheCapacity(qint64 capacity);
+
+    /// \brief
+    ///     Asks the render thread to render a frame using the most recently published parameters. Requests made while
+    ///     a request is already pending are coalesced.
+    void requestFrame();
+
+    /// \brief
+    ///     Acquires the most recently completed frame. Must be called on the GUI thread with a context current which
+    ///     shares resources with the render context.
+    /// \return
+    ///     The texture containing the frame, or 0 if no frame has been completed yet.
+    GLuint acquireFrame();
+
+    /// \brief
+    ///     Renders a single frame on the render thread and waits for it to complete. Used to render frames outside of
+    ///     the interactive frame loop, e.g. for benchmarking. Must be called on the GUI thread after `start`.
+    /// \param params
+    ///     The parameters of the frame, rendered at `viewportSize`.
+    /// \param image
+    ///     The rendered frame.
+    /// \param statistics
+    ///     Receives the statistics of the frame if it is drawn as a heatmap, or nullptr if they are not needed.
+    /// \return
+    ///     The time in nanoseconds it took the GPU to draw the frame, excluding the readback into `image` and the
+    ///     reduction of the statistics.
+    qint64 renderImage(const RenderParams& params, QImage& image, HeatmapStatistics* statistics = nullptr);
+
+signals:
+
+    /// \brief
+    ///     This signal is sent from the render thread whenever a frame has been completed. It is not sent for requests
+    ///     with an empty viewport which save no keyframe, since no frame is drawn for them.
+    void frameReady();
+
+    /// \brief
+    ///     This signal is sent when an error occurs on the render thread.
+    void statusChanged(const QString& message);
+
+private:
+
+    /// \brief
+    ///     Creates the shaders and vertex buffer objects on the render thread.
+    void initialize();
+
+    /// \brief
+    ///     Renders a frame on the render thread.
+    void render();
+
+    /// \brief
+    ///     Releases all OpenGL resources on the render thread and moves this object back to the GUI thread.
+    void shutdown();
+
+    /// \brief
+    ///     Gets the fractal shader of the specified fractal module. The shader is composed from the fragment shader and
+    ///     the GLSL source of the module and linked the first time the module is drawn.
+    /// \return
+    ///     The fractal shader, or nullptr if the module is unknown or its shader failed to link.
+    QOpenGLShaderProgram* getFractalProgram(int32_t module);
+
+    /// \brief
+    ///     Gets the compute shader of the specified fractal module, which splices the fractal source of the module
+    ///     into the compute shader, and links it the first time the module is marched.
+    /// \return
+    ///     The compute shader, or nullptr if the compute backend is not in use or the shader failed to link.
+    QOpenGLShaderProgram* getComputeProgram(int32_t module);
+
+    /// \brief
+    ///     Gets the compute shader a frame is marched with. The compute shader only marches the colour and the
+    ///     statistics of every pixel from a uniform grid of samples, so frames with adaptive anti-aliasing or render
+    ///     passes are drawn with the fractal shader instead.
+    /// \return
+    ///     The compute shader, or nullptr if the frame is drawn with the fractal shader.
+    QOpenGLShaderProgram* getMarchProgram(const RenderParams& p, bool renderPasses);
+
+    /// \brief
+    ///     Reads the fragment shader with the GLSL source of the specified fractal module spliced in.
+    /// \return
+    ///     true if the source was read; false otherwise, in which case the error has been reported.
+    bool readFractalSource(int32_t module, QByteArray& source);
+
+    /// \brief
+    ///     Translates the source of a shader written in GLSL 1.20 for the render context. Core profile contexts have
+    ///     neither the built-in vertex attributes and fragment outputs nor the texture functions of GLSL 1.20, so they
+    ///     are replaced by their modern equivalents. Other contexts compile vertex and fragment shaders as they are.
+    QByteArray translateShader(QByteArray source, QOpenGLShader::ShaderType type) const;
+
+    /// \brief
+    ///     Reads the shader resource with the specified name and translates it for the render context.
+    QByteArray readShader(const QString& fileName, QOpenGLShader::ShaderType type) const;
+
+    /// \brief
+    ///     Determines whether two parameter sets draw the same frame before exposure, i.e. differ at most in exposure.
+    static bool isSameLinearFrame(const RenderParams& a, const RenderParams& b);
+
+    /// \brief
+    ///     Renders a frame in sampled lighting mode by blending it into the frames accumulated so far, progressively
+    ///     while the parameters stay the same and temporally while they change.
+    void accumulate(const RenderParams& params);
+
+    /// \brief
+    ///     Creates a floating point framebuffer which frames are drawn into before exposure, and accumulated into,
+    ///     without losing precision.
+    static std::unique_ptr<QOpenGLFramebufferObject> createLinearBuffer(const QSize& size,
+        GLenum internalFormat = GL_RGBA16F);
+
+    /// \brief
+    ///     Gets the texture format keyframes are tone mapped into before being read back in the specified format.
+    static GLenum getOutputTextureFormat(FrameWriter::Format format);
+
+    /// \brief
+    ///     Reads back the render passes drawn into the additional render targets of the source framebuffer and queues
+    ///     each of them to be saved as a separate PFM image. The distance to the surface, the number of march steps
+    ///     and the shadow factor are saved as greyscale images, the surface normal and the orbit trap colour as RGB.
+    void writeRenderPasses(QOpenGLFramebufferObject* source, const QString& fileName);
+
+    /// \brief
+    ///     Creates the framebuffer the first pass of adaptive anti-aliasing records the colour, the geometry, the
+    ///     material and the cost of every pixel in.
+    static std::unique_ptr<QOpenGLFramebufferObject> createFirstPassBuffer(const QSize& size, GLenum internalFormat);
+
+    /// \brief
+    ///     Draws the fractal to the currently bound framebuffer. With adaptive anti-aliasing a first pass draws every
+    ///     pixel from a single sample, and a second pass draws the additional samples only for pixels on edges.
+    /// \param frameIndex
+    ///     The index of the frame, which selects the random numbers used by sampled lighting.
+    /// \param weight
+    ///     The weight of the frame when blended into the framebuffer. A weight of 1 replaces its contents.
+    /// \param pixelOffset
+    ///     The offset in pixels of every sample, which spreads the samples of blended frames across the pixels.
+    /// \param renderPasses
+    ///     Determines whether the render passes written to the additional render targets of the framebuffer must keep
+    ///     full float precision. The caller selects the render targets drawn into.
+    void draw(const RenderParams& params, const QSize& size, int32_t frameIndex = 0, float weight = 1.0f,
+        const QVector2D& pixelOffset = QVector2D(), bool renderPasses = false);
+
+    /// \brief
+    ///     Marches the fractal with the compute shader straight into the colour texture of the currently bound
+    ///     framebuffer, and into the statistics if they are bound. See `draw` for the parameters.
+    void march(QOpenGLShaderProgram* program, const RenderParams& params, const QSize& size, int32_t frameIndex,
+        float weight, const QVector2D& pixelOffset);
+
+    /// \brief
+    ///     Sets the uniforms the fractal shaders share and binds the blue noise texture.
+    void setSceneUniforms(QOpenGLShaderProgram* program, const RenderParams& params, const QSize& size,
+        int32_t frameIndex, const QVector2D& pixelOffset);
+
+    /// \brief
+    ///     Applies exposure to a frame drawn before exposure and writes the result to the target framebuffer.
+    /// \param toneMapping
+    ///     Determines whether the result is clamped to the displayable range. Linear output keeps it unbounded.
+    void toneMap(const RenderParams& params, QOpenGLFramebufferObject* source, QOpenGLFramebufferObject* target,
+        bool toneMapping);
+
+    /// \brief
+    ///     Attaches the statistics texture to the currently bound framebuffer so that frames drawn as a heatmap record
+    ///     the statistics of every pixel, creating the texture if needed.
+    void bindStatistics(const QSize& size);
+
+    /// \brief
+    ///     Detaches the statistics texture from the currently bound framebuffer.
+    void releaseStatistics();
+
+    /// \brief
+    ///     Reduces the statistics recorded by the last frame drawn as a heatmap to histograms on the GPU, so that only
+    ///     the histograms are read back.
+    HeatmapStatistics reduceStatistics(const QSize& size);
+
+    /// \brief
+    ///     Binds the vertex array of the rectangle covering a viewport of the specified size.
+    void bindViewportRectangle(QOpenGLShaderProgram* program, const QSize& size);
+
+    /// \brief
+    ///     Computes the key under which a frame drawn before exposure is kept in the render cache.
+    /// \param internalFormat
+    ///     The format of the buffer the frame is drawn into.
+    /// \param accumulationFrames
+    ///     The number of frames blended into the buffer.
+    /// \param params
+    ///     The parameters of the frames blended into the buffer, which all draw the same fractal module.
+    /// \param paramCount
+    ///     The number of distinct parameter sets in `params`.
+    /// \param renderPasses
+    ///     Determines whether the render passes are drawn along with the frame, which decides the shader drawing it.
+    /// \return
+    ///     The key, or an empty key if the fractal module cannot be drawn.
+    QByteArray getCacheKey(const QSize& size, GLenum internalFormat, int32_t accumulationFrames,
+        const RenderParams* params, int32_t paramCount, bool renderPasses = false);
+
+    /// \brief
+    ///     Reads a frame from the render cache into the texture of the target framebuffer.
+    /// \return
+    ///     true if the frame was cached; false otherwise.
+    bool loadCachedFrame(const QByteArray& key, QOpenGLFramebufferObject* target, GLenum internalFormat);
+
+    /// \brief
+    ///     Reads back the source framebuffer and queues it to be kept in the render cache, unless the cache would drop
+    ///     it anyway.
+    void storeCachedFrame(const QByteArray& key, QOpenGLFramebufferObject* source, GLenum internalFormat);
+
+    /// \brief
+    ///     Gets the type of the channels of cached frames drawn into buffers of the specified format.
+    static GLenum getCachePixelType(GLenum internalFormat);
+
+private:
+
+    /// \brief
+    ///     The passes of the fragment shader. Matches the `ANTI_ALIASING_*` definitions in frag.glsl.
+    enum AntiAliasingPass
+    {
+        /// Draws every pixel from all anti-aliasing samples.
+        ANTI_ALIASING_UNIFORM = 0,
+
+        /// Records the colour, the geometry and the material of a single sample at the centre of every pixel.
+        ANTI_ALIASING_DETECT = 1,
+
+        /// Draws the pixels of the detection pass, adding all anti-aliasing samples to pixels on edges.
+        ANTI_ALIASING_REFINE = 2,
+    };
+
+    /// \brief
+    ///     The passes of the histogram shader. Matches the `HISTOGRAM_*` definitions in histogram.glsl.
+    enum HistogramPass
+    {
+        /// Counts the pixels of every segment of every row of the statistics in every bin, reading every pixel once.
+        HISTOGRAM_SEGMENTS = 0,
+
+        /// Sums up the segments of every row of the first pass.
+        HISTOGRAM_ROWS = 1,
+
+        /// Sums up the rows of the second pass.
+        HISTOGRAM_SUM = 2,
+    };
+
+    /// \brief
+    ///     A request to render a frame, optionally saving it to disk.
+    struct FrameRequest
+    {
+        RenderParams params;
+        QString outputFileName;
+
+        /// The path the render passes of the saved keyframe are saved next to, or empty if there are none.
+        QString renderPassFileName;
+
+        /// The sub-frames blended into the saved keyframe. Stored in place so publishing a request never allocates.
+        std::array<RenderParams, MOTION_BLUR_SAMPLES_MAX> subFrames;
+        int32_t subFrameCount = 0;
+
+        /// Determines whether the frame displayed is kept in the render cache.
+        bool cacheFrame = false;
+
+        /// Determines whether the frame sequence the keyframe is saved to starts over with the keyframe.
+        bool restartSequence = false;
+    };
+
+    /// \brief
+    ///     Draws the keyframe of a frame request at the output size and queues it, along with its render passes, to be
+    ///     saved. Does nothing if the request saves no keyframe.
+    void exportKeyframe(const FrameRequest& request);
+
+private:
+
+    /// The backend selected at startup.
+    static Backend selectedBackend;
+
+    /// The thread on which all rendering happens.
+    QThread* thread = nullptr;
+
+    /// The context used for rendering on the render thread.
+    QOpenGLContext* context = nullptr;
+
+    /// The surface the render context is made current against. All rendering happens into framebuffer objects.
+    QOffscreenSurface* surface = nullptr;
+
+    /// The fractal vertex buffer which is defined by two triangles forming a rectanble the size of our viewport.
+    QOpenGLBuffer fractalVBO;
+
+    /// The fractal vertex array object which saves the state of the VBO.
+    QOpenGLVertexArrayObject fractalVAO;
+
+    /// The fractal shaders which draw the fractal to the VBO, by index of the fractal module they were composed for.
+    /// Modules whose shader failed to link map to nullptr.
+    std::map<int32_t, std::unique_ptr<QOpenGLShaderProgram>> fractalPrograms;
+
+    /// The hashes of the sources of the fractal shaders, by index of the fractal module. Part of every cache key so
+    /// that frames drawn by a different version of a shader are never found.
+    std::map<int32_t, QByteArray> fractalSourceHashes;
+
+    /// Determines whether the fractal is marched with compute shaders, i.e. the compute backend is selected and the
+    /// render context supports compute shaders.
+    bool computeMarching = false;
+
+    /// The compute shaders which march the fractal, by index of the fractal module they were composed for. Modules
+    /// whose shader failed to link map to nullptr and are drawn with the fragment shader instead.
+    std::map<int32_t, std::unique_ptr<QOpenGLShaderProgram>> computePrograms;
+
+    /// The hashes of the sources of the compute shaders, by index of the fractal module.
+    std::map<int32_t, QByteArray> computeSourceHashes;
+
+    /// The shader storage buffer holding the index of the next tile the persistent work groups of the compute shader
+    /// take from the shared queue.
+    GLuint tileQueue = 0;
+
+    /// The size the fractal vertex buffer was last allocated for.
+    QSize fractalVBOSize;
+
+    /// The shader which applies exposure to frames drawn by the fractal shaders.
+    std::unique_ptr<QOpenGLShaderProgram> toneMapProgram;
+
+    /// The shader which reduces the statistics of frames drawn as a heatmap to histograms.
+    std::unique_ptr<QOpenGLShaderProgram> histogramProgram;
+
+    /// The statistics of every pixel of the last frame drawn as a heatmap.
+    std::unique_ptr<QOpenGLTexture> statistics;
+
+    /// The packed histograms and the sums of every segment of every row of `statistics`.
+    std::unique_ptr<QOpenGLFramebufferObject> histogramSegments;
+
+    /// The histograms of every row of `statistics`.
+    std::unique_ptr<QOpenGLFramebufferObject> histogramRows;
+
+    /// The histograms of the whole frame.
+    std::unique_ptr<QOpenGLFramebufferObject> histogram;
+
+    /// Determines whether `statistics` is attached to the currently bound framebuffer.
+    bool statisticsBound = false;
+
+    /// The most recent frame drawn outside of sampled lighting mode, before exposure.
+    std::unique_ptr<QOpenGLFramebufferObject> linearFrame;
+
+    /// The parameters `linearFrame` was drawn with.
+    RenderParams linearFrameParams;
+
+    /// The blue noise texture sampled lighting draws its random numbers from.
+    std::unique_ptr<QOpenGLTexture> blueNoise;
+
+    /// The colour, the geometry, the material and the cost recorded by the first pass of adaptive anti-aliasing.
+    std::unique_ptr<QOpenGLFramebufferObject> firstPass;
+
+    /// The frames accumulated in sampled lighting mode.
+    std::unique_ptr<QOpenGLFramebufferObject> accumulation;
+
+    /// The parameters of the most recent frame blended into `accumulation`.
+    RenderParams accumulationParams;
+
+    /// The number of frames currently averaged in `accumulation`.
+    int32_t accumulatedFrames = 0;
+
+    /// The index of the next frame rendered in sampled lighting mode.
+    int32_t nextFrameIndex = 0;
+
+    /// The most recent keyframe saved, before exposure, along with the attachments of its render passes.
+    std::unique_ptr<QOpenGLFramebufferObject> keyframeBuffer;
+
+    /// The most recent keyframe saved, after exposure, in the format it is read back in.
+    std::unique_ptr<QOpenGLFramebufferObject> keyframeOutput;
+
+    /// The writer saving keyframe images to disk.
+    std::unique_ptr<FrameWriter> writer;
+
+    /// The frames drawn before exposure kept on disk.
+    std::unique_ptr<RenderCache> cache;
+
+    /// The pixels of the frame last read from the render cache, kept around so its allocation is reused.
+    QByteArray cachePixels;
+
+    /// Frame requests published by the GUI thread and consumed by the render thread.
+    TripleBuffer<FrameRequest> requests;
+
+    /// Frames completed by the render thread and consumed by the GUI thread.
+    TripleBuffer<std::unique_ptr<QOpenGLFramebufferObject>> frames;
+
+    /// Determines whether a frame request has been queued but not yet started.
+    std::atomic<bool> framePending { false };
+};
+
+#endif // FRACTALRENDERER_H
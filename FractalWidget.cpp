@@ -1,422 +1,429 @@
 #include "FractalWidget.h"
 
+#include "FractalModule.h"
+
 #include <algorithm>
 #include <QApplication>
 #include <QDir>
+#include <QOpenGLPixelTransferOptions>
 #include <QMouseEvent>
+#include <QWheelEvent>
 #include <QScreen>
+#include <QShowEvent>
 #include <QtMath>
 #include <QTimerEvent>
 #include <QQuaternion>
 
-static QQuaternion exp(QQuaternion q)
+/// \brief
+///     Adds `delta` to the double-float value `hi + lo`, keeping the rounding error of the sum in `lo`. This relies on
+///     exact IEEE float rounding so it must not be compiled with fast math.
+static void addPrecise(QVector3D& hi, QVector3D& lo, QVector3D delta)
 {
-    auto x = q.x();
-    auto y = q.y();
-    auto z = q.z();
-    auto w = q.scalar();
+    for (int32_t i = 0; i < 3; ++i) {
+        const float a = hi[i];
+        const float b = delta[i];
 
-    auto immaginaryNorm = std::sqrt((x * x) + (y * y) + (z * z));
+        const float s = a + b;
+        const float v = s - a;
+        const float e = (a - (s - v)) + (b - v) + lo[i];
 
-    auto r = std::exp(w) * std::cos(immaginaryNorm);
-    auto i = 0;
-    auto j = 0;
-    auto k = 0;
+        hi[i] = s + e;
+        lo[i] = e - (hi[i] - s);
+    }
+}
 
-    // Avoid division by 0
-    if (immaginaryNorm == 0) {
-        return QQuaternion(r, i, j, k);
-    } else {
-        i = std::exp(w) * (x * std::sin(immaginaryNorm)) / immaginaryNorm;
-        j = std::exp(w) * (y * std::sin(immaginaryNorm)) / immaginaryNorm;
-        k = std::exp(w) * (z * std::sin(immaginaryNorm)) / immaginaryNorm;
+FractalWidget::FractalWidget(QWidget *parent) :
+    QOpenGLWidget(parent)
+{
+    setFormat(QSurfaceFormat::defaultFormat());
+}
 
-        return QQuaternion(r, i, j, k);
+FractalWidget::~FractalWidget()
+{
+    if (renderer) {
+        renderer->stop();
     }
+
+    makeCurrent();
+    playbackTexture.reset();
+    blitter.destroy();
+    doneCurrent();
 }
 
-/// \note
-///     This function assumes a branch cut (-inf, 0]
-static QQuaternion log(QQuaternion q)
+bool FractalWidget::animateKeyframes()
 {
-    auto x = q.x();
-    auto y = q.y();
-    auto z = q.z();
-    auto w = q.scalar();
+    if (playbackActive) {
+        emit statusChanged("Cannot animate while playing back a frame sequence");
+        return false;
+    }
 
-    auto immaginaryNorm = std::sqrt((x * x) + (y * y) + (z * z));
+    if (!animateKeyframesActive && !previewKeyframesActive) {
+        grabKeyboard();
 
-    // Avoid division by 0
-    if (immaginaryNorm == 0) {
-        auto r = std::log(q.length());
-        auto i = x * std::atan2(immaginaryNorm, w);
-        auto j = y * std::atan2(immaginaryNorm, w);
-        auto k = z * std::atan2(immaginaryNorm, w);
+        if (cameraPath.size() > 1) {
+            compileCameraPath();
 
-        return QQuaternion(r, i, j, k);
-    } else {
-        auto r = std::log(q.length());
-        auto i = (x * std::atan2(immaginaryNorm, w)) / immaginaryNorm;
-        auto j = (y * std::atan2(immaginaryNorm, w)) / immaginaryNorm;
-        auto k = (z * std::atan2(immaginaryNorm, w)) / immaginaryNorm;
+            fractalKeyframeBegin = fractalKeyframeCurrent;
+            animateKeyframesActive = true;
+            outputSequenceRestart = true;
+        }
 
-        return QQuaternion(r, i, j, k);
+        if (outputFormat == FrameWriter::Format::Sequence) {
+            // Keyframes of a frame sequence are numbered by their index in the sequence, which starts over with the
+            // animation and so holds no frames yet
+            outputLastDrawnFrame = 0;
+        } else {
+            const QString pattern = "*." + FrameWriter::getFileExtension(outputFormat);
+            auto drawnFrames = QDir(outputDirectory).entryInfoList({ pattern }, QDir::Files, QDir::SortFlag::Time);
+            if (drawnFrames.size() > 0) {
+                outputLastDrawnFrame = drawnFrames.last().baseName().toLong();
+            } else {
+                outputLastDrawnFrame = 0;
+            }
+        }
     }
-}
-
-static QMatrix3x3 toRotationMatrix(QVector3D r)
-{
-    auto rx = QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, r.x() / (M_PI / 180.0f));
-    auto ry = QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, r.y() / (M_PI / 180.0f));
-    auto rz = QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, r.z() / (M_PI / 180.0f));
 
-    return (rx * ry * rz).toRotationMatrix();
+    return animateKeyframesActive;
 }
 
-void FractalWidget::blend()
+bool FractalWidget::playSequence(const QString& fileName)
 {
-    // https://en.wikipedia.org/wiki/Gaussian_quadrature
-    auto const gaussianQuadrature = [this](float a, float b) -> float
-    {
-        // Precalculated 5th order Gauss–Legendre quadrature coefficients
-        static constexpr std::pair<float,float> coefficients[] =
-        {
-            {  0.00000000f, 0.56888890f },
-            { -0.53846930f, 0.47862867f },
-            {  0.53846930f, 0.47862867f },
-            { -0.90617985f, 0.23692688f },
-            {  0.90617985f, 0.23692688f },
-        };
-
-        float s = 0.0f;
-
-        // Change of interval formula
-        for (auto [xi, wi] : coefficients) {
-            s += wi * interpolatePosition(((b - a) / 2 * xi) + ((b + a) / 2), true).length();
-        }
-
-        return s * ((b - a) / 2);
-    };
+    if (animateKeyframesActive || previewKeyframesActive) {
+        emit statusChanged("Cannot play back a frame sequence while animating");
+        return false;
+    }
 
-    s2uTable.clear();
+    QString error;
+    if (!playbackSequence.map(fileName, error)) {
+        emit statusChanged(error);
+        return false;
+    }
 
-    float s = 0.0f;
-    float u = 0.0f;
+    if (playbackSequence.getFrameCount() == 0) {
+        emit statusChanged("Frame sequence \"" + fileName + "\" has no frames");
+        playbackSequence.close();
+        return false;
+    }
 
-    while (u < positionWaypoints.size() - 1) {
-        s2uTable.append({s, u});
+    const QSize size = playbackSequence.getSize();
 
-        s += gaussianQuadrature(u, u + 0.01f);
-        u += 0.01f;
-    }
-}
+    makeCurrent();
 
-float FractalWidget::s2u(float s)
-{
-    auto const comp = [](const decltype(s2uTable)::value_type& a, const decltype(s2uTable)::value_type& b) -> bool
-    {
-        return a.first < b.first;
-    };
+    playbackTexture = std::make_unique<QOpenGLTexture>(QOpenGLTexture::Target2D);
+    playbackTexture->setSize(size.width(), size.height());
+    playbackTexture->setFormat(QOpenGLTexture::RGB8_UNorm);
+    playbackTexture->setMinMagFilters(QOpenGLTexture::Linear, QOpenGLTexture::Linear);
+    playbackTexture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    playbackTexture->allocateStorage(QOpenGLTexture::RGB, QOpenGLTexture::UInt8);
 
-    auto i1 = std::upper_bound(s2uTable.begin(), s2uTable.end() - 1, QPair(s, 0.0f), comp);
-    auto i0 = i1--;
+    doneCurrent();
 
-    auto u0 = i0->second;
-    auto u1 = i1->second;
+    grabKeyboard();
 
-    auto s0 = i0->first;
-    auto s1 = i1->first;
+    playbackFrame = -1;
+    playbackActive = true;
+    playbackTimer.start();
 
-    // https://en.wikipedia.org/wiki/Linear_interpolation#Linear_interpolation_between_two_known_points
-    auto a = (s - s0) / (s1 - s0);
+    update();
 
-    return (1 - a) * u0 + a * u1;
+    return true;
 }
 
-QVector3D FractalWidget::interpolatePosition(float t, bool takeDerivative)
+void FractalWidget::stopSequence()
 {
-    if (t <= 0) {
-        return positionWaypoints.first();
+    if (!playbackActive) {
+        return;
     }
 
-    if (t >= positionWaypoints.size() - 1) {
-        return positionWaypoints.last();
-    }
+    playbackActive = false;
 
-    const int32_t i = std::floor(t);
+    makeCurrent();
+    playbackTexture.reset();
+    doneCurrent();
 
-    float u_0 = 1.0f;
-    float u_1 = t - i;
-    float u_2 = u_1 * u_1;
-    float u_3 = u_2 * u_1;
+    playbackSequence.close();
 
-    if (takeDerivative) {
-        u_0 = 0.0f;
-        u_1 = 1.0f;
-        u_2 = 2 * (t - i);
-        u_3 = 3 * (t - i) * (t - i);
-    }
-
-    QVector4D u(u_0, u_1, u_2, u_3);
+    // The render loop stopped requesting frames during playback so kick it off again
+    renderNextFrame();
+}
 
-    QMatrix4x4 B(0, -1, 2, -1, 2, 0, -5, 3, 0, 1, 4, -3, 0, 0, -1, 1);
-    QMatrix4x4 G;
+bool FractalWidget::previewKeyframes()
+{
+    if (playbackActive) {
+        emit statusChanged("Cannot preview while playing back a frame sequence");
+        return false;
+    }
 
-    // Catmull-Rom splines require at least four points for interpolation. In reality we should be able to interpolate
-    // between two points in 3D space, i.e. the interpolation should be a straight line. To handle this situation we
-    // use the recorded look direction to compute two additional points; one at the start and one at the end, which we
-    // will use as the interpolation control points. Using the look directions ensures that the tangent at the start
-    // and end points is identical to the look direction, which will ensure we end up at the same positions and
-    // rotations recorded.
+    if (!animateKeyframesActive && !previewKeyframesActive) {
+        grabKeyboard();
 
-    QVector3D column0 = (i != 0) ?
-        positionWaypoints[i - 1] :
-        positionWaypoints[i + 0] - getLookDirectionFromRotation(rotationWaypoints[i + 0]);
+        if (cameraPath.size() > 1) {
+            compileCameraPath();
 
-    QVector3D column1 = positionWaypoints[i + 0];
-    QVector3D column2 = positionWaypoints[i + 1];
+            fractalKeyframeBegin = fractalKeyframeCurrent;
+            previewKeyframesActive = true;
+        }
+    }
 
-    QVector3D column3 = (i != positionWaypoints.size() - 2) ?
-        positionWaypoints[i + 2] :
-        positionWaypoints[i + 1] + getLookDirectionFromRotation(rotationWaypoints[i + 1]);
+    return previewKeyframesActive;
+}
 
-    G.setColumn(0, {column0, 0});
-    G.setColumn(1, {column1, 0});
-    G.setColumn(2, {column2, 0});
-    G.setColumn(3, {column3, 0});
+void FractalWidget::setCameraPath(const CameraPath& path)
+{
+    if (!animateKeyframesActive && !previewKeyframesActive) {
+        cameraPath = path;
+    }
+}
 
-    const float tau = 0.5f;
+const CameraPath& FractalWidget::getCameraPath() const
+{
+    return cameraPath;
+}
 
-    return (G * B * tau * u).toVector3D();
+void FractalWidget::addWaypoint()
+{
+    addWaypoint(renderParams.cameraPosition, renderParams.cameraRotation);
 }
 
-QVector3D FractalWidget::interpolateRotation(float t)
+void FractalWidget::addWaypoint(QVector3D position, QVector3D rotation)
 {
-    if (t <= 0) {
-        return rotationWaypoints.first();
+    if (!animateKeyframesActive && !previewKeyframesActive) {
+        cameraPath.addWaypoint(position, rotation);
     }
+}
 
-    if (t >= rotationWaypoints.size() - 1) {
-        return rotationWaypoints.last();
+void FractalWidget::clearWayPoints()
+{
+    if (!animateKeyframesActive && !previewKeyframesActive) {
+        cameraPath.clear();
     }
+}
 
-    const int32_t i = std::floor(t);
+bool FractalWidget::enforceCameraPathClearance()
+{
+    if (animateKeyframesActive || previewKeyframesActive) {
+        emit statusChanged("Cannot change the camera path while animating");
+        return false;
+    }
 
-    // fromEulerAngles
-    QQuaternion qi0 =
-        QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints[i].y() / (M_PI / 180.0f)) *
-        QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints[i].x() / (M_PI / 180.0f)) *
-        QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints[i].z() / (M_PI / 180.0f));
+    const PathPlanner planner = getPathPlanner();
 
-    QQuaternion qi1 =
-        QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints[i + 1].y() / (M_PI / 180.0f)) *
-        QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints[i + 1].x() / (M_PI / 180.0f)) *
-        QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints[i + 1].z() / (M_PI / 180.0f));
+    if (!planner.isValid()) {
+        emit statusChanged("The fractal has no distance estimate to check camera paths against");
+        return false;
+    }
 
-    QQuaternion si0;
+    if (cameraPath.size() < 2) {
+        emit statusChanged("Record at least two waypoints to check the camera path");
+        return false;
+    }
 
-    if (i <= 1) {
-        si0 = qi0;
-    } else {
-        QQuaternion qim1 =
-            QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints[i - 1].y() / (M_PI / 180.0f)) *
-            QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints[i - 1].x() / (M_PI / 180.0f)) *
-            QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints[i - 1].z() / (M_PI / 180.0f));
+    const int32_t violations = planner.enforceClearance(cameraPath, cameraPathClearance);
 
-        // Section 6.2.1, Definition 17, (6.15) pg. 51 of https://web.mit.edu/2.998/www/QuaternionReport1.pdf
-        si0 = qi0 * exp(-(log(qi0.inverted() * qi1) + log(qi0.inverted() * qim1)) / 4);
+    if (violations > 0) {
+        emit statusChanged(QString("%1 samples of the camera path are still closer than %2 to the fractal")
+            .arg(violations).arg(cameraPathClearance));
+        return false;
     }
 
-    QQuaternion si1;
-
-    if (i >= rotationWaypoints.size() - 3) {
-        si1 =
-            QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints.last().y() / (M_PI / 180.0f)) *
-            QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints.last().x() / (M_PI / 180.0f)) *
-            QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints.last().z() / (M_PI / 180.0f));
-    } else {
-        QQuaternion qip2 =
-            QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, rotationWaypoints[i + 2].y() / (M_PI / 180.0f)) *
-            QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, rotationWaypoints[i + 2].x() / (M_PI / 180.0f)) *
-            QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, rotationWaypoints[i + 2].z() / (M_PI / 180.0f));
+    emit statusChanged(QString("The camera path keeps a clearance of %1 to the fractal").arg(cameraPathClearance));
+    return true;
+}
 
-        // Section 6.2.1, Definition 17, (6.15) pg. 51 of https://web.mit.edu/2.998/www/QuaternionReport1.pdf
-        si1 = qi1 * exp(-(log(qi1.inverted() * qip2) + log(qi1.inverted() * qi0)) / 4);
+bool FractalWidget::exploreCameraPath()
+{
+    if (animateKeyframesActive || previewKeyframesActive) {
+        emit statusChanged("Cannot change the camera path while animating");
+        return false;
     }
 
-    auto h = t - i;
+    const PathPlanner planner = getPathPlanner();
+
+    if (!planner.isValid()) {
+        emit statusChanged("The fractal has no distance estimate to explore it with");
+        return false;
+    }
 
-    // Section 6.2.1, Definition 17, (6.14) pg. 51 of https://web.mit.edu/2.998/www/QuaternionReport1.pdf
-    auto squad = QQuaternion::slerp(QQuaternion::slerp(qi0, qi1, h), QQuaternion::slerp(si0, si1, h), 2 * h * (1 - h));
+    cameraPath = planner.explore(renderParams.cameraPosition, renderParams.cameraRotation,
+        CAMERA_PATH_EXPLORE_WAYPOINTS, cameraPathClearance, cameraPathExploreSeed++);
 
-    return squad.toEulerAngles() * static_cast<float>(M_PI / 180.0f);
+    emit statusChanged(QString("Generated an exploratory camera path with %1 waypoints").arg(cameraPath.size()));
+    return true;
 }
 
-FractalWidget::FractalWidget(QWidget *parent) :
-    QOpenGLWidget(parent)
+PathPlanner FractalWidget::getPathPlanner() const
 {
-    setFormat(QSurfaceFormat::defaultFormat());
+    RenderParams params = renderParams;
+    params.fractalRotation = getAnimatedFractalRotation(params.fractalRotation,
+        fractalKeyframeCurrent + fractalKeyframeFraction);
+
+    return PathPlanner(params);
 }
 
-void FractalWidget::animateKeyframes()
+void FractalWidget::compileCameraPath()
 {
-    if (!animateKeyframesActive && !previewKeyframesActive) {
-        grabKeyboard();
+    if (!cameraPath.isCompiled()) {
+        cameraPath.compile();
+    }
 
-        if (positionWaypoints.size() > 1) {
-            blend();
+    if (!outputAdaptiveSpeed) {
+        cameraPath.setSpeedProfile({});
+        return;
+    }
 
-            fractalKeyframeBegin = fractalKeyframeCurrent;
-            animateKeyframesActive = true;
-        }
+    // The speed profile depends on the fractal as well as the path so it is computed anew for every animation
+    const PathPlanner planner = getPathPlanner();
 
-        auto drawnFrames = QDir(outputDirectory).entryInfoList({ "*.png" }, QDir::Files, QDir::SortFlag::Time);
-        if (drawnFrames.size() > 0) {
-            outputLastDrawnFrame = drawnFrames.last().baseName().toLong();
-        } else {
-            outputLastDrawnFrame = 0;
-        }
+    if (planner.isValid()) {
+        planner.compileSpeedProfile(cameraPath);
+    } else {
+        emit statusChanged("The fractal has no distance estimate to adapt the camera speed to");
+        cameraPath.setSpeedProfile({});
     }
 }
 
-void FractalWidget::previewKeyframes()
+QVector3D FractalWidget::getAnimatedFractalRotation(QVector3D rotation, float keyframe)
 {
-    if (!animateKeyframesActive && !previewKeyframesActive) {
-        grabKeyboard();
-
-        if (positionWaypoints.size() > 1) {
-            blend();
+    rotation.setX(rotation.x() + ANIMATION_SIN_OUTER_FACTOR * std::sin(keyframe * ANIMATION_SIN_INNER_FACTOR));
+    return rotation;
+}
 
-            fractalKeyframeBegin = fractalKeyframeCurrent;
-            previewKeyframesActive = true;
-        }
-    }
+const QVector3D FractalWidget::getLookDirectionFromCamera() const
+{
+    return getLookDirectionFromRotation(renderParams.cameraRotation);
 }
 
-void FractalWidget::addWaypoint()
+const QVector3D FractalWidget::getLookDirectionFromRotation(QVector3D rotation) const
 {
-    addWaypoint(cameraPosition, cameraRotation);
+    return CameraPath::getLookDirectionFromRotation(rotation);
 }
 
-void FractalWidget::addWaypoint(QVector3D position, QVector3D rotation)
+const QVector3D FractalWidget::getCameraPosition() const
 {
-    if (!animateKeyframesActive && !previewKeyframesActive) {
-        positionWaypoints.append(position);
-        rotationWaypoints.append(rotation);
-    }
+    return renderParams.cameraPosition;
 }
 
-void FractalWidget::clearWayPoints()
+const QVector3D FractalWidget::getCameraRotation() const
 {
-    if (!animateKeyframesActive && !previewKeyframesActive) {
-        positionWaypoints.clear();
-        rotationWaypoints.clear();
-    }
+    return renderParams.cameraRotation;
 }
 
-const QVector3D FractalWidget::getLookDirectionFromCamera() const
+float FractalWidget::getCameraZoom() const
 {
-    return getLookDirectionFromRotation(cameraRotation);
+    return renderParams.cameraZoom;
 }
 
-const QVector3D FractalWidget::getLookDirectionFromRotation(QVector3D rotation) const
+const QVector3D FractalWidget::getSceneLightDirection() const
 {
-    auto rotationMatrix = toRotationMatrix(rotation);
-    return QVector3D(rotationMatrix(0, 2), rotationMatrix(1, 2), rotationMatrix(2, 2));
+    return renderParams.sceneLightDirection;
 }
 
-const QVector3D FractalWidget::getCameraPosition() const
+const QList<QVector3D>& FractalWidget::getPositionWaypoints() const
 {
-    return cameraPosition;
+    return cameraPath.getPositionWaypoints();
 }
 
-const QVector3D FractalWidget::getCameraRotation() const
+const QList<QVector3D>& FractalWidget::getRotationWaypoints() const
 {
-    return cameraRotation;
+    return cameraPath.getRotationWaypoints();
 }
 
 void FractalWidget::setCameraPosition(QVector3D value)
 {
-    auto x = QString::number(value.x(), 'f', 4).toFloat();
-    auto y = QString::number(value.y(), 'f', 4).toFloat();
-    auto z = QString::number(value.z(), 'f', 4).toFloat();
+    setCameraPositionPrecise(value, QVector3D());
+}
 
-    value.setX(x);
-    value.setY(y);
-    value.setZ(z);
+void FractalWidget::setCameraPositionPrecise(QVector3D value, QVector3D valueLow)
+{
+    renderParams.cameraPositionLow = valueLow;
 
-    if (cameraPosition != value) {
-        cameraPosition = value;
-        emit cameraPositionChaged(cameraPosition);
+    // The camera is kept in full precision and is only rounded by the spin boxes displaying it. Quantizing it here
+    // would cause visible stair-stepping in slow animations.
+    if (renderParams.cameraPosition != value) {
+        renderParams.cameraPosition = value;
+        emit cameraPositionChaged(renderParams.cameraPosition);
     }
 }
 
 void FractalWidget::setCameraRotation(QVector3D value)
 {
-    auto x = QString::number(value.x(), 'f', 4).toFloat();
-    auto y = QString::number(value.y(), 'f', 4).toFloat();
-    auto z = QString::number(value.z(), 'f', 4).toFloat();
-
     // Clamp the rotation to within (-2pi, 2pi) radians
-    x = std::fmod(x, static_cast<float>(2 * M_PI));
-    y = std::fmod(y, static_cast<float>(2 * M_PI));
-    z = std::fmod(z, static_cast<float>(2 * M_PI));
-
-    value.setX(x);
-    value.setY(y);
-    value.setZ(z);
-
-    if (cameraRotation != value) {
-        cameraRotation = value;
-
-        auto rx = QQuaternion::fromAxisAndAngle({1.0f, 0.0f, 0.0f}, cameraRotation.x() / (M_PI / 180.0f));
-        auto ry = QQuaternion::fromAxisAndAngle({0.0f, 1.0f, 0.0f}, cameraRotation.y() / (M_PI / 180.0f));
-        auto rz = QQuaternion::fromAxisAndAngle({0.0f, 0.0f, 1.0f}, cameraRotation.z() / (M_PI / 180.0f));
-
-        // Quaternion multiplication is not commutative. We want our camera to be a first person view and not a flight
-        // simulator camera. As such we want to rotate through the y-axis first and then through the x-axis. That is,
-        // we want to fix the y-axis to be the natural gravitational y-axis.
-        //
-        // We can make a simple example with head rotations. Pretend you had a virtual stick going through your ears
-        // which represents the x-axis. Similarly pretend you had a virtual stick going through the top of your head
-        // and through your neck which represents the y-axis. Rotate the y-axis stick to the right. The x-axis stick
-        // will rotate with your head. Now rotate the x-axis stick to the right. This will make your head tilt down.
-        //
-        // Now let's do the opposite. Rotate the x-axis stick to the right. Your head should tilt down. The y-axis
-        // stick will rotate with your head and should no longer be in the gravitational vertical position. Now rotate
-        // the y-axis stick to the right. Your neck should tilt in an awkward way. The rotation you end up with will
-        // not be the same as the previous exercise.
-        //
-        // As an exercise, switch the order of multiplication in the line below and test how the camera behaves.
-        cameraRotationMatrix = (ry * rx * rz).toRotationMatrix();
-
-        emit cameraRotationChaged(cameraRotation);
+    value.setX(std::fmod(value.x(), static_cast<float>(2 * M_PI)));
+    value.setY(std::fmod(value.y(), static_cast<float>(2 * M_PI)));
+    value.setZ(std::fmod(value.z(), static_cast<float>(2 * M_PI)));
+
+    if (renderParams.cameraRotation != value) {
+        renderParams.cameraRotation = value;
+        emit cameraRotationChaged(renderParams.cameraRotation);
+    }
+}
+
+void FractalWidget::setDeepZoom(bool enable)
+{
+    renderParams.deepZoom = enable;
+
+    // Fold the extra precision back into the camera position since it can no longer be represented
+    if (!enable) {
+        setCameraPosition(renderParams.cameraPosition + renderParams.cameraPositionLow);
+    }
+}
+
+void FractalWidget::setCameraZoom(float value)
+{
+    value = std::clamp(value, 0.0f, CAMERA_ZOOM_MAX);
+
+    if (renderParams.cameraZoom != value) {
+        renderParams.cameraZoom = value;
+        emit cameraZoomChanged(renderParams.cameraZoom);
+    }
+}
+
+void FractalWidget::setCameraAutoSpeed(bool enable)
+{
+    cameraAutoSpeed = enable;
+}
+
+void FractalWidget::setCameraPathClearance(float value)
+{
+    if (value > 0) {
+        cameraPathClearance = value;
+    } else {
+        emit statusChanged("Cannot set camera path clearance to a non-positive value");
+    }
+}
+
+void FractalWidget::setFractalModule(int32_t value)
+{
+    if (value >= 0 && value < FractalModule::getModules().size()) {
+        renderParams.fractalModule = value;
+    } else {
+        emit statusChanged("Cannot set fractal module to an unknown module");
     }
 }
 
 void FractalWidget::setFractalScale(float value)
 {
-    fractalScale = value;
+    renderParams.fractalScale = value;
 }
 
 void FractalWidget::setFractalPosition(QVector3D value)
 {
-    fractalPosition = value;
+    renderParams.fractalPosition = value;
 }
 
 void FractalWidget::setFractalRotation(QVector3D value)
 {
-    fractalRotation = value;
+    renderParams.fractalRotation = value;
 }
 
 void FractalWidget::setFractalExposure(float value)
 {
-    fractalExposure = value;
+    renderParams.fractalExposure = value;
 }
 
 void FractalWidget::setFractalColor(QColor value)
 {
-    fractalColor = QVector3D(value.redF(), value.greenF(), value.blueF());
+    renderParams.fractalColor = QVector3D(value.redF(), value.greenF(), value.blueF());
 }
 
 void FractalWidget::setFractalKeyframe(int32_t value)
@@ -426,20 +433,25 @@ void FractalWidget::setFractalKeyframe(int32_t value)
     emit fractalKeyframeChanged(fractalKeyframeCurrent);
 }
 
+void FractalWidget::setSceneAdaptiveAntiAliasing(bool value)
+{
+    renderParams.sceneAdaptiveAntiAliasing = value;
+}
+
 void FractalWidget::setSceneAmbientOcclusionDelta(float value)
 {
-    sceneAmbientOcclusionDelta = value;
+    renderParams.sceneAmbientOcclusionDelta = value;
 }
 
 void FractalWidget::setSceneAmbientOcclusionStrength(float value)
 {
-    sceneAmbientOcclusionStrength = value;
+    renderParams.sceneAmbientOcclusionStrength = value;
 }
 
 void FractalWidget::setSceneAntiAliasingSamples(float value)
 {
     if (value >= 0) {
-        sceneAntiAliasingSamples = value;
+        renderParams.sceneAntiAliasingSamples = value;
     } else {
         emit statusChanged("Cannot set scene anti-aliasing to a negative value");
     }
@@ -447,62 +459,90 @@ void FractalWidget::setSceneAntiAliasingSamples(float value)
 
 void FractalWidget::setSceneBackgroundColor(QColor value)
 {
-    sceneBackgroundColor = QVector3D(value.redF(), value.greenF(), value.blueF());
+    renderParams.sceneBackgroundColor = QVector3D(value.redF(), value.greenF(), value.blueF());
 }
 
 void FractalWidget::setSceneDiffuseLighting(bool value)
 {
-    sceneDiffuseLighting = value;
+    renderParams.sceneDiffuseLighting = value;
 }
 
 void FractalWidget::setSceneFiltering(bool value)
 {
-    sceneFiltering = value;
+    renderParams.sceneFiltering = value;
 }
 
 void FractalWidget::setSceneFocalDistance(float value)
 {
-    sceneFocalDistance = value;
+    renderParams.sceneFocalDistance = value;
 }
 
 void FractalWidget::setSceneFog(bool value)
 {
-    sceneFog = value;
+    renderParams.sceneFog = value;
+}
+
+void FractalWidget::setSceneLevelOfDetail(float value)
+{
+    if (value >= 0) {
+        renderParams.sceneLevelOfDetail = value;
+    } else {
+        emit statusChanged("Cannot set scene level of detail to a negative value");
+    }
 }
 
 void FractalWidget::setSceneLightColor(QColor value)
 {
-    sceneLightColor = QVector3D(value.redF(), value.greenF(), value.blueF());
+    renderParams.sceneLightColor = QVector3D(value.redF(), value.greenF(), value.blueF());
 }
 
 void FractalWidget::setSceneLightDirection(QVector3D value)
 {
-    sceneLightDirection = value;
+    renderParams.sceneLightDirection = value;
+}
+
+void FractalWidget::setSceneLightingSamples(float value)
+{
+    if (value >= 1) {
+        renderParams.sceneLightingSamples = value;
+    } else {
+        emit statusChanged("Cannot set scene lighting samples to less than one sample");
+    }
+}
+
+void FractalWidget::setSceneSampledLighting(bool value)
+{
+    renderParams.sceneSampledLighting = value;
 }
 
 void FractalWidget::setSceneShadows(bool value)
 {
-    sceneShadows = value;
+    renderParams.sceneShadows = value;
 }
 
 void FractalWidget::setSceneShadowDarkness(float value)
 {
-    sceneShadowDarkness = value;
+    renderParams.sceneShadowDarkness = value;
 }
 
 void FractalWidget::setSceneShadowSharpness(float value)
 {
-    sceneShadowSharpness = value;
+    renderParams.sceneShadowSharpness = value;
 }
 
 void FractalWidget::setSceneSpecularHighlight(float value)
 {
-    sceneSpecularHighlight = value;
+    renderParams.sceneSpecularHighlight = value;
 }
 
 void FractalWidget::setSceneSpecularMultiplier(float value)
 {
-    sceneSpecularMultiplier = value;
+    renderParams.sceneSpecularMultiplier = value;
+}
+
+void FractalWidget::setSceneHeatmap(FractalRenderer::Heatmap value)
+{
+    renderParams.sceneHeatmap = value;
 }
 
 void FractalWidget::setOutputResultion(QVector2D value)
@@ -542,6 +582,53 @@ void FractalWidget::setOutputDirectory(QString value)
     }
 }
 
+void FractalWidget::setOutputFormat(FrameWriter::Format value)
+{
+    outputFormat = value;
+}
+
+void FractalWidget::setOutputMotionBlurSamples(float value)
+{
+    if (value >= 1 && value <= FractalRenderer::MOTION_BLUR_SAMPLES_MAX) {
+        outputMotionBlurSamples = static_cast<int32_t>(value);
+    } else {
+        emit statusChanged(QString("Cannot set motion blur samples outside of [1, %1]")
+            .arg(FractalRenderer::MOTION_BLUR_SAMPLES_MAX));
+    }
+}
+
+void FractalWidget::setOutputShutter(float value)
+{
+    if (value >= 0 && value <= 1) {
+        outputShutter = value;
+    } else {
+        emit statusChanged("Cannot set shutter outside of [0, 1]");
+    }
+}
+
+void FractalWidget::setOutputAdaptiveSpeed(bool value)
+{
+    outputAdaptiveSpeed = value;
+}
+
+void FractalWidget::setOutputRenderPasses(bool value)
+{
+    outputRenderPasses = value;
+}
+
+void FractalWidget::setRenderCacheCapacity(qint64 value)
+{
+    if (value >= 0) {
+        renderCacheCapacity = value;
+
+        if (renderer) {
+            renderer->setCacheCapacity(renderCacheCapacity);
+        }
+    } else {
+        emit statusChanged("Cannot set the render cache capacity to a negative value");
+    }
+}
+
 void FractalWidget::initializeGL()
 {
     initializeOpenGLFunctions();
@@ -549,22 +636,18 @@ void FractalWidget::initializeGL()
     // Set global information
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    // Create shaders
-    fractalOSP.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/vert.glsl");
-    fractalOSP.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/frag.glsl");
-    fractalOSP.link();
-    fractalOSP.bind();
+    blitter.create();
+
+    renderer = std::make_unique<FractalRenderer>(context());
 
-    // Create Vertex Buffer Object (VBO)
-    fractalVBO.create();
-    fractalVBO.bind();
-    fractalVBO.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    connect(renderer.get(), &FractalRenderer::frameReady, this, &FractalWidget::renderNextFrame);
+    connect(renderer.get(), &FractalRenderer::statusChanged, this, &FractalWidget::statusChanged);
 
-    // Create Vertex Array Object (VAO)
-    fractalVAO.create();
+    renderer->setCacheCapacity(renderCacheCapacity);
 
-    fractalVBO.release();
-    fractalOSP.release();
+    renderer->start();
+
+    renderNextFrame();
 }
 
 void FractalWidget::keyPressEvent(QKeyEvent* e)
@@ -605,13 +688,7 @@ void FractalWidget::keyPressEvent(QKeyEvent* e)
 
     case Qt::Key_Backspace:
         if (!animateKeyframesActive && !previewKeyframesActive) {
-            if (!positionWaypoints.isEmpty()) {
-                positionWaypoints.removeLast();
-            }
-
-            if (!positionWaypoints.isEmpty()) {
-                rotationWaypoints.removeLast();
-            }
+            cameraPath.removeLastWaypoint();
         }
         break;
 
@@ -633,6 +710,8 @@ void FractalWidget::keyPressEvent(QKeyEvent* e)
             previewKeyframesActive = false;
             emit previewKeyframesCancelled();
         }
+
+        stopSequence();
         break;
 
     default:
@@ -677,6 +756,15 @@ void FractalWidget::keyReleaseEvent(QKeyEvent* e)
     }
 }
 
+void FractalWidget::wheelEvent(QWheelEvent* e)
+{
+    if (renderParams.deepZoom) {
+        setCameraZoom(renderParams.cameraZoom + e->angleDelta().y() / 120.0f * CAMERA_ZOOM_STEP);
+    } else {
+        QOpenGLWidget::wheelEvent(e);
+    }
+}
+
 void FractalWidget::mousePressEvent(QMouseEvent* e)
 {
     if (e->button() == Qt::LeftButton) {
@@ -689,86 +777,116 @@ void FractalWidget::mousePressEvent(QMouseEvent* e)
     }
 }
 
-void FractalWidget::paintGL()
+void FractalWidget::resizeGL(int w, int h)
 {
-    updatePhysics();
-    updateVisuals();
-
-    glClear(GL_COLOR_BUFFER_BIT);
+    if (renderLoopParked && w > 0 && h > 0) {
+        renderNextFrame();
+    }
+}
 
-    // Render using our shader
-    fractalOSP.bind();
-    fractalVAO.bind();
+void FractalWidget::showEvent(QShowEvent* e)
+{
+    QOpenGLWidget::showEvent(e);
 
-    glDrawArrays(GL_TRIANGLES, 0, 12);
+    if (renderLoopParked && !size().isEmpty()) {
+        renderNextFrame();
+    }
+}
 
-    fractalVAO.release();
-    fractalOSP.release();
+void FractalWidget::paintGL()
+{
+    glClear(GL_COLOR_BUFFER_BIT);
 
-    if (animateKeyframesActive) {
-        resizeGL(outputResolution.x(), outputResolution.y());
+    if (playbackActive) {
+        paintSequence();
 
-        QOpenGLFramebufferObject fractalFBO (outputResolution.x(), outputResolution.y());
+        // Play back at the display refresh rate rather than waiting for the render thread
+        update();
+        return;
+    }
 
-        // Render using our shader
-        fractalOSP.bind();
-        fractalVAO.bind();
-        fractalFBO.bind();
+    auto texture = renderer ? renderer->acquireFrame() : 0;
+    if (texture != 0) {
+        blitter.bind();
+        blitter.blit(texture, QMatrix4x4(), QOpenGLTextureBlitter::OriginBottomLeft);
+        blitter.release();
+    }
+}
 
-        glDrawArrays(GL_TRIANGLES, 0, 12);
+void FractalWidget::paintSequence()
+{
+    const int32_t frameCount = playbackSequence.getFrameCount();
+    const float fps = outputTargetFPS > 0.0f ? outputTargetFPS : FRACTAL_KEYFRAMES_PER_SECOND;
+    const auto frame = static_cast<int32_t>(playbackTimer.nsecsElapsed() / 1e9 * fps) % frameCount;
 
-        QFileInfo frameFile(outputDirectory, QString::number(outputLastDrawnFrame++) + QString(".png"));
-        fractalFBO.toImage().save(frameFile.absoluteFilePath());
+    // Frames are stored just like OpenGL expects them, so they are uploaded straight from the mapping
+    if (frame != playbackFrame) {
+        QOpenGLPixelTransferOptions options;
+        options.setAlignment(4);
 
-        fractalFBO.release();
-        fractalVAO.release();
-        fractalOSP.release();
+        const auto pixels = playbackSequence.getFrame(frame);
+        playbackTexture->setData(QOpenGLTexture::RGB, QOpenGLTexture::UInt8, pixels, &options);
+        playbackFrame = frame;
 
-        resizeGL(width(), height());
+        emit statusChanged(QString("Playing frame sequence: %1 / %2").arg(frame + 1).arg(frameCount));
     }
-}
 
-void FractalWidget::resizeGL(int w, int h)
-{
     const qreal retinaScale = devicePixelRatioF();
-    const qreal retinaW = w * retinaScale;
-    const qreal retinaH = h * retinaScale;
+    const QRect viewport(0, 0, width() * retinaScale, height() * retinaScale);
 
-    glViewport(0, 0, retinaW, retinaH);
+    QSizeF target = playbackSequence.getSize();
+    target.scale(viewport.size(), Qt::KeepAspectRatio);
 
-    fractalOSP.bind();
-    fractalVBO.bind();
-    fractalVAO.bind();
+    const QRectF targetRect(QPointF((viewport.width() - target.width()) / 2, (viewport.height() - target.height()) / 2),
+        target);
 
-    // Create a rectangle using two triangles which covers the entire viewport
-    GLfloat vertices[] =
-    {
-        // 1st triangle
-        static_cast<GLfloat>(-retinaW), static_cast<GLfloat>(+retinaH),
-        static_cast<GLfloat>(+retinaW), static_cast<GLfloat>(+retinaH),
-        static_cast<GLfloat>(+retinaW), static_cast<GLfloat>(-retinaH),
+    blitter.bind();
+    blitter.blit(playbackTexture->textureId(), QOpenGLTextureBlitter::targetTransform(targetRect, viewport),
+        QOpenGLTextureBlitter::OriginBottomLeft);
+    blitter.release();
+}
 
-        // 2nd triangle
-        static_cast<GLfloat>(+retinaW), static_cast<GLfloat>(-retinaH),
-        static_cast<GLfloat>(-retinaW), static_cast<GLfloat>(-retinaH),
-        static_cast<GLfloat>(-retinaW), static_cast<GLfloat>(+retinaH),
-    };
+void FractalWidget::renderNextFrame()
+{
+    if (playbackActive) {
+        return;
+    }
 
-    fractalVBO.allocate(vertices, sizeof(vertices));
+    updatePhysics();
+    updateVisuals();
 
-    fractalOSP.enableAttributeArray(0);
-    fractalOSP.setAttributeBuffer(0, GL_FLOAT, sizeof(GLfloat) * 0, 2, sizeof(GLfloat) * 2);
+    // The render thread skips requests with an empty viewport unless they save a keyframe, see `resizeGL`
+    renderLoopParked = size().isEmpty() && !animateKeyframesActive;
 
-    fractalOSP.setUniformValue("in_resolution", QVector2D(retinaW, retinaH));
+    renderer->requestFrame();
 
-    // Release (unbind) all
-    fractalVAO.release();
-    fractalVBO.release();
-    fractalOSP.release();
+    update();
 }
 
 void FractalWidget::updatePhysics()
 {
+    // Measure the real time which has passed since the last frame. Long frames are clamped so that a stall (e.g. a
+    // window drag or a heavy export frame) does not fast forward the world in one big jump.
+    float frameTime = 0.0f;
+
+    if (simulationTimer.isValid()) {
+        frameTime = std::min(simulationTimer.nsecsElapsed() / 1e9f, SIMULATION_MAX_FRAME_TIME);
+    }
+
+    simulationTimer.start();
+
+    // The camera was moved programatically (e.g. via the spin boxes) since we last rendered so restart the simulation
+    // from the new camera state
+    if (renderParams.cameraPosition != simulationRenderedPosition ||
+        renderParams.cameraPositionLow != simulationRenderedPositionLow ||
+        renderParams.cameraRotation != simulationRenderedRotation) {
+        simulationPrevious.position = renderParams.cameraPosition;
+        simulationPrevious.positionLow = renderParams.cameraPositionLow;
+        simulationPrevious.rotation = renderParams.cameraRotation;
+        simulationCurrent = simulationPrevious;
+        simulationAccumulator = 0.0f;
+    }
+
     // Mouse tracking determines whether the user has clicked on the fractal widget and wants to move and rotate the camera
     if (hasMouseTracking()) {
         float dx = 0.0f;
@@ -798,51 +916,64 @@ void FractalWidget::updatePhysics()
             dy /= mag;
         }
 
-        auto xAxis = QVector3D(cameraRotationMatrix(0, 0), cameraRotationMatrix(1, 0), cameraRotationMatrix(2, 0));
-        auto zAxis = QVector3D(cameraRotationMatrix(0, 2), cameraRotationMatrix(1, 2), cameraRotationMatrix(2, 2));
+        float dz = 0.0f;
 
-        auto newCameraPosition = cameraPosition;
-        newCameraPosition += (xAxis * (dy * +0.01f));
-        newCameraPosition += (zAxis * (dx * -0.01f));
+        if (keyMap[Qt::Key_Q]) {
+            dz += 1.0f;
+        }
 
-        setCameraPosition(newCameraPosition);
+        if (keyMap[Qt::Key_E]) {
+            dz -= 1.0f;
+        }
 
+        // The mouse displacement accumulated over the last frame is converted into an angular velocity which the
+        // simulation smoothly approaches, independent of how long the frame took to render
         auto widgetCenterInGlobalCoords = mapToGlobal({width() / 2, height() / 2});
-        float rx = (widgetCenterInGlobalCoords - QCursor::pos()).x() * 0.005f;
-        float ry = (widgetCenterInGlobalCoords - QCursor::pos()).y() * 0.005f;
+        auto mouseDelta = widgetCenterInGlobalCoords - QCursor::pos();
 
         QCursor::setPos(widgetCenterInGlobalCoords);
 
-        float rz = 0.0f;
-
-        if (keyMap[Qt::Key_Q]) {
-            rz += 0.01f;
+        QVector2D mouseTargetVelocity;
+        if (frameTime > 0.0f) {
+            mouseTargetVelocity = QVector2D(mouseDelta.x(), mouseDelta.y()) * (CAMERA_MOUSE_SENSITIVITY / frameTime);
         }
 
-        if (keyMap[Qt::Key_E]) {
-            rz -= 0.01f;
+        simulationAccumulator += frameTime;
+
+        probeSurface(QVector3D(dx, dy, dz));
+
+        while (simulationAccumulator >= SIMULATION_TIMESTEP) {
+            simulationPrevious = simulationCurrent;
+            stepSimulation(QVector3D(dx, dy, dz), mouseTargetVelocity);
+            simulationAccumulator -= SIMULATION_TIMESTEP;
         }
 
-        auto newCameraRotation = cameraRotation + QVector3D(ry, rx, rz);
+        // Render the camera part way between the last two simulation states so motion stays smooth when the paint rate
+        // and the simulation rate differ. Interpolating from the previous state keeps a resting camera bit-exact.
+        const float alpha = simulationAccumulator / SIMULATION_TIMESTEP;
 
-        // Restrict x-axis rotation to 180 degrees
-        auto x = std::clamp(newCameraRotation.x(), static_cast<float>(-M_PI_2), static_cast<float>(M_PI_2));
-        newCameraRotation.setX(x);
+        auto deltaPosition = (simulationCurrent.position - simulationPrevious.position) +
+                             (simulationCurrent.positionLow - simulationPrevious.positionLow);
+        auto deltaRotation = simulationCurrent.rotation - simulationPrevious.rotation;
 
-        setCameraRotation(newCameraRotation);
-    } else if (animateKeyframesActive || previewKeyframesActive) {
-        float elapsed = (fractalKeyframeCurrent - fractalKeyframeBegin) * (1000.0f / outputTargetFPS);
+        auto position = simulationPrevious.position;
+        auto positionLow = simulationPrevious.positionLow;
 
-        float arclength = s2uTable.last().first;
-        float arclengthPerSecond = arclength / outputTargetDuration;
-        float arclengthPerMillisecond = arclengthPerSecond / 1000.0f;
+        if (renderParams.deepZoom) {
+            addPrecise(position, positionLow, deltaPosition * alpha);
+        } else {
+            position += deltaPosition * alpha;
+        }
 
-        float u = s2u(elapsed * arclengthPerMillisecond);
+        setCameraPositionPrecise(position, positionLow);
+        setCameraRotation(simulationPrevious.rotation + deltaRotation * alpha);
+    } else if (animateKeyframesActive || previewKeyframesActive) {
+        QVector3D interpolatedPosition;
+        QVector3D interpolatedRotation;
 
-        auto interpolatedPosition = interpolatePosition(u, false);
-        setCameraPosition(interpolatedPosition);
+        float elapsed = getKeyframeCamera(fractalKeyframeCurrent, interpolatedPosition, interpolatedRotation);
 
-        auto interpolatedRotation = interpolateRotation(u);
+        setCameraPosition(interpolatedPosition);
         setCameraRotation(interpolatedRotation);
 
         if (elapsed > outputTargetDuration * 1000.0f) {
@@ -861,47 +992,212 @@ void FractalWidget::updatePhysics()
                 .arg(QString::number(outputTargetDuration, 'f', 2));
 
             emit statusChanged(status);
+            emit keyframesProgressChanged(elapsed / 1000.0f, outputTargetDuration);
         }
+    } else {
+        mouseVelocity = QVector2D();
+    }
+
+    simulationRenderedPosition = renderParams.cameraPosition;
+    simulationRenderedPositionLow = renderParams.cameraPositionLow;
+    simulationRenderedRotation = renderParams.cameraRotation;
+
+    // Outside of animations the fractal is animated in real time rather than one keyframe per rendered frame
+    if (!animateKeyframesActive && !previewKeyframesActive) {
+        fractalKeyframeFraction += frameTime * FRACTAL_KEYFRAMES_PER_SECOND;
+
+        auto keyframes = static_cast<int32_t>(fractalKeyframeFraction);
+        if (keyframes > 0) {
+            fractalKeyframeFraction -= keyframes;
+            setFractalKeyframe(fractalKeyframeCurrent + keyframes);
+        }
+    } else {
+        fractalKeyframeFraction = 0.0f;
     }
 }
 
+float FractalWidget::getKeyframeCamera(float keyframe, QVector3D& position, QVector3D& rotation) const
+{
+    float elapsed = (keyframe - fractalKeyframeBegin) * (1000.0f / outputTargetFPS);
+
+    // Sub-frames of the first and last keyframe may fall outside of the animation so hold the camera at either end
+    float u = cameraPath.s2u(cameraPath.t2s(elapsed / (outputTargetDuration * 1000.0f)));
+
+    position = cameraPath.interpolatePosition(u, false);
+    rotation = cameraPath.interpolateRotation(u);
+
+    return elapsed;
+}
+
+void FractalWidget::probeSurface(QVector3D input)
+{
+    // In deep zoom mode the camera slows down with the zoom depth so that it moves at a constant speed relative to
+    // the detail on screen
+    simulationSpeed = CAMERA_TRANSLATION_SPEED * (renderParams.deepZoom ? std::exp2(-renderParams.cameraZoom) : 1.0f);
+    simulationCollision = false;
+
+    // The distance estimate on the CPU is only single precision, which deep zoom mode is well beyond
+    if (!cameraAutoSpeed || renderParams.deepZoom) {
+        return;
+    }
+
+    const PathPlanner planner = getPathPlanner();
+
+    if (!planner.isValid()) {
+        return;
+    }
+
+    const QVector3D position = simulationCurrent.position;
+
+    auto rotationMatrix = CameraPath::getCameraRotationMatrix(simulationCurrent.rotation);
+
+    auto xAxis = QVector3D(rotationMatrix(0, 0), rotationMatrix(1, 0), rotationMatrix(2, 0));
+    auto zAxis = QVector3D(rotationMatrix(0, 2), rotationMatrix(1, 2), rotationMatrix(2, 2));
+
+    const QVector3D direction = (xAxis * input.y() - zAxis * input.x()).normalized();
+
+    // Probe the camera position, then points along the direction of motion spaced by the distance found there, so the
+    // camera slows down ahead of a wall rather than only once it is next to it
+    std::array<QVector3D, CAMERA_PROBE_COUNT + 1> probes;
+    std::array<float, CAMERA_PROBE_COUNT + 1> distances;
+
+    probes[0] = position;
+    planner.evaluate(probes.data(), distances.data(), 1);
+
+    for (int32_t i = 1; i <= CAMERA_PROBE_COUNT; ++i) {
+        probes[i] = position + direction * (std::max(distances[0], 0.0f) * i);
+    }
+
+    planner.evaluate(probes.data() + 1, distances.data() + 1, CAMERA_PROBE_COUNT);
+
+    const float distance = std::max(*std::min_element(distances.begin(), distances.end()), 0.0f);
+
+    simulationSpeed = CAMERA_TRANSLATION_SPEED *
+        std::clamp(distance / CAMERA_AUTO_SPEED_DISTANCE, CAMERA_AUTO_SPEED_MIN, CAMERA_AUTO_SPEED_MAX);
+
+    planner.getNormals(&position, &simulationSurfaceNormal, 1,
+        std::max(distances[0] * 0.5f, CAMERA_COLLISION_DISTANCE));
+
+    simulationApproachRemaining = std::max(distances[0] - CAMERA_COLLISION_DISTANCE, 0.0f);
+    simulationCollision = true;
+}
+
+void FractalWidget::stepSimulation(QVector3D input, QVector2D mouseTargetVelocity)
+{
+    const float dt = SIMULATION_TIMESTEP;
+
+    auto rotationMatrix = CameraPath::getCameraRotationMatrix(simulationCurrent.rotation);
+
+    auto xAxis = QVector3D(rotationMatrix(0, 0), rotationMatrix(1, 0), rotationMatrix(2, 0));
+    auto zAxis = QVector3D(rotationMatrix(0, 2), rotationMatrix(1, 2), rotationMatrix(2, 2));
+
+    auto delta = (xAxis * (input.y() * +simulationSpeed * dt)) + (zAxis * (input.x() * -simulationSpeed * dt));
+
+    if (simulationCollision) {
+        // The distance measured at the start of the frame is how far the camera can approach the fractal without
+        // passing through it, beyond that it slides along the surface
+        const float approach = -QVector3D::dotProduct(delta, simulationSurfaceNormal);
+
+        if (approach > simulationApproachRemaining) {
+            delta += simulationSurfaceNormal * (approach - simulationApproachRemaining);
+        }
+
+        simulationApproachRemaining -= std::clamp(approach, 0.0f, simulationApproachRemaining);
+    }
+
+    // The steps of deep zoom mode quickly become smaller than the float precision of the position so they are
+    // accumulated in double-float precision
+    if (renderParams.deepZoom) {
+        addPrecise(simulationCurrent.position, simulationCurrent.positionLow, delta);
+    } else {
+        simulationCurrent.position += delta;
+    }
+
+    // Exponentially approach the target velocity to smooth out jittery mouse input
+    mouseVelocity += (mouseTargetVelocity - mouseVelocity) * (1.0f - std::exp(-dt / CAMERA_MOUSE_SMOOTHING));
+
+    auto rx = mouseVelocity.x() * dt;
+    auto ry = mouseVelocity.y() * dt;
+    auto rz = input.z() * CAMERA_ROLL_SPEED * dt;
+
+    simulationCurrent.rotation += QVector3D(ry, rx, rz);
+
+    // Restrict x-axis rotation to 180 degrees
+    auto x = std::clamp(simulationCurrent.rotation.x(), static_cast<float>(-M_PI_2), static_cast<float>(M_PI_2));
+    simulationCurrent.rotation.setX(x);
+}
+
 void FractalWidget::updateVisuals()
 {
     // Update animated fractals
-    QVector3D animatedRotation = fractalRotation;
-
-    if (true || animateKeyframesActive || previewKeyframesActive) {
-        animatedRotation.setX(animatedRotation.x() + ANIMATION_SIN_OUTER_FACTOR * std::sin(fractalKeyframeCurrent * ANIMATION_SIN_INNER_FACTOR));
+    float fractalKeyframe = fractalKeyframeCurrent + fractalKeyframeFraction;
+    QVector3D animatedRotation = getAnimatedFractalRotation(renderParams.fractalRotation, fractalKeyframe);
 
+    // Animations advance exactly one keyframe per rendered frame so the output is independent of the render speed
+    if (animateKeyframesActive || previewKeyframesActive) {
         setFractalKeyframe(fractalKeyframeCurrent + 1);
     }
 
-    fractalOSP.bind();
-    fractalOSP.setUniformValue("in_camera_position", cameraPosition);
-    fractalOSP.setUniformValue("in_camera_rotation", cameraRotationMatrix);
-
-    fractalOSP.setUniformValue("in_fractal_scale", fractalScale);
-    fractalOSP.setUniformValue("in_fractal_rotation", animatedRotation);
-    fractalOSP.setUniformValue("in_fractal_shift", fractalPosition);
-    fractalOSP.setUniformValue("in_fractal_exposure", fractalExposure);
-    fractalOSP.setUniformValue("in_fractal_color", fractalColor);
-
-    fractalOSP.setUniformValue("in_scene_ambient_occlusion_delta", sceneAmbientOcclusionDelta);
-    fractalOSP.setUniformValue("in_scene_ambient_occlusion_strength", sceneAmbientOcclusionStrength);
-    fractalOSP.setUniformValue("in_scene_anti_aliasing_samples", sceneAntiAliasingSamples);
-    fractalOSP.setUniformValue("in_scene_background_color", sceneBackgroundColor);
-    fractalOSP.setUniformValue("in_scene_diffuse_lighting", sceneDiffuseLighting);
-    fractalOSP.setUniformValue("in_scene_filtering", sceneFiltering);
-    fractalOSP.setUniformValue("in_scene_focal_distance", sceneFocalDistance);
-    fractalOSP.setUniformValue("in_scene_fog", sceneFog);
-    fractalOSP.setUniformValue("in_scene_light_color", sceneLightColor);
-    fractalOSP.setUniformValue("in_scene_light_direction", sceneLightDirection);
-    fractalOSP.setUniformValue("in_scene_shadows", sceneShadows);
-    fractalOSP.setUniformValue("in_scene_shadow_darkness", sceneShadowDarkness);
-    fractalOSP.setUniformValue("in_scene_shadow_sharpness", sceneShadowSharpness);
-    fractalOSP.setUniformValue("in_scene_specular_highlight", sceneSpecularHighlight);
-    fractalOSP.setUniformValue("in_scene_specular_multiplier", sceneSpecularMultiplier);
-    fractalOSP.release();
+    RenderParams snapshot = renderParams;
+    snapshot.fractalRotation = animatedRotation;
 
-    update();
+    const qreal retinaScale = devicePixelRatioF();
+    snapshot.viewportSize = QSize(width() * retinaScale, height() * retinaScale);
+
+    QString outputFileName;
+    QString renderPassFileName;
+    bool restartSequence = false;
+
+    if (animateKeyframesActive) {
+        // Frame sequences keep every keyframe in a single file which the keyframes are appended to
+        const QString baseName = outputFormat == FrameWriter::Format::Sequence ?
+            OUTPUT_SEQUENCE_NAME : QString::number(outputLastDrawnFrame++);
+        const QString extension = "." + FrameWriter::getFileExtension(outputFormat);
+        QFileInfo frameFile(outputDirectory, baseName + extension);
+
+        snapshot.outputSize = QSize(outputResolution.x(), outputResolution.y());
+        snapshot.outputFormat = static_cast<int32_t>(outputFormat);
+        outputFileName = frameFile.absoluteFilePath();
+
+        restartSequence = outputSequenceRestart;
+        outputSequenceRestart = false;
+
+        // Render passes are saved as images named after the keyframe image, or after the frame sequence and the index
+        // of the keyframe within the animation
+        if (outputRenderPasses) {
+            const int32_t animationFrame = static_cast<int32_t>(fractalKeyframe) - fractalKeyframeBegin;
+            const QString passBaseName = outputFormat == FrameWriter::Format::Sequence ?
+                baseName + "." + QString::number(animationFrame) : baseName;
+            renderPassFileName = QFileInfo(outputDirectory, passBaseName).absoluteFilePath();
+        }
+    }
+
+    int32_t subFrameCount = 0;
+
+    // Motion blur spreads sub-frames evenly over the time the shutter is open, centered on the keyframe
+    if (animateKeyframesActive && outputMotionBlurSamples > 1) {
+        subFrameCount = outputMotionBlurSamples;
+
+        // Every sub-frame traces fewer anti-aliasing rays so a keyframe costs about as much as without motion blur
+        const float subFrameScale = 1.0f / std::sqrt(static_cast<float>(subFrameCount));
+        const float samplesPerSubFrame = snapshot.sceneAntiAliasingSamples * subFrameScale;
+        const float antiAliasingSamples = std::max(1.0f, std::round(samplesPerSubFrame));
+
+        for (int32_t i = 0; i < subFrameCount; ++i) {
+            const float keyframe = fractalKeyframe + ((i + 0.5f) / subFrameCount - 0.5f) * outputShutter;
+
+            auto& subFrame = motionBlurSubFrames[i];
+            subFrame = snapshot;
+
+            getKeyframeCamera(keyframe, subFrame.cameraPosition, subFrame.cameraRotation);
+            subFrame.cameraPositionLow = QVector3D();
+            subFrame.fractalRotation = getAnimatedFractalRotation(renderParams.fractalRotation, keyframe);
+            subFrame.sceneAntiAliasingSamples = antiAliasingSamples;
+        }
+    }
+
+    // All parameter changes since the last frame, no matter how many, are published to the renderer as one snapshot.
+    // Previews are cached so that previewing the same keyframes again only reads them back.
+    renderer->setParameters(snapshot, outputFileName, motionBlurSubFrames.data(), subFrameCount,
+        previewKeyframesActive, renderPassFileName, restartSequence);
 }
@@ -1,18 +1,26 @@
 #ifndef FRACTALWIDGET_H
 #define FRACTALWIDGET_H
 
+#include <array>
+#include <memory>
+
 #include <QBasicTimer>
 #include <QElapsedTimer>
 #include <QMatrix4x4>
-#include <QOpenGLBuffer>
 #include <QOpenGLContext>
-#include <QOpenGLFramebufferObject>
 #include <QOpenGLFunctions>
-#include <QOpenGLShaderProgram>
-#include <QOpenGLVertexArrayObject>
+#include <QOpenGLTexture>
+#include <QOpenGLTextureBlitter>
 #include <QOpenGLWidget>
+#include <QVector2D>
 #include <QWidget>
 
+#include "CameraPath.h"
+#include "FractalRenderer.h"
+#include "FrameSequence.h"
+#include "PathPlanner.h"
+#include "RenderParams.h"
+
 class FractalWidget : public QOpenGLWidget, public QOpenGLFunctions
 {
     Q_OBJECT
@@ -22,20 +30,97 @@ public:
     static constexpr float ANIMATION_SIN_INNER_FACTOR = 0.0003f;
     static constexpr float ANIMATION_SIN_OUTER_FACTOR = 0.3f;
 
+    /// The fixed timestep in seconds at which camera navigation is simulated.
+    static constexpr float SIMULATION_TIMESTEP = 1.0f / 120.0f;
+
+    /// The maximum real time in seconds simulated for a single rendered frame.
+    static constexpr float SIMULATION_MAX_FRAME_TIME = 0.25f;
+
+    /// The camera translation speed in arbitrary units per second.
+    static constexpr float CAMERA_TRANSLATION_SPEED = 0.6f;
+
+    /// The camera roll speed in radians per second.
+    static constexpr float CAMERA_ROLL_SPEED = 0.6f;
+
+    /// The camera rotation in radians per pixel of mouse movement.
+    static constexpr float CAMERA_MOUSE_SENSITIVITY = 0.005f;
+
+    /// The time constant in seconds with which the camera follows mouse movement.
+    static constexpr float CAMERA_MOUSE_SMOOTHING = 0.03f;
+
+    /// The maximum deep zoom depth in powers of two, beyond which even double-float precision breaks down.
+    static constexpr float CAMERA_ZOOM_MAX = 30.0f;
+
+    /// The distance to the fractal at which auto speed moves the camera at `CAMERA_TRANSLATION_SPEED`. The speed is
+    /// proportional to the distance.
+    static constexpr float CAMERA_AUTO_SPEED_DISTANCE = 1.0f;
+
+    /// The minimum camera speed of auto speed as a multiple of `CAMERA_TRANSLATION_SPEED`.
+    static constexpr float CAMERA_AUTO_SPEED_MIN = 0.01f;
+
+    /// The maximum camera speed of auto speed as a multiple of `CAMERA_TRANSLATION_SPEED`.
+    static constexpr float CAMERA_AUTO_SPEED_MAX = 4.0f;
+
+    /// The number of points probed along the direction of motion in addition to the camera position.
+    static constexpr int32_t CAMERA_PROBE_COUNT = 3;
+
+    /// The closest the camera gets to the surface of the fractal when auto speed is enabled.
+    static constexpr float CAMERA_COLLISION_DISTANCE = 0.001f;
+
+    /// The change in deep zoom depth in powers of two per mouse wheel notch.
+    static constexpr float CAMERA_ZOOM_STEP = 0.25f;
+
+    /// The rate at which the fractal animates outside of keyframe animations.
+    static constexpr float FRACTAL_KEYFRAMES_PER_SECOND = 60.0f;
+
+    /// The name of the frame sequence file keyframes are appended to in the output directory, without extension.
+    static constexpr const char* OUTPUT_SEQUENCE_NAME = "keyframes";
+
+    /// The number of waypoints of generated exploratory camera paths.
+    static constexpr int32_t CAMERA_PATH_EXPLORE_WAYPOINTS = 16;
+
 public:
 
     /// \brief
     ///     Create a new unconfigured FractalWidget.
     explicit FractalWidget(QWidget* parent = nullptr);
 
+    ~FractalWidget() override;
+
     /// \brief
     ///     Begins the animation which renders keyframes to the screen using the specified waypoints and outputs the
-    ///     keyframes as a series of PNG images to the configured output directory.
-    void animateKeyframes();
+    ///     keyframes as a series of images in the configured format to the configured output directory.
+    /// \return
+    ///     true if the animation has begun; false if an animation is already active, a frame sequence is being played
+    ///     back or there are too few waypoints.
+    bool animateKeyframes();
 
     /// \brief
     ///     Begins the animation which renders keyframes to the screen using the specified waypoints.
-    void previewKeyframes();
+    /// \return
+    ///     true if the preview has begun; false if an animation is already active, a frame sequence is being played
+    ///     back or there are too few waypoints.
+    bool previewKeyframes();
+
+    /// \brief
+    ///     Plays back a frame sequence in a loop at the animation FPS target instead of drawing the fractal, until
+    ///     playback is stopped. Frames are streamed straight from the memory mapped sequence into a texture.
+    /// \return
+    ///     true if playback has begun; false if an animation is active or the sequence cannot be read.
+    bool playSequence(const QString& fileName);
+
+    /// \brief
+    ///     Stops playing back a frame sequence and resumes drawing the fractal.
+    void stopSequence();
+
+    /// \brief
+    ///     Replaces the recorded waypoints with the specified camera path. If the path has already been compiled the
+    ///     next animation/preview begins without recompiling it.
+    void setCameraPath(const CameraPath& path);
+
+    /// \brief
+    ///     Gets the path through the recorded waypoints.
+    const CameraPath& getCameraPath() const;
 
     /// \brief
     ///     Adds a waypoint using the current camera postion and rotation.
@@ -53,6 +138,24 @@ public:
     ///     Clears all the saved waypoints.
     void clearWayPoints();
 
+    /// \brief
+    ///     Pushes the recorded waypoints out of the fractal until the whole camera path keeps the camera path clearance
+    ///     to the surface. The fractal is checked as it is at the current keyframe.
+    /// \return
+    ///     true if the whole path keeps the clearance; false otherwise.
+    bool enforceCameraPathClearance();
+
+    /// \brief
+    ///     Replaces the recorded waypoints with an exploratory path which starts at the camera and follows the surface
+    ///     of the fractal while keeping the camera path clearance. Every call generates a different path.
+    /// \return
+    ///     true if the path was generated; false otherwise.
+    bool exploreCameraPath();
+
+    /// \brief
+    ///     Gets the fractal rotation including the animation applied at the specified keyframe.
+    static QVector3D getAnimatedFractalRotation(QVector3D rotation, float keyframe);
+
     /// \brief
     ///     Gets the look direction from the camera.
     /// \return
@@ -79,6 +182,26 @@ public:
     ///     A vector representing Euler angles in radians.
     const QVector3D getCameraRotation() const;
 
+    /// \brief
+    ///     Gets the deep zoom depth.
+    /// \return
+    ///     The zoom depth in powers of two.
+    float getCameraZoom() const;
+
+    /// \brief
+    ///     Gets the direction of the scene light source.
+    /// \return
+    ///     A normalized vector pointing towards the light source.
+    const QVector3D getSceneLightDirection() const;
+
+    /// \brief
+    ///     Gets the list of recorded position waypoints.
+    const QList<QVector3D>& getPositionWaypoints() const;
+
+    /// \brief
+    ///     Gets the list of recorded rotation waypoints.
+    const QList<QVector3D>& getRotationWaypoints() const;
+
 signals:
 
     /// \brief
@@ -94,6 +217,10 @@ signals:
     ///     This signal is sent when the cameras rotation is changed either by the user or programatically.
     void cameraRotationChaged(const QVector3D& value);
 
+    /// \brief
+    ///     This signal is sent when the deep zoom depth is changed either by the user or programatically.
+    void cameraZoomChanged(float value);
+
     /// \brief
     ///     This signal is sent when the keyframe value has changed either by the user or programatically.
     void fractalKeyframeChanged(const int32_t& value);
@@ -106,6 +233,14 @@ signals:
     ///     This signal is sent when the animation of the current set of waypoints has finished.
     void animateKeyframesFinished();
 
+    /// \brief
+    ///     This signal is sent for every keyframe rendered while animating or previewing.
+    /// \param elapsed
+    ///     The animation time of the keyframe in seconds.
+    /// \param duration
+    ///     The total duration of the animation in seconds.
+    void keyframesProgressChanged(float elapsed, float duration);
+
     /// \brief
     ///     This signal is sent when the user cancels the current preview.
     void previewKeyframesCancelled();
@@ -124,6 +259,31 @@ public slots:
     ///     Sets the cameras rotation in Euler angles.
     void setCameraRotation(QVector3D rotation);
 
+    /// \brief
+    ///     Sets whether deep zoom mode is enabled. In deep zoom mode the camera position and the rays marched from it
+    ///     are kept in double-float precision, and the camera speed and surface detail scale with the zoom depth.
+    void setDeepZoom(bool enable);
+
+    /// \brief
+    ///     Sets the deep zoom depth in powers of two.
+    void setCameraZoom(float value);
+
+    /// \brief
+    ///     Sets whether the camera speed follows the distance to the fractal and the camera is kept from passing
+    ///     through the surface. Has no effect in deep zoom mode.
+    void setCameraAutoSpeed(bool enable);
+
+    /// \brief
+    ///     Sets the minimum distance to the surface of the fractal kept by camera paths checked or generated against
+    ///     the fractal.
+    void setCameraPathClearance(float value);
+
+    /// \brief
+    ///     Sets the fractal module drawing the fractal.
+    /// \param index
+    ///     The index of the module in the `FractalModule` registry.
+    void setFractalModule(int32_t index);
+
     /// \brief
     ///     Sets the fractal scale in arbitrary units.
     void setFractalScale(float scale);
@@ -148,6 +308,10 @@ public slots:
     ///     Sets the fractal animation keyframe.
     void setFractalKeyframe(int32_t value);
 
+    /// \brief
+    ///     Sets whether anti-aliasing samples are only computed for pixels on edges.
+    void setSceneAdaptiveAntiAliasing(bool value);
+
     /// \brief
     ///     Sets the ambient occlusion delta used for global background shading.
     void setSceneAmbientOcclusionDelta(float value);
@@ -180,6 +344,10 @@ public slots:
     ///     Sets whether scene fog is enabled.
     void setSceneFog(bool value);
 
+    /// \brief
+    ///     Sets the size in pixels of the smallest fractal detail rendered, or 0 to render full detail everywhere.
+    void setSceneLevelOfDetail(float value);
+
     /// \brief
     ///     Sets the colour of the scene light source.
     void setSceneLightColor(QColor value);
@@ -188,6 +356,14 @@ public slots:
     ///     Sets the direction of the scene light source.
     void setSceneLightDirection(QVector3D value);
 
+    /// \brief
+    ///     Sets the number of shadow and ambient occlusion rays sampled per pixel per frame in sampled lighting mode.
+    void setSceneLightingSamples(float value);
+
+    /// \brief
+    ///     Sets whether shadows and ambient occlusion are sampled with rays and accumulated over several frames.
+    void setSceneSampledLighting(bool enable);
+
     /// \brief
     ///     Sets whether the scene shadows are enabled.
     void setSceneShadows(bool enable);
@@ -208,6 +384,11 @@ public slots:
     ///     Sets the scene specular highlight multiplier.
     void setSceneSpecularMultiplier(float value);
 
+    /// \brief
+    ///     Sets the diagnostic heatmap drawn instead of the lit fractal. While a heatmap is drawn the statistics of
+    ///     every frame are summarized in the status bar.
+    void setSceneHeatmap(FractalRenderer::Heatmap value);
+
     /// \brief
     ///     Sets the animation keyframe image output resolution.
     void setOutputResultion(QVector2D value);
@@ -224,10 +405,37 @@ public slots:
     ///     Sets the output directory where keyframe images will be saved.
     void setOutputDirectory(QString value);
 
+    /// \brief
+    ///     Sets the format keyframe images are saved in.
+    void setOutputFormat(FrameWriter::Format value);
+
+    /// \brief
+    ///     Sets the number of sub-frames blended into every keyframe image. A single sample disables motion blur.
+    void setOutputMotionBlurSamples(float value);
+
+    /// \brief
+    ///     Sets the fraction of the time between two keyframes during which the shutter is open.
+    void setOutputShutter(float value);
+
+    /// \brief
+    ///     Sets whether animations move the camera in proportion to its distance to the fractal instead of at a
+    ///     constant speed, slowing down for close-up detail and speeding through empty space.
+    void setOutputAdaptiveSpeed(bool value);
+
+    /// \brief
+    ///     Sets whether every keyframe image is saved along with its render passes, i.e. the distance to the surface,
+    ///     the number of march steps, the shadow factor, the surface normal and the orbit trap colour, for compositing.
+    void setOutputRenderPasses(bool value);
+
+    /// \brief
+    ///     Sets the maximum size in bytes of the render cache keeping frames which were drawn before. A capacity of 0
+    ///     disables the cache.
+    void setRenderCacheCapacity(qint64 value);
+
 protected:
 
     /// \brief
-    ///     Initializes the shaders and creates the vertex buffer objects.
+    ///     Starts the render thread which draws the fractal.
     void initializeGL() override;
 
     /// \brief
@@ -241,49 +449,119 @@ protected:
     ///         - Space: Record waypoint
     ///         - Backspace: Remove last waypoint
     ///         - Delete: Clear waypoints
-    ///         - Escape: Stop animation/preview or stop mouse/keyboard capture
+    ///         - Escape: Stop animation/preview/playback or stop mouse/keyboard capture
     void keyPressEvent(QKeyEvent* e) override;
     void keyReleaseEvent(QKeyEvent* e) override;
 
+    /// \brief
+    ///     Implements zooming in and out in deep zoom mode.
+    void wheelEvent(QWheelEvent* e) override;
+
     /// \brief
     ///     Implements camera orientation in a first person view.
     void mousePressEvent(QMouseEvent* e) override;
 
-    void resizeGL(int w, int h) override;
+    /// \brief
+    ///     Composites the most recent frame completed by the render thread.
     void paintGL() override;
 
-    /// The fractal vertex buffer which is defined by two triangles forming a rectanble the size of our viewport.
-    QOpenGLBuffer fractalVBO;
+    /// \brief
+    ///     Restarts the render loop if it stopped while the viewport was empty.
+    void resizeGL(int w, int h) override;
+    void showEvent(QShowEvent* e) override;
 
-    /// The fractal vertex array object which saves the state of the VBO.
-    QOpenGLVertexArrayObject fractalVAO;
+private slots:
 
-    /// The fractal shader which will draw the fractal to the VBO.
-    QOpenGLShaderProgram fractalOSP;
+    /// \brief
+    ///     Advances the camera and animation state and asks the render thread for the next frame. Called whenever the
+    ///     render thread completes a frame.
+    void renderNextFrame();
 
 private:
 
+    void updatePhysics();
+    void updateVisuals();
+
     /// \brief
-    ///     See https://github.com/fjeremic/fractal-pioneer for an explanation of how interpolation is implemented.
-    QVector3D interpolatePosition(float t, bool takeDerivative);
+    ///     Uploads the frame of the sequence due at the current playback time and composites it, letterboxed to keep
+    ///     its aspect ratio.
+    void paintSequence();
 
     /// \brief
-    ///     See https://github.com/fjeremic/fractal-pioneer for an explanation of how interpolation is implemented.
-    QVector3D interpolateRotation(float t);
+    ///     Sets the cameras position in double-float precision.
+    /// \param position
+    ///     The camera position in arbitrary units.
+    /// \param positionLow
+    ///     The part of the camera position too small to be represented in `position`.
+    void setCameraPositionPrecise(QVector3D position, QVector3D positionLow);
 
     /// \brief
-    ///     See https://github.com/fjeremic/fractal-pioneer for an explanation of how interpolation is implemented.
-    void blend();
+    ///     Evaluates the camera path of the current animation at the specified, possibly fractional, keyframe.
+    /// \return
+    ///     The time in milliseconds since the start of the animation.
+    float getKeyframeCamera(float keyframe, QVector3D& position, QVector3D& rotation) const;
 
     /// \brief
-    ///     See https://github.com/fjeremic/fractal-pioneer for an explanation of how interpolation is implemented.
-    float s2u(float s);
+    ///     Gets a path planner for the fractal as it is at the current keyframe.
+    PathPlanner getPathPlanner() const;
 
-    void updatePhysics();
-    void updateVisuals();
+    /// \brief
+    ///     Compiles the camera path if needed and computes its speed profile if adaptive speed is enabled.
+    void compileCameraPath();
+
+    /// \brief
+    ///     Measures the distance to the fractal at the camera and along its direction of motion once per frame, and
+    ///     derives the camera speed and the collision limits of the timesteps simulated for the frame from it.
+    /// \param input
+    ///     The normalized forward, sideways and roll input from the keyboard.
+    void probeSurface(QVector3D input);
+
+    /// \brief
+    ///     Advances the camera navigation simulation by one fixed timestep.
+    /// \param input
+    ///     The normalized forward, sideways and roll input from the keyboard.
+    /// \param mouseTargetVelocity
+    ///     The angular velocity in radians per second requested by the mouse.
+    void stepSimulation(QVector3D input, QVector2D mouseTargetVelocity);
+
+private:
+
+    /// \brief
+    ///     The state of the camera navigation simulation.
+    struct SimulationState
+    {
+        QVector3D position;
+        QVector3D positionLow;
+        QVector3D rotation;
+    };
 
 private:
 
+    /// Renders the fractal on a dedicated render thread.
+    std::unique_ptr<FractalRenderer> renderer;
+
+    /// Composites the frames completed by the render thread onto the widget.
+    QOpenGLTextureBlitter blitter;
+
+    /// The frame sequence being played back, mapped into memory.
+    FrameSequence playbackSequence;
+
+    /// The texture the current frame of the sequence is uploaded to.
+    std::unique_ptr<QOpenGLTexture> playbackTexture;
+
+    /// Measures the time since playback has begun.
+    QElapsedTimer playbackTimer;
+
+    /// The index of the frame of the sequence currently in `playbackTexture`, or -1 if none.
+    int32_t playbackFrame = -1;
+
+    /// Determines whether we are currently playing back a frame sequence.
+    bool playbackActive = false;
+
+    /// Determines whether the render loop stopped because the viewport was empty and no keyframe was being saved, in
+    /// which case the render thread completes no frame which would ask for the next one.
+    bool renderLoopParked = false;
+
     /// A kep map which determines whether a keyboard key is currently pressed.
     QMap<Qt::Key, bool> keyMap;
 
@@ -299,83 +577,60 @@ private:
     /// The current keyfram being animated/previewed.
     int32_t fractalKeyframeCurrent = 0;
 
-    /// The camera position in arbitary coordinates.
-    QVector3D cameraPosition;
+    /// The fraction of a keyframe elapsed since `fractalKeyframeCurrent` outside of animations.
+    float fractalKeyframeFraction = 0.0f;
 
-    /// The camera rotation in Euler angles.
-    QVector3D cameraRotation;
+    /// Measures the real time between rendered frames.
+    QElapsedTimer simulationTimer;
 
-    /// The camera rotation matrix in 3D space.
-    QMatrix3x3 cameraRotationMatrix;
+    /// The real time in seconds which has not yet been simulated.
+    float simulationAccumulator = 0.0f;
 
-    /// The list of position waypoints recorded by the user.
-    QList<QVector3D> positionWaypoints;
+    /// The simulation state before the last timestep.
+    SimulationState simulationPrevious;
 
-    /// The list of rotation waypoints recorded by the user.
-    QList<QVector3D> rotationWaypoints;
+    /// The simulation state after the last timestep.
+    SimulationState simulationCurrent;
 
-    /// Maps arc length of the spline generated by the waypoints to interpolation parameters at those arc lengths.
-    QVector<QPair<float, float>> s2uTable;
+    /// The camera position last rendered, used to detect programatic camera changes.
+    QVector3D simulationRenderedPosition;
 
-    /// The fractal scale in arbitrary units.
-    float fractalScale = 0.0f;
+    /// The low part of the camera position last rendered, used to detect programatic camera changes.
+    QVector3D simulationRenderedPositionLow;
 
-    /// The fractal position in arbitrary coordinates.
-    QVector3D fractalPosition;
+    /// The camera rotation last rendered, used to detect programatic camera changes.
+    QVector3D simulationRenderedRotation;
 
-    /// The fractal rotation in arbitrary coordinates.
-    QVector3D fractalRotation;
+    /// The camera speed in arbitrary units per second of the timesteps simulated for the current frame.
+    float simulationSpeed = CAMERA_TRANSLATION_SPEED;
 
-    /// The fractal exposure which is the amount of light that reaches the camera.
-    float fractalExposure = 0.0f;
+    /// Determines whether the timesteps simulated for the current frame keep the camera out of the fractal.
+    bool simulationCollision = false;
 
-    /// The fractal colour which will be used for the orbit traps.
-    QVector3D fractalColor;
+    /// The surface normal of the fractal closest to the camera at the start of the current frame.
+    QVector3D simulationSurfaceNormal;
 
-    /// The ambient occlusion delta used for global background shading.
-    float sceneAmbientOcclusionDelta = 0.0f;
+    /// How much closer the camera can still get to the fractal during the current frame.
+    float simulationApproachRemaining = 0.0f;
 
-    /// The ambient occlusion strength used for global background shading.
-    float sceneAmbientOcclusionStrength = 0.0f;
+    /// The smoothed angular velocity of the mouse in radians per second.
+    QVector2D mouseVelocity;
 
-    /// The number of anti-aliasing samples to compute.
-    float sceneAntiAliasingSamples = 0.0f;
+    /// The parameters rendered in the next frame. Setters only update this struct; a snapshot of it is published
+    /// to the renderer once per frame which coalesces any number of changes made in between frames.
+    RenderParams renderParams;
 
-    /// The scene (space) background colour.
-    QVector3D sceneBackgroundColor;
+    /// The path through the waypoints recorded by the user.
+    CameraPath cameraPath;
 
-    /// Determines whether scene diffuse lighting is enabled.
-    bool sceneDiffuseLighting = false;
+    /// Determines whether the camera speed follows the distance to the fractal and the camera is kept out of it.
+    bool cameraAutoSpeed = true;
 
-    /// Determines whether scene filtering is enabled.
-    bool sceneFiltering = false;
+    /// The minimum distance to the surface of the fractal kept by checked and generated camera paths.
+    float cameraPathClearance = 0.02f;
 
-    /// The scene focal distance, which is the angle of view.
-    float sceneFocalDistance = 0.0f;
-
-    /// Determines whether scene fog is enabled.
-    bool sceneFog = false;
-
-    /// The colour of the scene light source in RGB.
-    QVector3D sceneLightColor;
-
-    /// The direction of the scene light source.
-    QVector3D sceneLightDirection;
-
-    /// Determines whether the scene shadows are enabled.
-    bool sceneShadows = false;
-
-    /// The scene shadow darkness in range [0, inf)
-    float sceneShadowDarkness = 0.0f;
-
-    /// The scene shadow sharpness in range [0, inf)
-    float sceneShadowSharpness = 0.0f;
-
-    /// The scene specular highlight amount.
-    float sceneSpecularHighlight = 0.0f;
-
-    /// The scene specular highlight multiplier.
-    float sceneSpecularMultiplier = 0.0f;
+    /// The seed of the next exploratory camera path.
+    uint32_t cameraPathExploreSeed = 1;
 
     /// The animation keyframe image output resolution.
     QVector2D outputResolution;
@@ -389,8 +644,34 @@ private:
     /// The output directory where keyframe images will be saved.
     QString outputDirectory;
 
+    /// The format keyframe images are saved in.
+    FrameWriter::Format outputFormat = FrameWriter::Format::RGB8;
+
+    /// The number of sub-frames blended into every keyframe image.
+    int32_t outputMotionBlurSamples = 1;
+
+    /// The fraction of the time between two keyframes during which the shutter is open.
+    float outputShutter = 0.5f;
+
+    /// Determines whether animations move the camera in proportion to its distance to the fractal.
+    bool outputAdaptiveSpeed = false;
+
+    /// Determines whether keyframe images are saved along with their render passes.
+    bool outputRenderPasses = false;
+
+    /// The maximum size in bytes of the render cache.
+    qint64 renderCacheCapacity = RenderCache::CAPACITY_DEFAULT;
+
+    /// The parameters of the sub-frames blended into the next keyframe image, kept around so that no memory is
+    /// allocated per frame.
+    std::array<RenderParams, FractalRenderer::MOTION_BLUR_SAMPLES_MAX> motionBlurSubFrames;
+
     /// The numbered index of the image that was last saved to the disk.
     int64_t outputLastDrawnFrame = 0;
+
+    /// Determines whether the next keyframe saved to a frame sequence starts the sequence over. Set when an animation
+    /// begins so that animating again replaces the keyframes of the last animation instead of appending to them.
+    bool outputSequenceRestart = false;
 };
 
 #endif // FRACTALWIDGET_H
@@ -0,0 +1,201 @@
+#include "FrameSequence.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+
+std::size_t FrameSequence::getBytesPerLine(int32_t width)
+{
+    // OpenGL packs and unpacks rows on 4 byte boundaries by default
+    return (static_cast<std::size_t>(width) * 3 + 3) & ~static_cast<std::size_t>(3);
+}
+
+FrameSequence::~FrameSequence()
+{
+    close();
+}
+
+bool FrameSequence::open(const QString& fileName, const QSize& frameSize, QString& error, bool truncate)
+{
+    close();
+
+    file.setFileName(fileName);
+
+    const bool exists = !truncate && QFileInfo(fileName).size() > 0;
+
+    if (!file.open(truncate ? QIODevice::ReadWrite | QIODevice::Truncate : QIODevice::ReadWrite)) {
+        error = "Cannot open frame sequence \"" + fileName + "\"";
+        return false;
+    }
+
+    if (exists) {
+        if (!readHeader(error)) {
+            close();
+            return false;
+        }
+
+        if (size != frameSize) {
+            error = QString("Cannot append %1 x %2 frames to frame sequence \"%3\" of %4 x %5 frames")
+                .arg(frameSize.width()).arg(frameSize.height()).arg(fileName).arg(size.width()).arg(size.height());
+            close();
+            return false;
+        }
+    } else {
+        size = frameSize;
+        frameCount = 0;
+
+        if (!writeHeader()) {
+            error = "Cannot write frame sequence \"" + fileName + "\"";
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FrameSequence::append(const unsigned char* data)
+{
+    if (!file.isOpen() || mapping != nullptr) {
+        return false;
+    }
+
+    const qint64 bytes = getFrameBytes();
+
+    if (!file.seek(getFrameOffset(frameCount)) || file.write(reinterpret_cast<const char*>(data), bytes) != bytes) {
+        return false;
+    }
+
+    // The frame only becomes part of the sequence once it has been written completely
+    ++frameCount;
+
+    return writeHeader();
+}
+
+bool FrameSequence::map(const QString& fileName, QString& error)
+{
+    close();
+
+    file.setFileName(fileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = "Cannot open frame sequence \"" + fileName + "\"";
+        return false;
+    }
+
+    if (!readHeader(error)) {
+        close();
+        return false;
+    }
+
+    // A sequence which is still being exported may be ahead of the frames written to the file so far
+    while (frameCount > 0 && getFrameOffset(frameCount - 1) + getFrameBytes() > file.size()) {
+        --frameCount;
+    }
+
+    mapping = file.map(0, file.size());
+
+    if (mapping == nullptr) {
+        error = "Cannot map frame sequence \"" + fileName + "\" into memory";
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void FrameSequence::close()
+{
+    if (mapping != nullptr) {
+        file.unmap(mapping);
+        mapping = nullptr;
+    }
+
+    file.close();
+    file.setFileName(QString());
+
+    size = QSize();
+    frameCount = 0;
+}
+
+QString FrameSequence::getFileName() const
+{
+    return file.fileName();
+}
+
+QSize FrameSequence::getSize() const
+{
+    return size;
+}
+
+int32_t FrameSequence::getFrameCount() const
+{
+    return frameCount;
+}
+
+const unsigned char* FrameSequence::getFrame(int32_t index) const
+{
+    if (mapping == nullptr || index < 0 || index >= frameCount) {
+        return nullptr;
+    }
+
+    return mapping + getFrameOffset(index);
+}
+
+qint64 FrameSequence::getFrameBytes() const
+{
+    return static_cast<qint64>(getBytesPerLine(size.width())) * size.height();
+}
+
+qint64 FrameSequence::getFrameOffset(int32_t index) const
+{
+    const qint64 stride = (getFrameBytes() + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+    return HEADER_SIZE + index * stride;
+}
+
+bool FrameSequence::readHeader(QString& error)
+{
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 width = 0;
+    qint32 height = 0;
+    qint32 count = 0;
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    file.seek(0);
+    stream >> magic >> version >> width >> height >> count;
+
+    if (stream.status() != QDataStream::Ok || magic != FORMAT_MAGIC) {
+        error = "\"" + file.fileName() + "\" is not a frame sequence";
+        return false;
+    }
+
+    if (version != FORMAT_VERSION) {
+        error = QString("Cannot read frame sequence \"%1\" of unsupported version %2")
+            .arg(file.fileName()).arg(version);
+        return false;
+    }
+
+    if (width <= 0 || height <= 0 || count < 0) {
+        error = "Frame sequence \"" + file.fileName() + "\" is corrupt";
+        return false;
+    }
+
+    size = QSize(width, height);
+    frameCount = count;
+
+    return true;
+}
+
+bool FrameSequence::writeHeader()
+{
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    file.seek(0);
+    stream << FORMAT_MAGIC << FORMAT_VERSION << static_cast<qint32>(size.width()) << static_cast<qint32>(size.height());
+    stream << static_cast<qint32>(frameCount);
+
+    return stream.status() == QDataStream::Ok && file.flush();
+}
@@ -0,0 +1,122 @@
+#ifndef FRAMESEQUENCE_H
+#define FRAMESEQUENCE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <QFile>
+#include <QSize>
+#include <QString>
+
+/// \brief
+///     A frame sequence keeps a whole animation in a single file which frames are appended to as they are exported,
+///     and which is memory mapped to play the animation back. The file starts with a fixed size header followed by
+///     uncompressed 8-bit RGB frames. Every frame has the same size, so the frame index is implicit: frame `i` starts
+///     `i` frame strides after the header.
+///
+///     Frames are stored exactly as OpenGL reads them back, i.e. rows bottom-up and padded to 4 bytes, and every frame
+///     starts on a page boundary. Playback therefore uploads frames straight from the mapping into a texture without
+///     decoding, converting or copying them first.
+class FrameSequence
+{
+public:
+
+    /// The magic number identifying a frame sequence file ("FPFS").
+    static constexpr quint32 FORMAT_MAGIC = 0x46504653;
+
+    /// The current version of the frame sequence format. Files with any other version are rejected.
+    static constexpr quint32 FORMAT_VERSION = 1;
+
+    /// The size of the header in bytes, which is also the alignment of every frame.
+    static constexpr qint64 HEADER_SIZE = 4096;
+
+    /// \brief
+    ///     Gets the size in bytes of a row of a frame of the specified width.
+    static std::size_t getBytesPerLine(int32_t width);
+
+public:
+
+    FrameSequence() = default;
+    FrameSequence(const FrameSequence&) = delete;
+    FrameSequence& operator=(const FrameSequence&) = delete;
+
+    ~FrameSequence();
+
+    /// \brief
+    ///     Opens a frame sequence to append frames to, creating it if it does not exist yet.
+    /// \param size
+    ///     The size of the frames appended. Must match the size of the frames already in the sequence.
+    /// \param truncate
+    ///     Determines whether the frames already in the sequence are discarded so that it starts over.
+    /// \return
+    ///     true if the sequence was opened; false otherwise, in which case `error` describes why.
+    bool open(const QString& fileName, const QSize& size, QString& error, bool truncate = false);
+
+    /// \brief
+    ///     Appends a frame to a sequence opened with `open`.
+    /// \param data
+    ///     The frame in the layout it is stored in, i.e. `getBytesPerLine` bytes per row, rows bottom-up.
+    /// \return
+    ///     true if the frame was appended; false otherwise.
+    bool append(const unsigned char* data);
+
+    /// \brief
+    ///     Maps a frame sequence into memory to read its frames.
+    /// \return
+    ///     true if the sequence was mapped; false otherwise, in which case `error` describes why.
+    bool map(const QString& fileName, QString& error);
+
+    /// \brief
+    ///     Closes the sequence, unmapping it if it was mapped.
+    void close();
+
+    /// \brief
+    ///     Gets the file name of the sequence, or an empty string if no sequence is open.
+    QString getFileName() const;
+
+    /// \brief
+    ///     Gets the size of every frame in pixels.
+    QSize getSize() const;
+
+    /// \brief
+    ///     Gets the number of frames in the sequence.
+    int32_t getFrameCount() const;
+
+    /// \brief
+    ///     Gets the pixels of a frame of a mapped sequence, in the layout described by `append`.
+    const unsigned char* getFrame(int32_t index) const;
+
+private:
+
+    /// \brief
+    ///     Gets the size of a frame in bytes, excluding the padding to the next page boundary.
+    qint64 getFrameBytes() const;
+
+    /// \brief
+    ///     Gets the offset of a frame from the start of the file.
+    qint64 getFrameOffset(int32_t index) const;
+
+    /// \brief
+    ///     Reads the header from the start of the file.
+    bool readHeader(QString& error);
+
+    /// \brief
+    ///     Writes the header to the start of the file.
+    bool writeHeader();
+
+private:
+
+    /// The file of the sequence.
+    QFile file;
+
+    /// The whole file if the sequence is mapped; nullptr otherwise.
+    uchar* mapping = nullptr;
+
+    /// The size of every frame in pixels.
+    QSize size;
+
+    /// The number of frames in the sequence.
+    int32_t frameCount = 0;
+};
+
+#endif // FRAMESEQUENCE_H
@@ -0,0 +1,251 @@
+#include "FrameWriter.h"
+
+#include <algorithm>
+
+#include <QFile>
+#include <QImage>
+#include <QOpenGLFunctions>
+#include <QSysInfo>
+
+QString FrameWriter::getFormatName(Format format)
+{
+    switch (format) {
+        case Format::RGB8:
+            return "png8";
+
+        case Format::RGB16:
+            return "png16";
+
+        case Format::Float:
+            return "pfm";
+
+        case Format::Sequence:
+            return "fpseq";
+    }
+
+    return QString();
+}
+
+bool FrameWriter::findFormat(const QString& name, Format& format)
+{
+    for (auto candidate : { Format::RGB8, Format::RGB16, Format::Float, Format::Sequence }) {
+        if (getFormatName(candidate) == name) {
+            format = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QString FrameWriter::getFileExtension(Format format)
+{
+    switch (format) {
+        case Format::RGB8:
+        case Format::RGB16:
+            return "png";
+
+        case Format::Float:
+            return "pfm";
+
+        case Format::Sequence:
+            return "fpseq";
+    }
+
+    return QString();
+}
+
+FrameWriter::FrameWriter(QObject* parent) :
+    QObject(parent),
+    thread(&FrameWriter::run, this)
+{
+}
+
+FrameWriter::~FrameWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    changed.notify_all();
+    thread.join();
+}
+
+void FrameWriter::write(QOpenGLFunctions* gl, const QSize& size, Format format, const QString& fileName,
+    int32_t channel, bool restartSequence)
+{
+    GLenum glFormat = GL_RGB;
+    GLenum glType = GL_UNSIGNED_BYTE;
+    std::size_t bytesPerPixel = 3;
+    int32_t channels = 3;
+
+    switch (format) {
+        case Format::RGB8:
+        case Format::Sequence:
+            break;
+
+        case Format::RGB16:
+            // Qt has no 16-bit image format without alpha, so read back an opaque alpha channel along with RGB
+            glFormat = GL_RGBA;
+            glType = GL_UNSIGNED_SHORT;
+            bytesPerPixel = 8;
+            break;
+
+        case Format::Float:
+            glType = GL_FLOAT;
+            bytesPerPixel = 12;
+
+            if (channel >= 0) {
+                // GL_RED, GL_GREEN and GL_BLUE are consecutive
+                glFormat = static_cast<GLenum>(GL_RED + std::min(channel, 2));
+                bytesPerPixel = 4;
+                channels = 1;
+            }
+            break;
+    }
+
+    // Images require every row to start on a 4 byte boundary
+    const std::size_t bytesPerLine = (size.width() * bytesPerPixel + 3) & ~static_cast<std::size_t>(3);
+
+    Frame frame;
+    acquire(frame, bytesPerLine * size.height());
+
+    frame.size = size;
+    frame.format = format;
+    frame.channels = channels;
+    frame.bytesPerLine = bytesPerLine;
+    frame.fileName = fileName;
+    frame.restartSequence = restartSequence;
+
+    gl->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    gl->glReadPixels(0, 0, size.width(), size.height(), glFormat, glType, frame.buffer.get());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(frame));
+    }
+
+    changed.notify_all();
+}
+
+void FrameWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() { return queue.empty() && !saving; });
+}
+
+void FrameWriter::acquire(Frame& frame, std::size_t bytes)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&]() { return !pool.empty() || bufferCount < BUFFER_COUNT; });
+
+        if (!pool.empty()) {
+            frame = std::move(pool.back());
+            pool.pop_back();
+        } else {
+            ++bufferCount;
+        }
+    }
+
+    // Buffers only grow, so they are only ever reallocated when the output resolution increases
+    if (frame.capacity < bytes) {
+        frame.buffer.reset(static_cast<unsigned char*>(::operator new[](bytes, std::align_val_t(ALIGNMENT))));
+        frame.capacity = bytes;
+    }
+}
+
+void FrameWriter::run()
+{
+    for (;;) {
+        Frame frame;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return stopping || !queue.empty(); });
+
+            if (queue.empty()) {
+                return;
+            }
+
+            frame = std::move(queue.front());
+            queue.pop_front();
+            saving = true;
+        }
+
+        QString error;
+        if (!save(frame, error)) {
+            emit statusChanged(error.isEmpty() ? "Cannot save keyframe \"" + frame.fileName + "\"" : error);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            saving = false;
+            pool.push_back(std::move(frame));
+        }
+
+        changed.notify_all();
+    }
+}
+
+bool FrameWriter::save(Frame& frame, QString& error)
+{
+    const int32_t width = frame.size.width();
+    const int32_t height = frame.size.height();
+    unsigned char* data = frame.buffer.get();
+
+    if (frame.format == Format::Sequence) {
+        // Sequences store rows bottom-up just like OpenGL so playback can upload them as they are
+        if (frame.restartSequence || sequence.getFileName() != frame.fileName || sequence.getSize() != frame.size) {
+            if (!sequence.open(frame.fileName, frame.size, error, frame.restartSequence)) {
+                return false;
+            }
+        }
+
+        return sequence.append(data);
+    }
+
+    if (frame.format == Format::Float) {
+        QFile file(frame.fileName);
+
+        if (!file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+
+        // PFM stores rows bottom-up just like OpenGL, and the sign of the scale gives the byte order of the floats
+        const char* identifier = frame.channels == 1 ? "Pf" : "PF";
+        const char* scale = QSysInfo::ByteOrder == QSysInfo::LittleEndian ? "-1.0" : "1.0";
+        file.write(QString("%1\n%2 %3\n%4\n").arg(identifier).arg(width).arg(height).arg(scale).toLatin1());
+
+        const qint64 lineBytes = static_cast<qint64>(width) * frame.channels * sizeof(float);
+
+        for (int32_t y = 0; y < height; ++y) {
+            const char* line = reinterpret_cast<const char*>(data + y * frame.bytesPerLine);
+
+            if (file.write(line, lineBytes) != lineBytes) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    flip(data, frame.bytesPerLine, height);
+
+    // The image only wraps the buffer, which stays owned by the frame
+    const auto format = frame.format == Format::RGB16 ? QImage::Format_RGBX64 : QImage::Format_RGB888;
+    const QImage image(data, width, height, static_cast<int32_t>(frame.bytesPerLine), format);
+
+    return image.save(frame.fileName);
+}
+
+void FrameWriter::flip(unsigned char* data, std::size_t bytesPerLine, int32_t height)
+{
+    for (int32_t y = 0; y < height / 2; ++y) {
+        unsigned char* top = data + y * bytesPerLine;
+        unsigned char* bottom = data + (height - 1 - y) * bytesPerLine;
+
+        std::swap_ranges(top, top + bytesPerLine, bottom);
+    }
+}
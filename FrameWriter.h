@@ -0,0 +1,181 @@
+#ifndef FRAMEWRITER_H
+#define FRAMEWRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QSize>
+#include <QString>
+
+#include "FrameSequence.h"
+
+class QOpenGLFunctions;
+
+/// \brief
+///     The frame writer saves rendered frames to disk on a dedicated writer thread. Frames are read back from the
+///     framebuffer straight into a small pool of aligned buffers in the layout the encoder consumes, so no image is
+///     allocated, converted or copied per frame. Buffers return to the pool once their frame has been encoded, and
+///     reading back a frame waits for a free buffer if the writer falls behind, which bounds the memory in flight.
+class FrameWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /// \brief
+    ///     The pixel layout frames are read back in and encoded from.
+    enum class Format
+    {
+        /// 8-bit RGB, encoded as PNG.
+        RGB8,
+
+        /// 16-bit RGB with an opaque alpha channel, encoded as 16-bit PNG.
+        RGB16,
+
+        /// 32-bit floating point RGB, encoded as PFM.
+        Float,
+
+        /// 8-bit RGB, appended to a frame sequence.
+        Sequence,
+    };
+
+    /// \brief
+    ///     Gets the name of the format used to refer to it in scene files.
+    static QString getFormatName(Format format);
+
+    /// \brief
+    ///     Finds the format with the specified name.
+    /// \return
+    ///     true if there is such a format; false otherwise.
+    static bool findFormat(const QString& name, Format& format);
+
+    /// \brief
+    ///     Gets the extension of the files frames in the specified format are saved to, without the leading dot.
+    static QString getFileExtension(Format format);
+
+    /// The number of buffers in the pool, which is the maximum number of frames read back but not yet saved.
+    static constexpr int32_t BUFFER_COUNT = 3;
+
+    /// The alignment in bytes of every buffer.
+    static constexpr std::size_t ALIGNMENT = 64;
+
+public:
+
+    explicit FrameWriter(QObject* parent = nullptr);
+
+    /// \brief
+    ///     Saves all pending frames and stops the writer thread.
+    ~FrameWriter() override;
+
+    /// \brief
+    ///     Reads back the currently bound framebuffer and queues it to be saved to the specified file. Must be called
+    ///     with an OpenGL context current.
+    /// \param channel
+    ///     The channel read back as a greyscale image, where 0 is red, or -1 to read back RGB. Only supported by
+    ///     `Format::Float`, which saves greyscale images as single channel PFM.
+    /// \param restartSequence
+    ///     Determines whether the frame sequence is started over with this frame instead of the frame being appended
+    ///     to the frames already in it. Only used by `Format::Sequence`.
+    void write(QOpenGLFunctions* gl, const QSize& size, Format format, const QString& fileName, int32_t channel = -1,
+        bool restartSequence = false);
+
+    /// \brief
+    ///     Waits until all queued frames have been saved.
+    void flush();
+
+signals:
+
+    /// \brief
+    ///     This signal is sent from the writer thread when a frame cannot be saved.
+    void statusChanged(const QString& message);
+
+private:
+
+    /// \brief
+    ///     Frees buffers allocated with the pool alignment.
+    struct AlignedDelete
+    {
+        void operator()(unsigned char* data) const
+        {
+            ::operator delete[](data, std::align_val_t(ALIGNMENT));
+        }
+    };
+
+    using Buffer = std::unique_ptr<unsigned char[], AlignedDelete>;
+
+    /// \brief
+    ///     A frame read back but not yet saved.
+    struct Frame
+    {
+        Buffer buffer;
+        std::size_t capacity = 0;
+        QSize size;
+        Format format = Format::RGB8;
+        int32_t channels = 3;
+        std::size_t bytesPerLine = 0;
+        QString fileName;
+        bool restartSequence = false;
+    };
+
+private:
+
+    /// \brief
+    ///     Takes a buffer of at least the specified size from the pool, waiting for one to be returned if all of them
+    ///     are in flight.
+    void acquire(Frame& frame, std::size_t bytes);
+
+    /// \brief
+    ///     Saves queued frames until the writer is destroyed. Runs on the writer thread.
+    void run();
+
+    /// \brief
+    ///     Encodes the frame to its file. Runs on the writer thread.
+    /// \param error
+    ///     Receives why the frame was not saved, if there is more to say than that it could not be saved.
+    /// \return
+    ///     true if the frame was saved; false otherwise.
+    bool save(Frame& frame, QString& error);
+
+    /// \brief
+    ///     Flips the rows of an image in place, turning the bottom-up rows read back from OpenGL into top-down rows.
+    static void flip(unsigned char* data, std::size_t bytesPerLine, int32_t height);
+
+private:
+
+    /// Guards every member below.
+    std::mutex mutex;
+
+    /// Signalled when a frame is queued, a buffer is returned to the pool, or the writer is stopping.
+    std::condition_variable changed;
+
+    /// Buffers not currently holding a frame.
+    std::vector<Frame> pool;
+
+    /// The number of buffers allocated, in the pool or in flight.
+    int32_t bufferCount = 0;
+
+    /// Frames waiting to be saved, oldest first.
+    std::deque<Frame> queue;
+
+    /// Determines whether the writer thread is saving a frame taken off the queue.
+    bool saving = false;
+
+    /// Determines whether the writer thread should exit once the queue is empty.
+    bool stopping = false;
+
+    /// The frame sequence frames were last appended to, kept open between frames. Only used by the writer thread.
+    FrameSequence sequence;
+
+    /// The thread saving frames.
+    std::thread thread;
+};
+
+#endif // FRAMEWRITER_H
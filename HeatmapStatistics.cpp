@@ -0,0 +1,84 @@
+#include "HeatmapStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QJsonArray>
+
+int32_t HeatmapStatistics::getBin(float steps)
+{
+    const float x = std::log2(1.0f + std::max(steps, 0.0f)) / std::log2(1.0f + STEPS_MAX);
+    return std::min(static_cast<int32_t>(x * BIN_COUNT), BIN_COUNT - 1);
+}
+
+float HeatmapStatistics::getBinStart(int32_t bin)
+{
+    return std::exp2(std::log2(1.0f + STEPS_MAX) * bin / BIN_COUNT) - 1.0f;
+}
+
+float HeatmapStatistics::getPercentile(const std::array<double, BIN_COUNT>& histogram, double fraction)
+{
+    double total = 0.0;
+
+    for (double count : histogram) {
+        total += count;
+    }
+
+    double sum = 0.0;
+
+    for (int32_t bin = 0; bin < BIN_COUNT; ++bin) {
+        sum += histogram[bin];
+
+        if (sum >= total * fraction) {
+            return getBinStart(bin + 1);
+        }
+    }
+
+    return STEPS_MAX;
+}
+
+QString HeatmapStatistics::getSummary() const
+{
+    if (!(samples > 0.0)) {
+        return "Heatmap: no samples were traced";
+    }
+
+    return QString("Heatmap: %1 march steps and %2 shadow steps per sample, %3% hits, 95% of pixels below %4 march "
+                   "steps, %5 samples per pixel")
+        .arg(marchSteps / samples, 0, 'f', 1)
+        .arg(shadowSteps / samples, 0, 'f', 1)
+        .arg(100.0 * hits / samples, 0, 'f', 1)
+        .arg(getPercentile(marchStepHistogram, 0.95), 0, 'f', 0)
+        .arg(samples / std::max(pixels, 1.0), 0, 'f', 2);
+}
+
+QJsonObject HeatmapStatistics::toJson() const
+{
+    QJsonArray binStarts;
+    QJsonArray marchStepPixels;
+    QJsonArray shadowStepPixels;
+
+    for (int32_t bin = 0; bin < BIN_COUNT; ++bin) {
+        binStarts.append(getBinStart(bin));
+        marchStepPixels.append(marchStepHistogram[bin]);
+        shadowStepPixels.append(shadowStepHistogram[bin]);
+    }
+
+    const double sampleCount = std::max(samples, 1.0);
+
+    QJsonObject result;
+    result["pixels"] = pixels;
+    result["samples"] = samples;
+    result["hitRatio"] = hits / sampleCount;
+    result["marchStepsPerSample"] = marchSteps / sampleCount;
+    result["shadowStepsPerSample"] = shadowSteps / sampleCount;
+    result["marchStepsMedian"] = getPercentile(marchStepHistogram, 0.5);
+    result["marchStepsPercentile95"] = getPercentile(marchStepHistogram, 0.95);
+    result["shadowStepsMedian"] = getPercentile(shadowStepHistogram, 0.5);
+    result["shadowStepsPercentile95"] = getPercentile(shadowStepHistogram, 0.95);
+    result["binStarts"] = binStarts;
+    result["marchStepHistogram"] = marchStepPixels;
+    result["shadowStepHistogram"] = shadowStepPixels;
+
+    return result;
+}
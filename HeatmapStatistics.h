@@ -0,0 +1,67 @@
+#ifndef HEATMAPSTATISTICS_H
+#define HEATMAPSTATISTICS_H
+
+#include <array>
+#include <cstdint>
+
+#include <QJsonObject>
+#include <QString>
+
+/// \brief
+///     The statistics of a frame drawn in heatmap mode, which tell where the time drawing the frame goes. The march
+///     steps of every pixel are summed up over all of its samples and divided by the number of samples, and the pixels
+///     are counted in a histogram of logarithmically sized bins, the same way the heatmap colours them. Shadow steps
+///     count the march steps of the shadow ray, or of all shadow and ambient occlusion rays in sampled lighting mode.
+struct HeatmapStatistics
+{
+    /// The number of bins of the histograms.
+    static constexpr int32_t BIN_COUNT = 32;
+
+    /// The maximum number of march steps of a ray, where the last bin ends. Matches MAX_MARCHES in frag.glsl.
+    static constexpr float STEPS_MAX = 1000.0f;
+
+    /// \brief
+    ///     Gets the bin of the specified number of march steps per sample. Matches `getBin` in histogram.glsl.
+    static int32_t getBin(float steps);
+
+    /// \brief
+    ///     Gets the smallest number of march steps per sample which falls into the specified bin. The bin after the
+    ///     last one starts at `STEPS_MAX`.
+    static float getBinStart(int32_t bin);
+
+    /// \brief
+    ///     Gets the number of march steps per sample below which the specified fraction of the pixels lies, rounded up
+    ///     to the end of the bin it falls into.
+    static float getPercentile(const std::array<double, BIN_COUNT>& histogram, double fraction);
+
+    /// \brief
+    ///     Gets a one line summary of the statistics for the status bar.
+    QString getSummary() const;
+
+    /// \brief
+    ///     Gets the statistics and the histograms as a JSON object for the benchmark report.
+    QJsonObject toJson() const;
+
+    /// The number of pixels whose march steps per sample fall into every bin.
+    std::array<double, BIN_COUNT> marchStepHistogram = {};
+
+    /// The number of pixels whose shadow steps per sample fall into every bin.
+    std::array<double, BIN_COUNT> shadowStepHistogram = {};
+
+    /// The total number of march steps of all samples.
+    double marchSteps = 0.0;
+
+    /// The total number of shadow steps of all samples.
+    double shadowSteps = 0.0;
+
+    /// The number of samples traced, which is larger than the number of pixels with anti-aliasing.
+    double samples = 0.0;
+
+    /// The number of samples which hit the fractal.
+    double hits = 0.0;
+
+    /// The number of pixels of the frame.
+    double pixels = 0.0;
+};
+
+#endif // HEATMAPSTATISTICS_H
@@ -0,0 +1,297 @@
+#include "PathPlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QMatrix3x3>
+#include <QQuaternion>
+
+PathPlanner::PathPlanner(const RenderParams& params) :
+    params(params)
+{
+    const auto& modules = FractalModule::getModules();
+
+    if (params.fractalModule >= 0 && params.fractalModule < modules.size()) {
+        distanceEstimate = modules[params.fractalModule].distanceEstimate;
+    }
+}
+
+bool PathPlanner::isValid() const
+{
+    return distanceEstimate != nullptr;
+}
+
+void PathPlanner::evaluate(const QVector3D* points, float* distances, int32_t count) const
+{
+    const int32_t hardwareThreads = static_cast<int32_t>(std::max(std::thread::hardware_concurrency(), 1u));
+    const int32_t threadCount = std::clamp(count / EVALUATIONS_PER_THREAD_MIN, 1, hardwareThreads);
+
+    // Every thread evaluates a contiguous chunk of the batch, the first one on the calling thread
+    const auto evaluateChunk = [&](int32_t chunk)
+    {
+        const int32_t begin = static_cast<int32_t>(static_cast<int64_t>(count) * chunk / threadCount);
+        const int32_t end = static_cast<int32_t>(static_cast<int64_t>(count) * (chunk + 1) / threadCount);
+
+        for (int32_t i = begin; i < end; ++i) {
+            distances[i] = distanceEstimate(points[i], params);
+        }
+    };
+
+    std::vector<std::future<void>> futures;
+
+    for (int32_t chunk = 1; chunk < threadCount; ++chunk) {
+        futures.push_back(std::async(std::launch::async, evaluateChunk, chunk));
+    }
+
+    evaluateChunk(0);
+
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+void PathPlanner::getNormals(const QVector3D* points, QVector3D* normals, int32_t count, float delta) const
+{
+    const QVector3D axes[3] = { { delta, 0.0f, 0.0f }, { 0.0f, delta, 0.0f }, { 0.0f, 0.0f, delta } };
+
+    // The six differences of every point are laid out next to each other so they end up on the same thread
+    std::vector<QVector3D> offsets(count * 6);
+    std::vector<float> distances(count * 6);
+
+    for (int32_t i = 0; i < count; ++i) {
+        for (int32_t axis = 0; axis < 3; ++axis) {
+            offsets[i * 6 + axis * 2 + 0] = points[i] + axes[axis];
+            offsets[i * 6 + axis * 2 + 1] = points[i] - axes[axis];
+        }
+    }
+
+    evaluate(offsets.data(), distances.data(), count * 6);
+
+    for (int32_t i = 0; i < count; ++i) {
+        const float* d = distances.data() + i * 6;
+        normals[i] = QVector3D(d[0] - d[1], d[2] - d[3], d[4] - d[5]).normalized();
+    }
+}
+
+int32_t PathPlanner::enforceClearance(CameraPath& path, float clearance) const
+{
+    if (path.size() < 2) {
+        return 0;
+    }
+
+    const int32_t segmentCount = path.size() - 1;
+    const int32_t sampleCount = segmentCount * SAMPLES_PER_SEGMENT + 1;
+
+    std::vector<QVector3D> samples(sampleCount);
+    std::vector<float> distances(sampleCount);
+
+    std::vector<int32_t> violations;
+    std::vector<QVector3D> violationPoints;
+    std::vector<QVector3D> normals;
+
+    std::vector<QVector3D> pushes(path.size());
+    std::vector<float> weights(path.size());
+
+    for (int32_t iteration = 0; ; ++iteration) {
+        for (int32_t k = 0; k < sampleCount; ++k) {
+            samples[k] = path.interpolatePosition(static_cast<float>(k) / SAMPLES_PER_SEGMENT, false);
+        }
+
+        evaluate(samples.data(), distances.data(), sampleCount);
+
+        violations.clear();
+
+        for (int32_t k = 0; k < sampleCount; ++k) {
+            if (distances[k] < clearance) {
+                violations.push_back(k);
+            }
+        }
+
+        if (violations.empty() || iteration == CLEARANCE_ITERATIONS_MAX) {
+            break;
+        }
+
+        violationPoints.resize(violations.size());
+        normals.resize(violations.size());
+
+        for (std::size_t j = 0; j < violations.size(); ++j) {
+            violationPoints[j] = samples[violations[j]];
+        }
+
+        getNormals(violationPoints.data(), normals.data(), static_cast<int32_t>(violations.size()), clearance * 0.5f);
+
+        std::fill(pushes.begin(), pushes.end(), QVector3D());
+        std::fill(weights.begin(), weights.end(), 0.0f);
+
+        // Every sample mostly depends on the two waypoints of its segment, so it pushes both of them in proportion to
+        // how close it is to either. Each waypoint moves by the weighted average of the pushes it received.
+        for (std::size_t j = 0; j < violations.size(); ++j) {
+            const int32_t k = violations[j];
+            const int32_t segment = std::min(k / SAMPLES_PER_SEGMENT, segmentCount - 1);
+            const float h = static_cast<float>(k - segment * SAMPLES_PER_SEGMENT) / SAMPLES_PER_SEGMENT;
+
+            const QVector3D push = normals[j] * (clearance - distances[k]);
+
+            pushes[segment] += push * (1.0f - h);
+            weights[segment] += 1.0f - h;
+
+            pushes[segment + 1] += push * h;
+            weights[segment + 1] += h;
+        }
+
+        for (int32_t i = 0; i < path.size(); ++i) {
+            if (weights[i] > 0.0f) {
+                path.setPositionWaypoint(i, path.getPositionWaypoints()[i] + pushes[i] / weights[i]);
+            }
+        }
+    }
+
+    if (!path.isCompiled()) {
+        path.compile();
+    }
+
+    return static_cast<int32_t>(violations.size());
+}
+
+void PathPlanner::compileSpeedProfile(CameraPath& path) const
+{
+    if (!path.isCompiled()) {
+        path.compile();
+    }
+
+    const float arcLength = path.getArcLength();
+    const int32_t sampleCount = (path.size() - 1) * SAMPLES_PER_SEGMENT + 1;
+
+    if (!(arcLength > 0.0f) || sampleCount < 2) {
+        path.setSpeedProfile({});
+        return;
+    }
+
+    const float ds = arcLength / (sampleCount - 1);
+
+    std::vector<QVector3D> samples(sampleCount);
+    std::vector<float> speeds(sampleCount);
+
+    for (int32_t k = 0; k < sampleCount; ++k) {
+        samples[k] = path.interpolatePosition(path.s2u(k * ds), false);
+    }
+
+    evaluate(samples.data(), speeds.data(), sampleCount);
+
+    const float speedMax = *std::max_element(speeds.begin(), speeds.end());
+
+    if (!(speedMax > 0.0f)) {
+        path.setSpeedProfile({});
+        return;
+    }
+
+    // The camera neither stops at the surface nor races through empty space
+    for (auto& speed : speeds) {
+        speed = std::clamp(speed, speedMax / SPEED_RANGE, speedMax);
+    }
+
+    // Limiting the speed from both sides only ever lowers it, so the camera brakes ahead of detail instead of
+    // running into it
+    const float speedChange = SPEED_CHANGE_MAX * ds;
+
+    for (int32_t k = 1; k < sampleCount; ++k) {
+        speeds[k] = std::min(speeds[k], speeds[k - 1] + speedChange);
+    }
+
+    for (int32_t k = sampleCount - 2; k >= 0; --k) {
+        speeds[k] = std::min(speeds[k], speeds[k + 1] + speedChange);
+    }
+
+    std::vector<double> times(sampleCount, 0.0);
+
+    for (int32_t k = 1; k < sampleCount; ++k) {
+        times[k] = times[k - 1] + 2.0 * ds / (speeds[k - 1] + speeds[k]);
+    }
+
+    // Both times and arc lengths increase along the samples, so the arc lengths at even times are found in a single
+    // pass over both
+    QVector<float> table(sampleCount);
+    int32_t k = 0;
+
+    for (int32_t j = 0; j < sampleCount; ++j) {
+        const double time = times.back() * j / (sampleCount - 1);
+
+        while (k < sampleCount - 2 && times[k + 1] < time) {
+            ++k;
+        }
+
+        const double a = std::clamp((time - times[k]) / (times[k + 1] - times[k]), 0.0, 1.0);
+        table[j] = static_cast<float>((k + a) * ds);
+    }
+
+    table.last() = arcLength;
+
+    path.setSpeedProfile(std::move(table));
+}
+
+CameraPath PathPlanner::explore(QVector3D position, QVector3D rotation, int32_t waypointCount, float clearance,
+    uint32_t seed) const
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> wander(-EXPLORE_WANDER_DEGREES, EXPLORE_WANDER_DEGREES);
+
+    const float distance = clearance * EXPLORE_DISTANCE_FACTOR;
+
+    CameraPath path;
+    path.addWaypoint(position, rotation);
+
+    QVector3D direction = getDirectionFromRotation(rotation);
+
+    for (int32_t i = 1; i < waypointCount; ++i) {
+        for (int32_t step = 0; step < EXPLORE_STEPS_PER_WAYPOINT; ++step) {
+            float d = 0.0f;
+            QVector3D normal;
+
+            evaluate(&position, &d, 1);
+            getNormals(&position, &normal, 1, distance * 0.5f);
+
+            // Travel along the surface by projecting the direction onto the tangent plane, picking any tangent if the
+            // camera heads straight into or away from the surface
+            QVector3D tangent = direction - normal * QVector3D::dotProduct(direction, normal);
+
+            if (tangent.lengthSquared() < 1e-6f) {
+                tangent = QVector3D::crossProduct(normal, std::abs(normal.y()) < 0.9f ?
+                    QVector3D(0.0f, 1.0f, 0.0f) : QVector3D(1.0f, 0.0f, 0.0f));
+            }
+
+            direction = QQuaternion::fromAxisAndAngle(normal, wander(random)).rotatedVector(tangent).normalized();
+
+            // Approach the followed distance gradually so that a camera far from the surface does not jump to it
+            position += direction * distance + normal * std::clamp(distance - d, -distance, distance);
+        }
+
+        path.addWaypoint(position, getRotationFromDirection(direction));
+    }
+
+    enforceClearance(path, clearance);
+
+    return path;
+}
+
+QVector3D PathPlanner::getDirectionFromRotation(QVector3D rotation)
+{
+    // The camera moves forward along the negative Z-axis of its rotation matrix
+    const QMatrix3x3 matrix = CameraPath::getCameraRotationMatrix(rotation);
+    return -QVector3D(matrix(0, 2), matrix(1, 2), matrix(2, 2));
+}
+
+QVector3D PathPlanner::getRotationFromDirection(QVector3D direction)
+{
+    direction.normalize();
+
+    // The camera pitches about the X-axis and then yaws about the Y-axis, see getCameraRotationMatrix
+    const float pitch = std::asin(std::clamp(direction.y(), -1.0f, 1.0f));
+    const float yaw = std::atan2(-direction.x(), -direction.z());
+
+    return QVector3D(pitch, yaw, 0.0f);
+}
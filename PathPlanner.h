@@ -0,0 +1,125 @@
+#ifndef PATHPLANNER_H
+#define PATHPLANNER_H
+
+#include <cstdint>
+
+#include <QVector3D>
+
+#include "CameraPath.h"
+#include "FractalModule.h"
+#include "RenderParams.h"
+
+/// \brief
+///     The path planner checks camera paths against the distance estimate of the fractal on the CPU, using the C++
+///     twin of the distance estimate of the fractal module. It pushes waypoints out of the fractal so that the whole
+///     spline keeps a minimum clearance to the surface, and generates exploratory paths which follow the surface.
+///
+///     Distance estimates are always evaluated in batches which are split across all hardware threads, so checking
+///     the thousands of samples along a long path stays interactive.
+class PathPlanner
+{
+public:
+
+    /// The number of samples checked per segment between two waypoints.
+    static constexpr int32_t SAMPLES_PER_SEGMENT = 32;
+
+    /// The maximum number of times waypoints are pushed out of the fractal before giving up.
+    static constexpr int32_t CLEARANCE_ITERATIONS_MAX = 16;
+
+    /// The minimum number of distance estimates evaluated per thread. Smaller batches are evaluated on fewer threads
+    /// since starting a thread costs more than evaluating this many distance estimates.
+    static constexpr int32_t EVALUATIONS_PER_THREAD_MIN = 256;
+
+    /// The distance to the surface followed by exploratory paths as a multiple of the clearance.
+    static constexpr float EXPLORE_DISTANCE_FACTOR = 2.0f;
+
+    /// The number of steps, each as long as the distance followed, taken between two exploratory waypoints.
+    static constexpr int32_t EXPLORE_STEPS_PER_WAYPOINT = 8;
+
+    /// The maximum angle in degrees by which exploratory paths randomly turn about the surface normal per step.
+    static constexpr float EXPLORE_WANDER_DEGREES = 10.0f;
+
+    /// The ratio between the fastest and the slowest camera speed of a speed profile.
+    static constexpr float SPEED_RANGE = 16.0f;
+
+    /// The maximum change in camera speed of a speed profile per unit of arc length, where the speed is measured in
+    /// distance to the surface. Distance estimates change by at most 1 per unit of arc length, so smaller values
+    /// smooth out the speed.
+    static constexpr float SPEED_CHANGE_MAX = 0.25f;
+
+public:
+
+    /// \brief
+    ///     Create a path planner for the fractal described by the specified parameters.
+    explicit PathPlanner(const RenderParams& params);
+
+    /// \brief
+    ///     Determines whether the fractal module has a distance estimate on the CPU. All other functions must only be
+    ///     called if it does.
+    bool isValid() const;
+
+    /// \brief
+    ///     Evaluates the distance estimate at a batch of points.
+    /// \param points
+    ///     The points to evaluate the distance estimate at.
+    /// \param distances
+    ///     Receives the distance estimate at every point.
+    /// \param count
+    ///     The number of points in the batch.
+    void evaluate(const QVector3D* points, float* distances, int32_t count) const;
+
+    /// \brief
+    ///     Computes the surface normal at a batch of points from the gradient of the distance estimate using central
+    ///     differences, which are evaluated as a single batch.
+    /// \param delta
+    ///     The distance between the points the differences are taken at. Larger values smooth out finer detail.
+    void getNormals(const QVector3D* points, QVector3D* normals, int32_t count, float delta) const;
+
+    /// \brief
+    ///     Pushes the waypoints of a path out of the fractal along the surface normal until every sample of the spline
+    ///     is at least `clearance` away from the surface. Rotations are left as they are. The path is compiled
+    ///     afterwards.
+    /// \return
+    ///     The number of samples still closer to the surface than `clearance`, which is 0 unless the path could not
+    ///     be cleared within `CLEARANCE_ITERATIONS_MAX` iterations.
+    int32_t enforceClearance(CameraPath& path, float clearance) const;
+
+    /// \brief
+    ///     Computes a speed profile for a path in which the camera moves in proportion to its distance to the surface,
+    ///     so it slows down for close-up detail and speeds through empty space. The path is compiled first if needed.
+    ///
+    ///     The distance is sampled `SAMPLES_PER_SEGMENT` times per segment at even arc lengths and limited to
+    ///     `SPEED_RANGE` and `SPEED_CHANGE_MAX`. The time taken between samples is then summed up, normalized to the
+    ///     whole animation and inverted into arc lengths at even times, see `CameraPath::t2s`.
+    void compileSpeedProfile(CameraPath& path) const;
+
+    /// \brief
+    ///     Generates an exploratory path which starts at the specified camera and follows the surface of the fractal
+    ///     at `EXPLORE_DISTANCE_FACTOR` times the clearance, randomly wandering along it. The camera looks in the
+    ///     direction of travel. The path is cleared via `enforceClearance` and compiled.
+    /// \param waypointCount
+    ///     The number of waypoints of the path including the starting point.
+    /// \param seed
+    ///     The seed of the random wandering. The same seed always generates the same path.
+    CameraPath explore(QVector3D position, QVector3D rotation, int32_t waypointCount, float clearance,
+        uint32_t seed) const;
+
+    /// \brief
+    ///     Gets the direction the camera looks in for the specified rotation.
+    static QVector3D getDirectionFromRotation(QVector3D rotation);
+
+    /// \brief
+    ///     Gets the camera rotation without roll which looks in the specified direction. The inverse of
+    ///     `getDirectionFromRotation`.
+    static QVector3D getRotationFromDirection(QVector3D direction);
+
+private:
+
+    /// The distance estimate of the fractal module.
+    FractalModule::DistanceEstimator distanceEstimate = nullptr;
+
+    /// The fractal parameters the distance estimate is evaluated with.
+    RenderParams params;
+};
+
+#endif // PATHPLANNER_H
@@ -0,0 +1,259 @@
+#include "RenderCache.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace
+{
+    /// The extension of cached frame files.
+    constexpr const char* FILE_EXTENSION = ".frame";
+}
+
+QByteArray RenderCache::getKey(const QByteArray& variant, const QSize& size, const RenderParams* frames,
+    int32_t frameCount)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+
+    stream << FORMAT_VERSION << variant << size << frameCount;
+
+    for (int32_t i = 0; i < frameCount; ++i) {
+        // Only parameters which change what is drawn are part of the key
+        RenderParams params = frames[i];
+        params.fractalExposure = 0.0f;
+        params.viewportSize = QSize();
+        params.outputSize = QSize();
+        params.outputFormat = 0;
+
+        std::apply([&](const auto&... values) { ((stream << values), ...); }, params.tie());
+    }
+
+    return QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex();
+}
+
+QString RenderCache::getDefaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/frames";
+}
+
+RenderCache::RenderCache(const QString& directory, qint64 capacity, QObject* parent) :
+    QObject(parent),
+    directory(directory),
+    capacity(capacity),
+    thread(&RenderCache::run, this)
+{
+    // Failing to create the directory is reported by the first frame which cannot be written to it
+    QDir dir(directory);
+    dir.mkpath(".");
+
+    // Frames written by earlier runs are ordered by the last time they were used, which is kept as the time the file
+    // was last modified
+    const auto files = dir.entryInfoList({ QString("*") + FILE_EXTENSION }, QDir::Files, QDir::Time | QDir::Reversed);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const auto& file : files) {
+        const QByteArray key = file.completeBaseName().toLatin1();
+
+        Entry& entry = entries[key];
+        entry.bytes = file.size();
+        size += entry.bytes;
+
+        touch(key, entry);
+    }
+
+    evict();
+}
+
+RenderCache::~RenderCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    changed.notify_all();
+    thread.join();
+}
+
+void RenderCache::setCapacity(qint64 value)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    capacity = value;
+    evict();
+}
+
+bool RenderCache::load(const QByteArray& key, QByteArray& pixels, qint64 bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto iterator = entries.find(key);
+        if (iterator == entries.end()) {
+            return false;
+        }
+
+        touch(key, *iterator);
+    }
+
+    // The frame may be evicted while it is read, in which case opening or reading it simply fails
+    QFile file(getFileName(key));
+
+    if (file.open(QIODevice::ReadOnly) && file.size() == bytes) {
+        pixels.resize(bytes);
+
+        if (file.read(pixels.data(), bytes) == bytes) {
+            file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+            return true;
+        }
+    }
+
+    file.close();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto iterator = entries.find(key);
+    if (iterator != entries.end()) {
+        size -= iterator->bytes;
+        recency.erase(iterator->use);
+        entries.erase(iterator);
+
+        QFile::remove(getFileName(key));
+    }
+
+    return false;
+}
+
+bool RenderCache::canStore(const QByteArray& key, qint64 bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return isStorable(key, bytes);
+}
+
+QByteArray RenderCache::acquire(qint64 bytes)
+{
+    QByteArray pixels;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!pool.empty()) {
+            pixels = std::move(pool.back());
+            pool.pop_back();
+        }
+    }
+
+    // Buffers keep their allocation when they shrink, so they are only ever reallocated when frames get larger
+    pixels.resize(bytes);
+    return pixels;
+}
+
+void RenderCache::store(const QByteArray& key, QByteArray pixels)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!isStorable(key, pixels.size())) {
+            release(std::move(pixels));
+            return;
+        }
+
+        queue.push_back({ key, std::move(pixels) });
+    }
+
+    changed.notify_all();
+}
+
+QString RenderCache::getFileName(const QByteArray& key) const
+{
+    return directory + "/" + QString::fromLatin1(key) + FILE_EXTENSION;
+}
+
+void RenderCache::touch(const QByteArray& key, Entry& entry)
+{
+    recency.erase(entry.use);
+
+    entry.use = nextUse++;
+    recency[entry.use] = key;
+}
+
+bool RenderCache::isStorable(const QByteArray& key, qint64 bytes) const
+{
+    if (capacity < bytes || entries.contains(key) || static_cast<int32_t>(queue.size()) >= PENDING_MAX) {
+        return false;
+    }
+
+    // The same frame may be stored again before it has been written
+    return std::none_of(queue.begin(), queue.end(), [&](const Pending& pending) { return pending.key == key; });
+}
+
+void RenderCache::release(QByteArray&& pixels)
+{
+    // No more buffers are ever in use than frames can be pending, plus the one being read back
+    if (static_cast<int32_t>(pool.size()) < PENDING_MAX) {
+        pool.push_back(std::move(pixels));
+    }
+}
+
+void RenderCache::evict()
+{
+    while (size > capacity && !recency.empty()) {
+        const QByteArray key = recency.begin()->second;
+        recency.erase(recency.begin());
+
+        size -= entries.take(key).bytes;
+
+        QFile::remove(getFileName(key));
+    }
+}
+
+void RenderCache::run()
+{
+    for (;;) {
+        Pending pending;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return stopping || !queue.empty(); });
+
+            if (queue.empty()) {
+                return;
+            }
+
+            pending = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        // Frames are only found once they have been written completely
+        QSaveFile file(getFileName(pending.key));
+
+        const bool written = file.open(QIODevice::WriteOnly) && file.write(pending.pixels) == pending.pixels.size() &&
+            file.commit();
+
+        if (!written) {
+            emit statusChanged("Cannot write to the render cache \"" + directory + "\"");
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (written) {
+            Entry& entry = entries[pending.key];
+            size += pending.pixels.size() - entry.bytes;
+            entry.bytes = pending.pixels.size();
+
+            touch(pending.key, entry);
+            evict();
+        }
+
+        release(std::move(pending.pixels));
+    }
+}
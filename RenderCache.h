@@ -0,0 +1,197 @@
+#ifndef RENDERCACHE_H
+#define RENDERCACHE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QSize>
+#include <QString>
+
+#include "RenderParams.h"
+
+/// \brief
+///     The render cache keeps frames drawn before exposure on disk, addressed by a hash of everything that determines
+///     their content. Drawing a frame which was drawn before, e.g. when exporting an animation again in a different
+///     output format or previewing the same keyframes again, then only reads it back from disk instead of marching
+///     every ray again.
+///
+///     Frames are written to disk on a dedicated thread. The cache is best effort: frames are dropped rather than
+///     stalling the renderer if the disk falls behind, and the least recently used frames are evicted once the cache
+///     grows past its capacity.
+class RenderCache : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /// The default maximum size of all cached frames in bytes.
+    static constexpr qint64 CAPACITY_DEFAULT = 4LL * 1024 * 1024 * 1024;
+
+    /// The maximum number of frames waiting to be written before further frames are dropped.
+    static constexpr int32_t PENDING_MAX = 4;
+
+    /// The version of the cached frame files. Frames of other versions are never found.
+    static constexpr quint32 FORMAT_VERSION = 1;
+
+    /// \brief
+    ///     Computes the key of a frame.
+    /// \param variant
+    ///     Identifies everything about how the frame is drawn which is not part of the parameters, e.g. the shader
+    ///     source and the pixel format.
+    /// \param size
+    ///     The size of the frame in pixels.
+    /// \param frames
+    ///     The parameters of every frame blended into the frame. Exposure and the output settings are ignored since
+    ///     they are applied after the frame is drawn.
+    /// \param frameCount
+    ///     The number of parameter sets in `frames`.
+    static QByteArray getKey(const QByteArray& variant, const QSize& size, const RenderParams* frames,
+        int32_t frameCount);
+
+    /// \brief
+    ///     Gets the directory the cache is kept in by default.
+    static QString getDefaultDirectory();
+
+public:
+
+    /// \brief
+    ///     Opens the cache in the specified directory, creating the directory if it does not exist yet. Frames left
+    ///     there by earlier runs are found again, least recently used first.
+    explicit RenderCache(const QString& directory, qint64 capacity = CAPACITY_DEFAULT, QObject* parent = nullptr);
+
+    /// \brief
+    ///     Writes all pending frames and stops the writer thread.
+    ~RenderCache() override;
+
+    /// \brief
+    ///     Sets the maximum size of all cached frames in bytes, evicting frames if needed. A capacity of 0 disables
+    ///     the cache.
+    void setCapacity(qint64 capacity);
+
+    /// \brief
+    ///     Reads a cached frame.
+    /// \param key
+    ///     The key of the frame, see `getKey`.
+    /// \param pixels
+    ///     Receives the pixels of the frame. Its allocation is reused between calls.
+    /// \param bytes
+    ///     The expected size of the frame in bytes. Files of any other size are discarded.
+    /// \return
+    ///     true if the frame was found; false otherwise.
+    bool load(const QByteArray& key, QByteArray& pixels, qint64 bytes);
+
+    /// \brief
+    ///     Determines whether a frame of the specified size would be queued by `store` right now. Frames which would be
+    ///     dropped need not be read back at all.
+    bool canStore(const QByteArray& key, qint64 bytes);
+
+    /// \brief
+    ///     Takes a buffer of the specified size from the buffers of frames already written, to read a frame back into
+    ///     before it is passed to `store`. Allocates a new buffer only if none is left.
+    QByteArray acquire(qint64 bytes);
+
+    /// \brief
+    ///     Queues a frame to be written to the cache, unless it is already cached or too many frames are pending.
+    void store(const QByteArray& key, QByteArray pixels);
+
+signals:
+
+    /// \brief
+    ///     This signal is sent from the writer thread when a frame cannot be written.
+    void statusChanged(const QString& message);
+
+private:
+
+    /// \brief
+    ///     A frame on disk.
+    struct Entry
+    {
+        /// The size of the file in bytes.
+        qint64 bytes = 0;
+
+        /// The position of the frame in `recency`, or 0 if it has not been used yet.
+        quint64 use = 0;
+    };
+
+    /// \brief
+    ///     A frame waiting to be written.
+    struct Pending
+    {
+        QByteArray key;
+        QByteArray pixels;
+    };
+
+private:
+
+    /// \brief
+    ///     Gets the file the frame with the specified key is kept in.
+    QString getFileName(const QByteArray& key) const;
+
+    /// \brief
+    ///     Marks the frame as the most recently used. The mutex must be held.
+    void touch(const QByteArray& key, Entry& entry);
+
+    /// \brief
+    ///     Removes the least recently used frames until the cache fits its capacity. The mutex must be held.
+    void evict();
+
+    /// \brief
+    ///     Determines whether a frame would be queued by `store`. The mutex must be held.
+    bool isStorable(const QByteArray& key, qint64 bytes) const;
+
+    /// \brief
+    ///     Returns the buffer of a frame which was written or dropped to the pool. The mutex must be held.
+    void release(QByteArray&& pixels);
+
+    /// \brief
+    ///     Writes queued frames until the cache is destroyed. Runs on the writer thread.
+    void run();
+
+private:
+
+    /// The directory the frames are kept in.
+    QString directory;
+
+    /// Guards every member below.
+    std::mutex mutex;
+
+    /// Signalled when a frame is queued or the cache is closing.
+    std::condition_variable changed;
+
+    /// The maximum size of all cached frames in bytes.
+    qint64 capacity = 0;
+
+    /// The size of all cached frames in bytes.
+    qint64 size = 0;
+
+    /// The frames on disk by key.
+    QHash<QByteArray, Entry> entries;
+
+    /// The keys of the frames on disk, least recently used first.
+    std::map<quint64, QByteArray> recency;
+
+    /// The position given to the next frame used.
+    quint64 nextUse = 1;
+
+    /// Frames waiting to be written, oldest first.
+    std::deque<Pending> queue;
+
+    /// The buffers of frames already written, reused to read back further frames.
+    std::vector<QByteArray> pool;
+
+    /// Determines whether the writer thread should exit once the queue is empty.
+    bool stopping = false;
+
+    /// The thread writing frames.
+    std::thread thread;
+};
+
+#endif // RENDERCACHE_H
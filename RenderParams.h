@@ -0,0 +1,149 @@
+#ifndef RENDERPARAMS_H
+#define RENDERPARAMS_H
+
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+
+#include <QSize>
+#include <QVector3D>
+
+/// \brief
+///     Every parameter required to render a single frame of the fractal. The struct is trivially copyable so the GUI
+///     thread can publish a consistent snapshot to the render thread with a plain copy through a `TripleBuffer`, no
+///     matter how many parameters were changed in between frames.
+struct RenderParams
+{
+    /// The camera position in arbitary coordinates.
+    QVector3D cameraPosition;
+
+    /// The part of the camera position too small to be represented in `cameraPosition`. The exact camera position is
+    /// the sum of both, which gives roughly double the precision of a float. Only non-zero in deep zoom mode.
+    QVector3D cameraPositionLow;
+
+    /// The camera rotation in Euler angles.
+    QVector3D cameraRotation;
+
+    /// Determines whether deep zoom mode is enabled, which marches rays in double-float precision.
+    bool deepZoom = false;
+
+    /// The zoom depth in powers of two. The size of the smallest detail resolved is scaled by `2^-cameraZoom`.
+    float cameraZoom = 0.0f;
+
+    /// The index of the fractal module drawing the fractal in the `FractalModule` registry.
+    int32_t fractalModule = 0;
+
+    /// The fractal scale in arbitrary units.
+    float fractalScale = 0.0f;
+
+    /// The fractal position in arbitrary coordinates.
+    QVector3D fractalPosition;
+
+    /// The fractal rotation in arbitrary coordinates.
+    QVector3D fractalRotation;
+
+    /// The fractal exposure which is the amount of light that reaches the camera.
+    float fractalExposure = 0.0f;
+
+    /// The fractal colour which will be used for the orbit traps in RGB.
+    QVector3D fractalColor;
+
+    /// Determines whether anti-aliasing samples are only computed for pixels on edges. Every other pixel is computed
+    /// from a single sample.
+    bool sceneAdaptiveAntiAliasing = false;
+
+    /// The ambient occlusion delta used for global background shading.
+    float sceneAmbientOcclusionDelta = 0.0f;
+
+    /// The ambient occlusion strength used for global background shading.
+    float sceneAmbientOcclusionStrength = 0.0f;
+
+    /// The number of anti-aliasing samples to compute.
+    float sceneAntiAliasingSamples = 0.0f;
+
+    /// The scene (space) background colour in RGB.
+    QVector3D sceneBackgroundColor;
+
+    /// Determines whether scene diffuse lighting is enabled.
+    bool sceneDiffuseLighting = false;
+
+    /// Determines whether scene filtering is enabled.
+    bool sceneFiltering = false;
+
+    /// The scene focal distance, which is the angle of view.
+    float sceneFocalDistance = 0.0f;
+
+    /// Determines whether scene fog is enabled.
+    bool sceneFog = false;
+
+    /// The size in pixels of the smallest fractal detail rendered. Detail smaller than this is skipped by running
+    /// fewer fractal iterations for distant surfaces. 0 renders full detail everywhere.
+    float sceneLevelOfDetail = 0.0f;
+
+    /// The colour of the scene light source in RGB.
+    QVector3D sceneLightColor;
+
+    /// The direction of the scene light source.
+    QVector3D sceneLightDirection;
+
+    /// The number of shadow and ambient occlusion rays sampled per pixel per frame in sampled lighting mode.
+    float sceneLightingSamples = 0.0f;
+
+    /// Determines whether shadows and ambient occlusion are computed by sampling rays towards the light and around the
+    /// surface normal, accumulated over several frames, instead of being approximated from a single ray march.
+    bool sceneSampledLighting = false;
+
+    /// Determines whether the scene shadows are enabled.
+    bool sceneShadows = false;
+
+    /// The scene shadow darkness in range [0, inf)
+    float sceneShadowDarkness = 0.0f;
+
+    /// The scene shadow sharpness in range [0, inf)
+    float sceneShadowSharpness = 0.0f;
+
+    /// The scene specular highlight amount.
+    float sceneSpecularHighlight = 0.0f;
+
+    /// The scene specular highlight multiplier.
+    float sceneSpecularMultiplier = 0.0f;
+
+    /// The diagnostic heatmap drawn instead of the lit fractal, as a `FractalRenderer::Heatmap`.
+    int32_t sceneHeatmap = 0;
+
+    /// The size of the frame displayed by the widget in device pixels.
+    QSize viewportSize;
+
+    /// The size of the keyframe image saved to disk.
+    QSize outputSize;
+
+    /// The format the keyframe image is saved in, as a `FrameWriter::Format`.
+    int32_t outputFormat = 0;
+
+    /// \brief
+    ///     Ties every parameter together so that parameter sets can be compared member-wise.
+    auto tie() const
+    {
+        return std::tie(cameraPosition, cameraPositionLow, cameraRotation, deepZoom, cameraZoom, fractalModule,
+            fractalScale, fractalPosition, fractalRotation, fractalExposure, fractalColor, sceneAdaptiveAntiAliasing,
+            sceneAmbientOcclusionDelta, sceneAmbientOcclusionStrength, sceneAntiAliasingSamples, sceneBackgroundColor,
+            sceneDiffuseLighting, sceneFiltering, sceneFocalDistance, sceneFog, sceneLevelOfDetail, sceneLightColor,
+            sceneLightDirection, sceneLightingSamples, sceneSampledLighting, sceneShadows, sceneShadowDarkness,
+            sceneShadowSharpness, sceneSpecularHighlight, sceneSpecularMultiplier, sceneHeatmap, viewportSize,
+            outputSize, outputFormat);
+    }
+
+    bool operator==(const RenderParams& other) const
+    {
+        return tie() == other.tie();
+    }
+
+    bool operator!=(const RenderParams& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+static_assert(std::is_trivially_copyable<RenderParams>::value, "RenderParams must be trivially copyable");
+
+#endif // RENDERPARAMS_H
@@ -0,0 +1,171 @@
+#include "RenderQueue.h"
+
+#include "FractalWidget.h"
+
+#include <algorithm>
+#include <thread>
+
+RenderQueue::RenderQueue(FractalWidget* fractal, std::function<void(const Scene&)> applyScene, QObject* parent) :
+    QObject(parent),
+    fractal(fractal),
+    applyScene(std::move(applyScene))
+{
+    QObject::connect(fractal, &FractalWidget::keyframesProgressChanged, this, &RenderQueue::updateProgress);
+
+    // Advance outside of the fractal widget paint event which emitted the signal
+    QObject::connect(fractal, &FractalWidget::animateKeyframesFinished, this,
+        [=]()
+        {
+            if (running && mode == Mode::Animate) {
+                startNextJob();
+            }
+        }, Qt::QueuedConnection);
+
+    QObject::connect(fractal, &FractalWidget::previewKeyframesFinished, this,
+        [=]()
+        {
+            if (running && mode == Mode::Preview) {
+                startNextJob();
+            }
+        }, Qt::QueuedConnection);
+
+    QObject::connect(fractal, &FractalWidget::animateKeyframesCancelled, this, &RenderQueue::stop);
+    QObject::connect(fractal, &FractalWidget::previewKeyframesCancelled, this, &RenderQueue::stop);
+}
+
+void RenderQueue::setScenes(const QVector<Scene>& value)
+{
+    if (!running) {
+        scenes = value;
+    }
+}
+
+bool RenderQueue::start(Mode value)
+{
+    if (running || scenes.isEmpty()) {
+        return false;
+    }
+
+    mode = value;
+    running = true;
+    jobIndex = -1;
+    queueFrames = 0;
+    queueTimer.start();
+
+    // The first job is compiled on the calling thread when it starts
+    prefetchIndex = -1;
+
+    startNextJob();
+
+    return running;
+}
+
+void RenderQueue::stop()
+{
+    if (running) {
+        running = false;
+
+        // The compile finishes on its own thread and its result is dropped
+        prefetchPath = std::future<CameraPath>();
+        prefetchIndex = -1;
+
+        emit statusChanged(QString("Render queue stopped at job %1 / %2").arg(jobIndex + 1).arg(scenes.size()));
+        emit stopped();
+    }
+}
+
+bool RenderQueue::isRunning() const
+{
+    return running;
+}
+
+void RenderQueue::startNextJob()
+{
+    while (++jobIndex < scenes.size()) {
+        applyScene(scenes[jobIndex]);
+
+        if (prefetchIndex == jobIndex && prefetchPath.valid()) {
+            fractal->setCameraPath(prefetchPath.get());
+            prefetchIndex = -1;
+        }
+
+        jobFrames = 0;
+        jobTimer.start();
+
+        auto started = (mode == Mode::Animate) ? fractal->animateKeyframes() : fractal->previewKeyframes();
+        if (started) {
+            prefetchNextJob();
+            return;
+        }
+
+        emit statusChanged(QString("Skipping job %1 / %2 \"%3\" because it has fewer than two waypoints")
+            .arg(jobIndex + 1)
+            .arg(scenes.size())
+            .arg(scenes[jobIndex].name));
+    }
+
+    running = false;
+
+    auto seconds = queueTimer.elapsed() / 1000.0f;
+    auto status = QString("Render queue finished %1 job(s), %2 keyframes in %3 (s) at %4 FPS")
+        .arg(scenes.size())
+        .arg(queueFrames)
+        .arg(QString::number(seconds, 'f', 1))
+        .arg(QString::number(seconds > 0 ? queueFrames / seconds : 0.0f, 'f', 2));
+
+    emit statusChanged(status);
+    emit finished();
+}
+
+void RenderQueue::prefetchNextJob()
+{
+    auto nextIndex = jobIndex + 1;
+
+    if (nextIndex < scenes.size()) {
+        const auto& scene = scenes[nextIndex];
+
+        CameraPath path;
+        for (int32_t i = 0; i < scene.positionWaypoints.size() && i < scene.rotationWaypoints.size(); ++i) {
+            path.addWaypoint(scene.positionWaypoints[i], scene.rotationWaypoints[i]);
+        }
+
+        std::packaged_task<CameraPath()> task(
+            [path]() mutable
+            {
+                if (path.size() > 1) {
+                    path.compile();
+                }
+
+                return path;
+            });
+
+        prefetchIndex = nextIndex;
+        prefetchPath = task.get_future();
+
+        std::thread(std::move(task)).detach();
+    }
+}
+
+void RenderQueue::updateProgress(float elapsed, float duration)
+{
+    if (!running) {
+        return;
+    }
+
+    ++jobFrames;
+    ++queueFrames;
+
+    auto jobSeconds = jobTimer.elapsed() / 1000.0f;
+    auto jobProgress = duration > 0 ? std::min(elapsed / duration, 1.0f) : 1.0f;
+    auto queueProgress = (jobIndex + jobProgress) / scenes.size();
+
+    auto status = QString("Job %1 / %2 \"%3\": %4% at %5 FPS, queue %6%")
+        .arg(jobIndex + 1)
+        .arg(scenes.size())
+        .arg(scenes[jobIndex].name)
+        .arg(QString::number(jobProgress * 100.0f, 'f', 1))
+        .arg(QString::number(jobSeconds > 0 ? jobFrames / jobSeconds : 0.0f, 'f', 2))
+        .arg(QString::number(queueProgress * 100.0f, 'f', 1));
+
+    emit statusChanged(status);
+}
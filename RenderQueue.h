@@ -0,0 +1,131 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <functional>
+#include <future>
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+#include "CameraPath.h"
+#include "Scene.h"
+
+class FractalWidget;
+
+/// \brief
+///     The render queue animates or previews a list of scenes back-to-back without any user interaction. While one
+///     scene is being rendered the camera path of the next scene is compiled on a worker thread so that consecutive
+///     scenes start without a pause. Progress and throughput of every job are reported via `statusChanged`.
+class RenderQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /// \brief
+    ///     Determines whether the jobs in the queue are animated and saved to disk or only previewed.
+    enum class Mode
+    {
+        Animate,
+        Preview,
+    };
+
+public:
+
+    /// \brief
+    ///     Create a new empty render queue which drives the specified fractal widget.
+    /// \param fractal
+    ///     The fractal widget which renders the scenes.
+    /// \param applyScene
+    ///     A function which applies a scene to the fractal widget and any controls reflecting its state.
+    RenderQueue(FractalWidget* fractal, std::function<void(const Scene&)> applyScene, QObject* parent = nullptr);
+
+    /// \brief
+    ///     Replaces all jobs in the queue. Must not be called while the queue is running.
+    void setScenes(const QVector<Scene>& scenes);
+
+    /// \brief
+    ///     Starts rendering the queued scenes from the first one.
+    /// \return
+    ///     true if the queue has started; false if it is empty or already running.
+    bool start(Mode mode);
+
+    /// \brief
+    ///     Stops the queue. The job currently rendering is left to the fractal widget to cancel, and the camera path
+    ///     being compiled for the next job is discarded without waiting for it.
+    void stop();
+
+    /// \brief
+    ///     Determines whether the queue is currently rendering a job.
+    bool isRunning() const;
+
+signals:
+
+    /// \brief
+    ///     This signal is sent when the progress of the queue changes.
+    void statusChanged(const QString& message);
+
+    /// \brief
+    ///     This signal is sent when the last job of the queue has finished.
+    void finished();
+
+    /// \brief
+    ///     This signal is sent when the queue is stopped before its last job has finished.
+    void stopped();
+
+private:
+
+    /// \brief
+    ///     Starts rendering the job at `jobIndex`, skipping jobs which cannot be animated.
+    void startNextJob();
+
+    /// \brief
+    ///     Starts compiling the camera path of the job following `jobIndex` on a worker thread.
+    void prefetchNextJob();
+
+    /// \brief
+    ///     Reports the progress of the current job.
+    void updateProgress(float elapsed, float duration);
+
+private:
+
+    /// The fractal widget which renders the scenes.
+    FractalWidget* fractal;
+
+    /// Applies a scene to the fractal widget and any controls reflecting its state.
+    std::function<void(const Scene&)> applyScene;
+
+    /// The scenes to be rendered in order.
+    QVector<Scene> scenes;
+
+    /// Whether jobs are animated or previewed.
+    Mode mode = Mode::Animate;
+
+    /// Determines whether the queue is currently rendering.
+    bool running = false;
+
+    /// Index of the job currently rendering.
+    int32_t jobIndex = -1;
+
+    /// The camera path of the job at `prefetchIndex` being compiled on a detached worker thread. Unlike futures of
+    /// `std::async`, discarding it never waits for the compile to finish.
+    std::future<CameraPath> prefetchPath;
+
+    /// Index of the job whose camera path is being compiled.
+    int32_t prefetchIndex = -1;
+
+    /// Measures the wall time of the current job.
+    QElapsedTimer jobTimer;
+
+    /// Measures the wall time of the whole queue.
+    QElapsedTimer queueTimer;
+
+    /// The number of keyframes rendered for the current job.
+    int64_t jobFrames = 0;
+
+    /// The number of keyframes rendered for all jobs.
+    int64_t queueFrames = 0;
+};
+
+#endif // RENDERQUEUE_H
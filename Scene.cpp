@@ -0,0 +1,468 @@
+#include "Scene.h"
+
+#include "FractalModule.h"
+#include "FrameWriter.h"
+
+#include <algorithm>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+static QJsonArray toJson(const QVector2D& v)
+{
+    return { v.x(), v.y() };
+}
+
+static QJsonArray toJson(const QVector3D& v)
+{
+    return { v.x(), v.y(), v.z() };
+}
+
+static QVector2D toVector2D(const QJsonValue& value, const QVector2D& fallback)
+{
+    auto array = value.toArray();
+    if (array.size() != 2) {
+        return fallback;
+    }
+
+    return QVector2D(array[0].toDouble(), array[1].toDouble());
+}
+
+static QVector3D toVector3D(const QJsonValue& value, const QVector3D& fallback)
+{
+    auto array = value.toArray();
+    if (array.size() != 3) {
+        return fallback;
+    }
+
+    return QVector3D(array[0].toDouble(), array[1].toDouble(), array[2].toDouble());
+}
+
+static QColor toColor(const QJsonValue& value, const QColor& fallback)
+{
+    QColor color(value.toString());
+    return color.isValid() ? color : fallback;
+}
+
+QJsonObject Scene::toJson() const
+{
+    QJsonObject camera
+    {
+        { "position", ::toJson(cameraPosition) },
+        { "rotation", ::toJson(cameraRotation) },
+    };
+
+    QJsonObject fractal
+    {
+        { "module", fractalModule },
+        { "scale", fractalScale },
+        { "shift", ::toJson(fractalPosition) },
+        { "rotation", ::toJson(fractalRotation) },
+        { "exposure", fractalExposure },
+        { "color", fractalColor.name() },
+        { "keyframe", fractalKeyframe },
+    };
+
+    QJsonObject scene
+    {
+        { "adaptiveAntiAliasing", sceneAdaptiveAntiAliasing },
+        { "ambientOcclusionDelta", sceneAmbientOcclusionDelta },
+        { "ambientOcclusionStrength", sceneAmbientOcclusionStrength },
+        { "antiAliasingSamples", sceneAntiAliasingSamples },
+        { "backgroundColor", sceneBackgroundColor.name() },
+        { "diffuseLighting", sceneDiffuseLighting },
+        { "filtering", sceneFiltering },
+        { "focalDistance", sceneFocalDistance },
+        { "fog", sceneFog },
+        { "levelOfDetail", sceneLevelOfDetail },
+        { "lightColor", sceneLightColor.name() },
+        { "lightDirection", ::toJson(sceneLightDirection) },
+        { "lightingSamples", sceneLightingSamples },
+        { "sampledLighting", sceneSampledLighting },
+        { "shadows", sceneShadows },
+        { "shadowDarkness", sceneShadowDarkness },
+        { "shadowSharpness", sceneShadowSharpness },
+        { "specularHighlight", sceneSpecularHighlight },
+        { "specularMultiplier", sceneSpecularMultiplier },
+    };
+
+    QJsonObject output
+    {
+        { "resolution", ::toJson(outputResolution) },
+        { "targetFPS", outputTargetFPS },
+        { "targetDuration", outputTargetDuration },
+        { "directory", outputDirectory },
+        { "format", outputFormat },
+        { "motionBlurSamples", outputMotionBlurSamples },
+        { "shutter", outputShutter },
+        { "adaptiveSpeed", outputAdaptiveSpeed },
+        { "renderPasses", outputRenderPasses },
+    };
+
+    QJsonArray waypoints;
+    for (int32_t i = 0; i < positionWaypoints.size() && i < rotationWaypoints.size(); ++i) {
+        waypoints.append(QJsonObject
+        {
+            { "position", ::toJson(positionWaypoints[i]) },
+            { "rotation", ::toJson(rotationWaypoints[i]) },
+        });
+    }
+
+    return
+    {
+        { "name", name },
+        { "camera", camera },
+        { "fractal", fractal },
+        { "scene", scene },
+        { "output", output },
+        { "waypoints", waypoints },
+    };
+}
+
+RenderParams Scene::getRenderParams() const
+{
+    auto toVector3D = [](const QColor& color)
+    {
+        return QVector3D(color.redF(), color.greenF(), color.blueF());
+    };
+
+    RenderParams params;
+
+    params.cameraPosition = cameraPosition;
+    params.cameraRotation = cameraRotation;
+
+    params.fractalModule = std::max(FractalModule::findModule(fractalModule), 0);
+    params.fractalScale = fractalScale;
+    params.fractalPosition = fractalPosition;
+    params.fractalRotation = fractalRotation;
+    params.fractalExposure = fractalExposure;
+    params.fractalColor = toVector3D(fractalColor);
+
+    params.sceneAdaptiveAntiAliasing = sceneAdaptiveAntiAliasing;
+    params.sceneAmbientOcclusionDelta = sceneAmbientOcclusionDelta;
+    params.sceneAmbientOcclusionStrength = sceneAmbientOcclusionStrength;
+    params.sceneAntiAliasingSamples = sceneAntiAliasingSamples;
+    params.sceneBackgroundColor = toVector3D(sceneBackgroundColor);
+    params.sceneDiffuseLighting = sceneDiffuseLighting;
+    params.sceneFiltering = sceneFiltering;
+    params.sceneFocalDistance = sceneFocalDistance;
+    params.sceneFog = sceneFog;
+    params.sceneLevelOfDetail = sceneLevelOfDetail;
+    params.sceneLightColor = toVector3D(sceneLightColor);
+    params.sceneLightDirection = sceneLightDirection;
+    params.sceneLightingSamples = sceneLightingSamples;
+    params.sceneSampledLighting = sceneSampledLighting;
+    params.sceneShadows = sceneShadows;
+    params.sceneShadowDarkness = sceneShadowDarkness;
+    params.sceneShadowSharpness = sceneShadowSharpness;
+    params.sceneSpecularHighlight = sceneSpecularHighlight;
+    params.sceneSpecularMultiplier = sceneSpecularMultiplier;
+
+    params.outputSize = QSize(outputResolution.x(), outputResolution.y());
+
+    auto format = FrameWriter::Format::RGB8;
+    FrameWriter::findFormat(outputFormat, format);
+    params.outputFormat = static_cast<int32_t>(format);
+
+    return params;
+}
+
+Scene Scene::fromJson(const QJsonObject& json, const Scene& base)
+{
+    Scene result = base;
+
+    result.name = json["name"].toString(base.name);
+
+    auto camera = json["camera"].toObject();
+    result.cameraPosition = toVector3D(camera["position"], base.cameraPosition);
+    result.cameraRotation = toVector3D(camera["rotation"], base.cameraRotation);
+
+    auto fractal = json["fractal"].toObject();
+    result.fractalModule = fractal["module"].toString(base.fractalModule);
+    result.fractalScale = fractal["scale"].toDouble(base.fractalScale);
+    result.fractalPosition = toVector3D(fractal["shift"], base.fractalPosition);
+    result.fractalRotation = toVector3D(fractal["rotation"], base.fractalRotation);
+    result.fractalExposure = fractal["exposure"].toDouble(base.fractalExposure);
+    result.fractalColor = toColor(fractal["color"], base.fractalColor);
+    result.fractalKeyframe = fractal["keyframe"].toInt(base.fractalKeyframe);
+
+    auto scene = json["scene"].toObject();
+    result.sceneAdaptiveAntiAliasing = scene["adaptiveAntiAliasing"].toBool(base.sceneAdaptiveAntiAliasing);
+    result.sceneAmbientOcclusionDelta = scene["ambientOcclusionDelta"].toDouble(base.sceneAmbientOcclusionDelta);
+    result.sceneAmbientOcclusionStrength = scene["ambientOcclusionStrength"].toDouble(base.sceneAmbientOcclusionStrength);
+    result.sceneAntiAliasingSamples = scene["antiAliasingSamples"].toDouble(base.sceneAntiAliasingSamples);
+    result.sceneBackgroundColor = toColor(scene["backgroundColor"], base.sceneBackgroundColor);
+    result.sceneDiffuseLighting = scene["diffuseLighting"].toBool(base.sceneDiffuseLighting);
+    result.sceneFiltering = scene["filtering"].toBool(base.sceneFiltering);
+    result.sceneFocalDistance = scene["focalDistance"].toDouble(base.sceneFocalDistance);
+    result.sceneFog = scene["fog"].toBool(base.sceneFog);
+    result.sceneLevelOfDetail = scene["levelOfDetail"].toDouble(base.sceneLevelOfDetail);
+    result.sceneLightColor = toColor(scene["lightColor"], base.sceneLightColor);
+    result.sceneLightDirection = toVector3D(scene["lightDirection"], base.sceneLightDirection);
+    result.sceneLightingSamples = scene["lightingSamples"].toDouble(base.sceneLightingSamples);
+    result.sceneSampledLighting = scene["sampledLighting"].toBool(base.sceneSampledLighting);
+    result.sceneShadows = scene["shadows"].toBool(base.sceneShadows);
+    result.sceneShadowDarkness = scene["shadowDarkness"].toDouble(base.sceneShadowDarkness);
+    result.sceneShadowSharpness = scene["shadowSharpness"].toDouble(base.sceneShadowSharpness);
+    result.sceneSpecularHighlight = scene["specularHighlight"].toDouble(base.sceneSpecularHighlight);
+    result.sceneSpecularMultiplier = scene["specularMultiplier"].toDouble(base.sceneSpecularMultiplier);
+
+    auto output = json["output"].toObject();
+    result.outputResolution = toVector2D(output["resolution"], base.outputResolution);
+    result.outputTargetFPS = output["targetFPS"].toDouble(base.outputTargetFPS);
+    result.outputTargetDuration = output["targetDuration"].toDouble(base.outputTargetDuration);
+    result.outputDirectory = output["directory"].toString(base.outputDirectory);
+    result.outputFormat = output["format"].toString(base.outputFormat);
+    result.outputMotionBlurSamples = output["motionBlurSamples"].toDouble(base.outputMotionBlurSamples);
+    result.outputShutter = output["shutter"].toDouble(base.outputShutter);
+    result.outputAdaptiveSpeed = output["adaptiveSpeed"].toBool(base.outputAdaptiveSpeed);
+    result.outputRenderPasses = output["renderPasses"].toBool(base.outputRenderPasses);
+
+    if (json.contains("waypoints")) {
+        result.positionWaypoints.clear();
+        result.rotationWaypoints.clear();
+
+        for (const auto& waypoint : json["waypoints"].toArray()) {
+            auto object = waypoint.toObject();
+
+            result.positionWaypoints.append(toVector3D(object["position"], {}));
+            result.rotationWaypoints.append(toVector3D(object["rotation"], {}));
+        }
+    }
+
+    return result;
+}
+
+void Scene::applyVersionDefaults(QJsonObject& json, quint32 version)
+{
+    const Scene defaults;
+    auto scene = json["scene"].toObject();
+
+    if (version < 2 && !scene.contains("levelOfDetail")) {
+        scene["levelOfDetail"] = defaults.sceneLevelOfDetail;
+    }
+
+    if (version < 5 && !scene.contains("adaptiveAntiAliasing")) {
+        scene["adaptiveAntiAliasing"] = defaults.sceneAdaptiveAntiAliasing;
+    }
+
+    json["scene"] = scene;
+}
+
+bool Scene::load(const QString& fileName, QVector<QJsonObject>& scenes, QString& error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = "Cannot open scene file \"" + fileName + "\": " + file.errorString();
+        return false;
+    }
+
+    auto data = file.readAll();
+
+    QDataStream stream(data);
+    quint32 magic = 0;
+    stream >> magic;
+
+    if (magic == FORMAT_MAGIC) {
+        quint32 version = 0;
+        quint32 count = 0;
+        stream >> version;
+
+        if (version > FORMAT_VERSION) {
+            error = QString("Scene file \"%1\" has unsupported version %2").arg(fileName).arg(version);
+            return false;
+        }
+
+        stream.setVersion(QDataStream::Qt_5_12);
+        stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        stream >> count;
+
+        QVector<QJsonObject> result;
+
+        for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+            result.append(read(stream, version).toJson());
+        }
+
+        if (stream.status() != QDataStream::Ok) {
+            error = "Scene file \"" + fileName + "\" is truncated or corrupt";
+            return false;
+        }
+
+        scenes = result;
+        return true;
+    }
+
+    QJsonParseError parseError;
+    auto document = QJsonDocument::fromJson(data, &parseError);
+
+    if (document.isNull()) {
+        error = "Cannot parse scene file \"" + fileName + "\": " + parseError.errorString();
+        return false;
+    }
+
+    auto root = document.object();
+
+    if (root["format"].toString() != FORMAT_NAME) {
+        error = "File \"" + fileName + "\" is not a scene file";
+        return false;
+    }
+
+    auto version = root["version"].toInt();
+    if (version <= 0 || static_cast<quint32>(version) > FORMAT_VERSION) {
+        error = QString("Scene file \"%1\" has unsupported version %2").arg(fileName).arg(version);
+        return false;
+    }
+
+    QVector<QJsonObject> result;
+    for (const auto& scene : root["scenes"].toArray()) {
+        auto object = scene.toObject();
+        applyVersionDefaults(object, static_cast<quint32>(version));
+        result.append(object);
+    }
+
+    scenes = result;
+    return true;
+}
+
+bool Scene::save(const QString& fileName, const QVector<Scene>& scenes, QString& error)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = "Cannot open scene file \"" + fileName + "\": " + file.errorString();
+        return false;
+    }
+
+    if (QFileInfo(fileName).suffix() == "fpscene") {
+        QDataStream stream(&file);
+        stream << FORMAT_MAGIC << FORMAT_VERSION;
+
+        stream.setVersion(QDataStream::Qt_5_12);
+        stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        stream << static_cast<quint32>(scenes.size());
+
+        for (const auto& scene : scenes) {
+            stream << scene;
+        }
+    } else {
+        QJsonArray array;
+        for (const auto& scene : scenes) {
+            array.append(scene.toJson());
+        }
+
+        QJsonObject root
+        {
+            { "format", FORMAT_NAME },
+            { "version", static_cast<int32_t>(FORMAT_VERSION) },
+            { "scenes", array },
+        };
+
+        file.write(QJsonDocument(root).toJson());
+    }
+
+    if (!file.commit()) {
+        error = "Cannot write scene file \"" + fileName + "\": " + file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QDataStream& operator<<(QDataStream& stream, const Scene& scene)
+{
+    stream << scene.name;
+    stream << scene.cameraPosition << scene.cameraRotation;
+
+    stream << scene.fractalScale << scene.fractalPosition << scene.fractalRotation << scene.fractalExposure;
+    stream << scene.fractalColor << static_cast<qint32>(scene.fractalKeyframe);
+
+    stream << scene.sceneAmbientOcclusionDelta << scene.sceneAmbientOcclusionStrength;
+    stream << scene.sceneAntiAliasingSamples << scene.sceneBackgroundColor;
+    stream << scene.sceneDiffuseLighting << scene.sceneFiltering << scene.sceneFocalDistance << scene.sceneFog;
+    stream << scene.sceneLightColor << scene.sceneLightDirection;
+    stream << scene.sceneShadows << scene.sceneShadowDarkness << scene.sceneShadowSharpness;
+    stream << scene.sceneSpecularHighlight << scene.sceneSpecularMultiplier;
+
+    stream << scene.outputResolution << scene.outputTargetFPS << scene.outputTargetDuration << scene.outputDirectory;
+
+    stream << scene.positionWaypoints << scene.rotationWaypoints;
+
+    stream << scene.sceneLevelOfDetail;
+    stream << scene.fractalModule;
+    stream << scene.sceneSampledLighting << scene.sceneLightingSamples;
+    stream << scene.sceneAdaptiveAntiAliasing;
+    stream << scene.outputFormat;
+    stream << scene.outputMotionBlurSamples << scene.outputShutter;
+    stream << scene.outputAdaptiveSpeed;
+    stream << scene.outputRenderPasses;
+
+    return stream;
+}
+
+Scene Scene::read(QDataStream& stream, quint32 version)
+{
+    Scene scene;
+    qint32 fractalKeyframe = 0;
+
+    stream >> scene.name;
+    stream >> scene.cameraPosition >> scene.cameraRotation;
+
+    stream >> scene.fractalScale >> scene.fractalPosition >> scene.fractalRotation >> scene.fractalExposure;
+    stream >> scene.fractalColor >> fractalKeyframe;
+
+    stream >> scene.sceneAmbientOcclusionDelta >> scene.sceneAmbientOcclusionStrength;
+    stream >> scene.sceneAntiAliasingSamples >> scene.sceneBackgroundColor;
+    stream >> scene.sceneDiffuseLighting >> scene.sceneFiltering >> scene.sceneFocalDistance >> scene.sceneFog;
+    stream >> scene.sceneLightColor >> scene.sceneLightDirection;
+    stream >> scene.sceneShadows >> scene.sceneShadowDarkness >> scene.sceneShadowSharpness;
+    stream >> scene.sceneSpecularHighlight >> scene.sceneSpecularMultiplier;
+
+    stream >> scene.outputResolution >> scene.outputTargetFPS >> scene.outputTargetDuration >> scene.outputDirectory;
+
+    stream >> scene.positionWaypoints >> scene.rotationWaypoints;
+
+    // Parameters added in later versions are appended in the order they were introduced
+    if (version >= 2) {
+        stream >> scene.sceneLevelOfDetail;
+    }
+
+    if (version >= 3) {
+        stream >> scene.fractalModule;
+    }
+
+    if (version >= 4) {
+        stream >> scene.sceneSampledLighting >> scene.sceneLightingSamples;
+    }
+
+    if (version >= 5) {
+        stream >> scene.sceneAdaptiveAntiAliasing;
+    }
+
+    if (version >= 6) {
+        stream >> scene.outputFormat;
+    }
+
+    if (version >= 7) {
+        stream >> scene.outputMotionBlurSamples >> scene.outputShutter;
+    }
+
+    if (version >= 8) {
+        stream >> scene.outputAdaptiveSpeed;
+    }
+
+    if (version >= 9) {
+        stream >> scene.outputRenderPasses;
+    }
+
+    scene.fractalKeyframe = fractalKeyframe;
+
+    return scene;
+}
+
+QDataStream& operator>>(QDataStream& stream, Scene& scene)
+{
+    scene = Scene::read(stream, Scene::FORMAT_VERSION);
+    return stream;
+}
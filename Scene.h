@@ -0,0 +1,226 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <QColor>
+#include <QDataStream>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <QVector2D>
+#include <QVector3D>
+
+#include "RenderParams.h"
+
+/// \brief
+///     A scene captures the complete state required to reproduce a fractal animation; the camera, every fractal,
+///     scene and output parameter exposed by the FractalWidget, and the list of recorded waypoints.
+///
+///     Scenes are stored either as human editable JSON or as a compact binary stream. A single scene file may hold
+///     several scenes which are queued and animated one after the other. Keys missing from a JSON scene inherit their
+///     value from the scene the JSON is applied on top of, which allows scene files to only describe what changes.
+class Scene
+{
+public:
+
+    /// The identifier written to every JSON scene file.
+    static constexpr const char* FORMAT_NAME = "FractalPioneerScene";
+
+    /// The magic number identifying a binary scene file ("FPSC").
+    static constexpr quint32 FORMAT_MAGIC = 0x46505343;
+
+    /// The current version of the scene file format. Files with a newer version are rejected.
+    ///
+    /// Version history:
+    ///     1: Initial version
+    ///     2: Adds the scene level of detail
+    ///     3: Adds the fractal module
+    ///     4: Adds sampled lighting and the scene lighting samples
+    ///     5: Adds adaptive anti-aliasing
+    ///     6: Adds the output format
+    ///     7: Adds motion blur
+    ///     8: Adds adaptive speed
+    ///     9: Adds render passes
+    static constexpr quint32 FORMAT_VERSION = 9;
+
+public:
+
+    /// \brief
+    ///     Serializes this scene into a JSON object containing every parameter.
+    QJsonObject toJson() const;
+
+    /// \brief
+    ///     Gets the parameters required to render this scene from the current camera position.
+    RenderParams getRenderParams() const;
+
+    /// \brief
+    ///     Deserializes a scene from a JSON object.
+    /// \param json
+    ///     The JSON object to deserialize.
+    /// \param base
+    ///     The scene whose values are used for any keys missing from the JSON object.
+    static Scene fromJson(const QJsonObject& json, const Scene& base);
+
+    /// \brief
+    ///     Loads a list of scenes from a JSON or binary scene file. The format is detected from the file contents.
+    /// \param fileName
+    ///     The path of the scene file.
+    /// \param scenes
+    ///     The loaded scenes as JSON objects to be applied on top of the current scene using `fromJson`.
+    /// \param error
+    ///     A human readable description of the error if loading failed.
+    /// \return
+    ///     true if the file was loaded successfully; false otherwise.
+    static bool load(const QString& fileName, QVector<QJsonObject>& scenes, QString& error);
+
+    /// \brief
+    ///     Saves a list of scenes to a scene file. Files with a `.fpscene` suffix are saved in the compact binary
+    ///     format, all other files are saved as JSON.
+    /// \param fileName
+    ///     The path of the scene file.
+    /// \param scenes
+    ///     The scenes to save.
+    /// \param error
+    ///     A human readable description of the error if saving failed.
+    /// \return
+    ///     true if the file was saved successfully; false otherwise.
+    static bool save(const QString& fileName, const QVector<Scene>& scenes, QString& error);
+
+    /// \brief
+    ///     Reads a scene from a binary stream written by the specified version of the scene file format. Parameters
+    ///     introduced in later versions keep their default values.
+    static Scene read(QDataStream& stream, quint32 version);
+
+    /// \brief
+    ///     Adds the parameters introduced after the specified version of the scene file format to a scene read from
+    ///     a JSON scene file of that version. They get the values which reproduce how the scene looked back then,
+    ///     just like `read`, rather than inheriting the current state of the UI via `fromJson`.
+    static void applyVersionDefaults(QJsonObject& json, quint32 version);
+
+public:
+
+    /// The user visible name of the scene.
+    QString name;
+
+    /// The camera position in arbitary coordinates.
+    QVector3D cameraPosition;
+
+    /// The camera rotation in Euler angles.
+    QVector3D cameraRotation;
+
+    /// The name of the fractal module drawing the fractal, see `FractalModule`.
+    QString fractalModule = "menger";
+
+    /// The fractal scale in arbitrary units.
+    float fractalScale = 0.0f;
+
+    /// The fractal position in arbitrary coordinates.
+    QVector3D fractalPosition;
+
+    /// The fractal rotation in arbitrary coordinates.
+    QVector3D fractalRotation;
+
+    /// The fractal exposure which is the amount of light that reaches the camera.
+    float fractalExposure = 0.0f;
+
+    /// The fractal colour which will be used for the orbit traps.
+    QColor fractalColor;
+
+    /// The fractal animation keyframe.
+    int32_t fractalKeyframe = 0;
+
+    /// Determines whether anti-aliasing samples are only computed for pixels on edges.
+    bool sceneAdaptiveAntiAliasing = false;
+
+    /// The ambient occlusion delta used for global background shading.
+    float sceneAmbientOcclusionDelta = 0.0f;
+
+    /// The ambient occlusion strength used for global background shading.
+    float sceneAmbientOcclusionStrength = 0.0f;
+
+    /// The number of anti-aliasing samples to compute.
+    float sceneAntiAliasingSamples = 0.0f;
+
+    /// The scene (space) background colour.
+    QColor sceneBackgroundColor;
+
+    /// Determines whether scene diffuse lighting is enabled.
+    bool sceneDiffuseLighting = false;
+
+    /// Determines whether scene filtering is enabled.
+    bool sceneFiltering = false;
+
+    /// The scene focal distance, which is the angle of view.
+    float sceneFocalDistance = 0.0f;
+
+    /// Determines whether scene fog is enabled.
+    bool sceneFog = false;
+
+    /// The size in pixels of the smallest fractal detail rendered, or 0 to render full detail everywhere.
+    float sceneLevelOfDetail = 0.0f;
+
+    /// The colour of the scene light source.
+    QColor sceneLightColor;
+
+    /// The direction of the scene light source.
+    QVector3D sceneLightDirection;
+
+    /// The number of shadow and ambient occlusion rays sampled per pixel per frame in sampled lighting mode.
+    float sceneLightingSamples = 2.0f;
+
+    /// Determines whether shadows and ambient occlusion are sampled with rays and accumulated over several frames.
+    bool sceneSampledLighting = false;
+
+    /// Determines whether the scene shadows are enabled.
+    bool sceneShadows = false;
+
+    /// The scene shadow darkness in range [0, inf)
+    float sceneShadowDarkness = 0.0f;
+
+    /// The scene shadow sharpness in range [0, inf)
+    float sceneShadowSharpness = 0.0f;
+
+    /// The scene specular highlight amount.
+    float sceneSpecularHighlight = 0.0f;
+
+    /// The scene specular highlight multiplier.
+    float sceneSpecularMultiplier = 0.0f;
+
+    /// The animation keyframe image output resolution.
+    QVector2D outputResolution;
+
+    /// The animation frames per second (FPS) target.
+    float outputTargetFPS = 0.0f;
+
+    /// The duration of the current animation defined by the set of waypoints recorded.
+    float outputTargetDuration = 0.0f;
+
+    /// The output directory where keyframe images will be saved.
+    QString outputDirectory;
+
+    /// The name of the format keyframe images are saved in, see `FrameWriter::getFormatName`.
+    QString outputFormat = "png8";
+
+    /// The number of sub-frames blended into every keyframe image.
+    float outputMotionBlurSamples = 1.0f;
+
+    /// The fraction of the time between two keyframes during which the shutter is open.
+    float outputShutter = 0.5f;
+
+    /// Determines whether animations move the camera in proportion to its distance to the fractal.
+    bool outputAdaptiveSpeed = false;
+
+    /// Determines whether keyframe images are saved along with their render passes.
+    bool outputRenderPasses = false;
+
+    /// The list of position waypoints.
+    QList<QVector3D> positionWaypoints;
+
+    /// The list of rotation waypoints.
+    QList<QVector3D> rotationWaypoints;
+};
+
+QDataStream& operator<<(QDataStream& stream, const Scene& scene);
+QDataStream& operator>>(QDataStream& stream, Scene& scene);
+
+#endif // SCENE_H
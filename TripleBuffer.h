@@ -0,0 +1,84 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+/// \brief
+///     A lock-free single producer, single consumer triple buffer. The producer always owns one buffer which it can
+///     freely write to and publish, the consumer always owns one buffer which it can freely read from, and the third
+///     buffer holds the most recently published value. Neither side ever waits for the other, and the consumer always
+///     sees the latest complete value published by the producer. Intermediate values published faster than the
+///     consumer reads them are dropped.
+template <typename T>
+class TripleBuffer
+{
+public:
+
+    /// \brief
+    ///     Gets the buffer owned by the producer. Must only be called from the producer thread.
+    T& getWriteBuffer()
+    {
+        return buffers[writeIndex];
+    }
+
+    /// \brief
+    ///     Publishes the buffer owned by the producer and hands the producer a different buffer to write to. Must
+    ///     only be called from the producer thread.
+    void publish()
+    {
+        auto previous = middleIndex.exchange(static_cast<uint8_t>(writeIndex | DIRTY_BIT), std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    /// \brief
+    ///     Swaps the most recently published buffer, if any, into the consumer. Must only be called from the
+    ///     consumer thread.
+    /// \return
+    ///     true if a new buffer was published since the last update; false otherwise.
+    bool update()
+    {
+        if ((middleIndex.load(std::memory_order_relaxed) & DIRTY_BIT) == 0) {
+            return false;
+        }
+
+        auto previous = middleIndex.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+
+        return true;
+    }
+
+    /// \brief
+    ///     Gets the buffer owned by the consumer. Must only be called from the consumer thread.
+    T& getReadBuffer()
+    {
+        return buffers[readIndex];
+    }
+
+    /// \brief
+    ///     Gets all three buffers irrespective of ownership. Must only be used once neither side is active, e.g.
+    ///     to release resources held by the buffers.
+    T* getAllBuffers()
+    {
+        return buffers;
+    }
+
+private:
+
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t DIRTY_BIT = 0x04;
+
+    /// The three buffers.
+    T buffers[3] = {};
+
+    /// Index of the buffer owned by the producer.
+    uint8_t writeIndex = 0;
+
+    /// Index of the most recently published buffer, along with a dirty bit set if the consumer has not yet seen it.
+    std::atomic<uint8_t> middleIndex { 1 };
+
+    /// Index of the buffer owned by the consumer.
+    uint8_t readIndex = 2;
+};
+
+#endif // TRIPLEBUFFER_H
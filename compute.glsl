@@ -0,0 +1,171 @@
+#version 430
+
+// Marches the fractal in a compute shader instead of drawing it with the fragment shader, which is spliced in below
+// without its main function. Every work group marches tiles of TILE_SIZE by TILE_SIZE pixels, one pixel per
+// invocation, and writes them straight into the frame.
+//
+// Work groups are persistent: only as many of them are dispatched as the GPU runs at once, and every group keeps taking
+// the next tile from a queue shared by all groups until the frame is done. Tiles of empty space march a handful of
+// steps while tiles on the fractal march hundreds, so groups which finish their tiles early take more of them instead
+// of idling while a fixed partition of the frame is still being marched by the other groups.
+//
+// Before marching the rays of a tile, one invocation marches a cone which encloses all of them and shares the result
+// with the whole group. If the cone gets past the far plane without ever coming close to the fractal, no ray of the
+// tile can hit it, and the whole tile writes the background without marching a single ray.
+
+#define COMPUTE_SHADER
+
+// Matches FractalRenderer::COMPUTE_TILE_SIZE
+#define TILE_SIZE 8
+
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+// The index of the next tile to be marched, reset to 0 before every frame
+layout(std430, binding = 0) buffer TileQueue {
+    uint nextTile;
+};
+
+// The frame and the statistics of the heatmap are blended into what they held before by the weight of the frame,
+// exactly like the fragment shader blends them
+layout(binding = 0) writeonly uniform image2D out_frame;
+layout(binding = 1) writeonly uniform image2D out_statistics;
+
+uniform sampler2D in_previous_frame;
+uniform sampler2D in_previous_statistics;
+uniform float in_weight;
+
+// Determines whether the statistics of the heatmap are recorded
+uniform bool in_statistics;
+
+// The tile the work group is marching
+shared uint tile;
+
+// The number of steps the cone of the tile took to get past the far plane, or -1 if its rays may hit the fractal
+shared float tileSteps;
+
+#include "frag.glsl"
+
+// Marches a cone from the camera which encloses the rays through every pixel of the tile at the specified origin,
+// widened by a pixel on every side for the pixel offset and the anti-aliasing samples. Every step is as long as the
+// distance estimate allows without any ray inside the cone getting closer to the surface than it may get before it
+// counts as a hit. Rays check for a hit once more after they passed the far plane, so the cone continues a little
+// further. Gets the number of steps taken if the cone got past the far plane, or -1 if some ray of the tile may hit.
+float marchTileCone(vec2 origin) {
+    vec3 axis = cameraRay(origin + float(TILE_SIZE) * 0.5).xyz;
+    float cosMax = 1.0;
+
+    // The rays through the corners of the tile are the furthest from its centre
+    for (int k = 0; k < 4; ++k) {
+        vec2 corner = origin - 1.0 + vec2(k & 1, k >> 1) * float(TILE_SIZE + 2);
+        cosMax = min(cosMax, dot(axis, cameraRay(corner).xyz));
+    }
+
+    // The radius of the cone per unit of distance along its axis
+    float spread = sqrt(max(1.0 - cosMax * cosMax, 0.0)) / cosMax;
+    float pixel = 1.0 / in_resolution.x;
+
+    vec4 p = vec4(in_camera_position, 1.0);
+    vec3 pLow = in_camera_position_low;
+    float t = 0.0;
+
+    for (float s = 0.0; s < MAX_MARCHES; s += 1.0) {
+        float d = fractalDistanceEstimate(p, pLow, levelOfDetail(t));
+
+        // The distance to the furthest ray of the cone plus the minimum distance of that ray, which measures its
+        // length rather than the distance along the axis
+        float margin = spread * t + (1.0 + spread) * pixel * t + in_scene_min_distance;
+
+        if (d < margin) {
+            return -1.0;
+        } else if (t > 2.0 * MAX_DIST) {
+            return s;
+        }
+
+        float delta = (d - margin) / ((1.0 + spread) * (1.0 + pixel));
+        t += delta;
+        advance(p, pLow, axis * delta);
+    }
+
+    return -1.0;
+}
+
+// Marches the pixel, unless the cone of its tile already missed, and blends it into the frame
+void marchPixel(ivec2 pixel) {
+    pixelPosition = vec2(pixel) + 0.5;
+
+    vec4 colour;
+    vec4 statistics = vec4(0.0);
+
+    if (tileSteps < 0.0) {
+        vec4 geometry;
+        vec4 material;
+        vec2 cost;
+
+        colour = uniformPixel(geometry, material, cost, statistics);
+    } else {
+        // Every sample of the pixel misses, and only the steps of the cone were taken for them
+        float samples = in_scene_anti_aliasing_samples * in_scene_anti_aliasing_samples;
+        colour = vec4(in_scene_background_color, 1.0);
+
+        if (in_scene_heatmap != HEATMAP_NONE) {
+            colour.xyz = heatmap(in_scene_heatmap == HEATMAP_MARCH_STEPS ? tileSteps : 0.0) * 0.25;
+        }
+
+        statistics = vec4(tileSteps * samples, 0.0, samples, 0.0);
+    }
+
+    colour = vec4(colour.xyz, 1.0);
+
+    if (in_weight < 1.0) {
+        colour = mix(texelFetch(in_previous_frame, pixel, 0), colour, in_weight);
+    }
+
+    imageStore(out_frame, pixel, colour);
+
+    if (in_statistics) {
+        if (in_weight < 1.0) {
+            statistics = mix(texelFetch(in_previous_statistics, pixel, 0), statistics, in_weight);
+        }
+
+        imageStore(out_statistics, pixel, statistics);
+    }
+}
+
+void main() {
+    uvec2 tiles = (uvec2(in_resolution) + uint(TILE_SIZE - 1)) / uint(TILE_SIZE);
+    uint tileCount = tiles.x * tiles.y;
+
+    // Every invocation reads the same tile from shared memory, so the whole group leaves the loop together
+    for (;;) {
+        if (gl_LocalInvocationIndex == 0u) {
+            tile = atomicAdd(nextTile, 1u);
+        }
+
+        memoryBarrierShared();
+        barrier();
+
+        uint currentTile = tile;
+
+        if (currentTile >= tileCount) {
+            break;
+        }
+
+        vec2 origin = vec2(currentTile % tiles.x, currentTile / tiles.x) * float(TILE_SIZE);
+
+        if (gl_LocalInvocationIndex == 0u) {
+            tileSteps = marchTileCone(origin);
+        }
+
+        memoryBarrierShared();
+        barrier();
+
+        ivec2 pixel = ivec2(origin) + ivec2(gl_LocalInvocationID.xy);
+
+        if (pixel.x < int(in_resolution.x) && pixel.y < int(in_resolution.y)) {
+            marchPixel(pixel);
+        }
+
+        // The shared variables of this tile must not be overwritten until every invocation is done with them
+        barrier();
+    }
+}
@@ -10,19 +10,56 @@
 
 #version 120
 
-#define MIN_DIST 1e-5
 #define MAX_DIST 30.0
 #define MAX_MARCHES 1000
 #define MAX_ITERATIONS 16
+#define MAX_LIGHTING_SAMPLES 16
+#define PI 3.14159265359
+
+// Matches FractalRenderer::BLUE_NOISE_SIZE
+#define BLUE_NOISE_SIZE 64.0
+
+// The maximum length of ambient occlusion rays in units of the minimum distance
+#define AMBIENT_OCCLUSION_RADIUS 10000.0
+
+// Adaptive anti-aliasing refines a pixel if, compared to any of its neighbours, the relative difference in depth, the
+// cosine of the angle between the normals, or the difference in luminance crosses these thresholds
+#define EDGE_DEPTH_THRESHOLD 0.1
+#define EDGE_NORMAL_THRESHOLD 0.9
+#define EDGE_LUMINANCE_THRESHOLD 0.05
+
+// Matches FractalRenderer::AntiAliasingPass
+#define ANTI_ALIASING_UNIFORM 0
+#define ANTI_ALIASING_DETECT 1
+#define ANTI_ALIASING_REFINE 2
+
+// Matches FractalRenderer::Heatmap
+#define HEATMAP_NONE 0
+#define HEATMAP_MARCH_STEPS 1
+#define HEATMAP_SHADOW_STEPS 2
+
+// The centre of the pixel being drawn in pixels from the bottom left corner of the frame. The compute shader, which
+// splices in this file without its main function, has no fragment coordinate and sets it for every pixel it marches.
+#ifdef COMPUTE_SHADER
+vec2 pixelPosition;
+#else
+#define pixelPosition gl_FragCoord.xy
+#endif
 
 uniform vec3 in_camera_position;
+uniform vec3 in_camera_position_low;
 uniform mat3 in_camera_rotation;
 
+uniform bool in_deep_zoom;
+uniform int in_deep_zoom_iterations;
+
 uniform float in_fractal_scale;
+uniform float in_fractal_inverse_log_scale;
 uniform vec3 in_fractal_shift;
-uniform vec3 in_fractal_rotation;
+// The cosine and sine of the fractal rotation about the X and Z axes
+uniform vec2 in_fractal_rotation_x;
+uniform vec2 in_fractal_rotation_z;
 uniform vec3 in_fractal_color;
-uniform float in_fractal_exposure;
 
 uniform float in_scene_ambient_occlusion_delta;
 uniform float in_scene_ambient_occlusion_strength;
@@ -32,82 +69,192 @@ uniform bool in_scene_diffuse_lighting;
 uniform bool in_scene_filtering;
 uniform float in_scene_focal_distance;
 uniform bool in_scene_fog;
+uniform float in_scene_level_of_detail;
+uniform float in_scene_min_distance;
 uniform vec3 in_scene_light_color;
 uniform vec3 in_scene_light_direction;
+uniform float in_scene_lighting_samples;
+uniform bool in_scene_sampled_lighting;
 uniform bool in_scene_shadows;
 uniform float in_scene_shadow_darkness;
 uniform float in_scene_shadow_sharpness;
 uniform float in_scene_specular_highlight;
 uniform float in_scene_specular_multiplier;
 
+uniform int in_scene_heatmap;
+
 uniform vec2 in_resolution;
+// The offset in pixels of every sample, which differs between sub-frames blended for motion blur
+uniform vec2 in_pixel_offset;
 
-void mengerFold(inout vec4 p) {
-    float dxy = min(p.x - p.y, 0.0);
-    p += vec4(-dxy, +dxy, 0.0, 0.0);
-    float dxz = min(p.x - p.z, 0.0);
-    p += vec4(-dxz, 0.0, +dxz, 0.0);
-    float dyz = min(p.y - p.z, 0.0);
-    p += vec4(0.0, -dyz, +dyz, 0.0);
-}
+uniform sampler2D in_blue_noise;
+uniform float in_frame_index;
+
+uniform int in_anti_aliasing_pass;
+// The colour, the geometry, the material and the cost of the centre sample of every pixel, from the detection pass
+uniform sampler2D in_first_pass_colour;
+uniform sampler2D in_first_pass_geometry;
+uniform sampler2D in_first_pass_material;
+uniform sampler2D in_first_pass_cost;
 
-void rotateX(inout vec4 p, float a) {
-    float s = sin(a);
-    float c = cos(a);
+void rotateX(inout vec4 p, vec2 cs) {
+    float c = cs.x;
+    float s = cs.y;
 
     p.yz = vec2(c * p.y + s * p.z, c * p.z - s * p.y);
 }
 
-void rotateZ(inout vec4 p, float a) {
-    float s = sin(a);
-    float c = cos(a);
+void rotateZ(inout vec4 p, vec2 cs) {
+    float c = cs.x;
+    float s = cs.y;
 
     p.xy = vec2(c * p.x + s * p.y, c * p.y - s * p.x);
 }
 
-float fractalDistanceEstimate(vec4 p) {
-    for (int i = 0; i < MAX_ITERATIONS; ++i) {
-        p = abs(p);
-        rotateZ(p, in_fractal_rotation.z);
-        mengerFold(p);
-        rotateX(p, in_fractal_rotation.x);
+// Double-float arithmetic represents a value as the unevaluated sum of a high and a low float which gives roughly twice
+// the precision of a float. The error terms rely on exact IEEE float rounding, so none of these expressions may be
+// reassociated or simplified.
+vec3 dfQuickTwoSum(vec3 a, vec3 b, out vec3 e) {
+    vec3 s = a + b;
+    e = b - (s - a);
+    return s;
+}
 
-        p *= vec4(in_fractal_scale);
-        p += vec4(in_fractal_shift, 0.0);
-    }
+vec3 dfTwoSum(vec3 a, vec3 b, out vec3 e) {
+    vec3 s = a + b;
+    vec3 v = s - a;
+    e = (a - (s - v)) + (b - v);
+    return s;
+}
+
+vec3 dfTwoProduct(vec3 a, float b, out vec3 e) {
+    vec3 p = a * b;
+
+    // Dekker split of both operands into 12-bit halves whose products are exact
+    vec3 ca = 4097.0 * a;
+    vec3 ah = ca - (ca - a);
+    vec3 al = a - ah;
+    float cb = 4097.0 * b;
+    float bh = cb - (cb - b);
+    float bl = b - bh;
+
+    e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+    return p;
+}
+
+void dfAdd(inout vec3 hi, inout vec3 lo, vec3 bHi, vec3 bLo) {
+    vec3 e;
+    vec3 s = dfTwoSum(hi, bHi, e);
+    e += lo + bLo;
+    hi = dfQuickTwoSum(s, e, lo);
+}
+
+void dfMul(inout vec3 hi, inout vec3 lo, float b) {
+    vec3 e;
+    vec3 p = dfTwoProduct(hi, b, e);
+    e += lo * b;
+    hi = dfQuickTwoSum(p, e, lo);
+}
+
+void dfAbs(inout vec3 hi, inout vec3 lo) {
+    vec3 m = vec3(1.0) - 2.0 * vec3(lessThan(hi, vec3(0.0)));
+    hi *= m;
+    lo *= m;
+}
+
+bool dfLess(float aHi, float aLo, float bHi, float bLo) {
+    return aHi < bHi || (aHi == bHi && aLo < bLo);
+}
+
+void dfRotateX(inout vec3 hi, inout vec3 lo, vec2 cs) {
+    float c = cs.x;
+    float s = cs.y;
 
-    vec3 a = abs(p.xyz) - 6.0;
+    // Computes (y, z) = (c * y + s * z, c * z - s * y) for both components at once
+    vec3 aHi = hi;
+    vec3 aLo = lo;
+    dfMul(aHi, aLo, c);
 
-    // Distance estimate to a 6.0 box
-    return (min(max(max(a.x, a.y), a.z), 0.0) + length(max(a, 0.0))) / p.w;
+    vec3 bHi = hi.xzy;
+    vec3 bLo = lo.xzy;
+    dfMul(bHi, bLo, s);
+
+    const vec3 signs = vec3(0.0, 1.0, -1.0);
+    dfAdd(aHi, aLo, bHi * signs, bLo * signs);
+
+    hi.yz = aHi.yz;
+    lo.yz = aLo.yz;
 }
 
-vec4 fractalColour(vec4 p) {
-    vec3 orbit = vec3(0.0);
-    for (int i = 0; i < MAX_ITERATIONS; ++i) {
-        p = abs(p);
-        rotateZ(p, in_fractal_rotation.z);
-        mengerFold(p);
-        rotateX(p, in_fractal_rotation.x);
+void dfRotateZ(inout vec3 hi, inout vec3 lo, vec2 cs) {
+    float c = cs.x;
+    float s = cs.y;
+
+    // Computes (x, y) = (c * x + s * y, c * y - s * x) for both components at once
+    vec3 aHi = hi;
+    vec3 aLo = lo;
+    dfMul(aHi, aLo, c);
+
+    vec3 bHi = hi.yxz;
+    vec3 bLo = lo.yxz;
+    dfMul(bHi, bLo, s);
 
-        p *= vec4(in_fractal_scale);
-        p += vec4(in_fractal_shift, 0.0);
+    const vec3 signs = vec3(1.0, -1.0, 0.0);
+    dfAdd(aHi, aLo, bHi * signs, bLo * signs);
 
-        orbit = max(orbit, p.xyz * in_fractal_color);
+    hi.xy = aHi.xy;
+    lo.xy = aLo.xy;
+}
+
+// Moves the point `p + pLow` by `delta`. In deep zoom mode the sum is kept in double-float precision so that steps
+// much smaller than the float precision of the point still accumulate.
+void advance(inout vec4 p, inout vec3 pLow, vec3 delta) {
+    if (in_deep_zoom) {
+        vec3 hi = p.xyz;
+        dfAdd(hi, pLow, delta, vec3(0.0));
+        p.xyz = hi;
+    } else {
+        p.xyz += delta;
+    }
+}
+
+// Gets the number of fractal iterations worth computing at distance t from the camera. After i iterations the detail
+// being resolved is roughly 6 / scale^i in size, so iterations resolving detail smaller than the pixel footprint are
+// invisible and skipped. The result is fractional so the distance estimate can blend between iteration counts.
+float levelOfDetail(float t) {
+    if (in_scene_level_of_detail <= 0.0) {
+        return float(MAX_ITERATIONS);
     }
 
-    return vec4(orbit, 0.0);
+    float footprint = max(1.0 / in_resolution.x * t, in_scene_min_distance) * in_scene_level_of_detail;
+    return clamp(log(6.0 / footprint) * in_fractal_inverse_log_scale, 1.0, float(MAX_ITERATIONS));
 }
 
-vec4 rayMarch(inout vec4 p, vec4 ray, float sharpness) {
-    float d = fractalDistanceEstimate(p);
+// The fractal module selected by the renderer is spliced in here. Every module defines
+//
+//     vec4 fractalDistanceColour(vec4 p, vec3 pLow, float iterations)
+//         The orbit trap colour of the fractal in RGB and the distance to the fractal surface in W at the point
+//         p.xyz + pLow, using the specified, possibly fractional, number of iterations. p.w is 1.0.
+//
+// and may use any of the uniforms and functions defined above. Both results come out of a single iteration loop so
+// shading a hit never runs the fractal iterations twice for the same point.
+#include "fractal"
+
+// The ray marcher only needs the distance. The orbit trap is then unused and left for the compiler to eliminate.
+float fractalDistanceEstimate(vec4 p, vec3 pLow, float iterations) {
+    return fractalDistanceColour(p, pLow, iterations).w;
+}
+
+// Marches a ray starting at distance t0 from the camera
+vec4 rayMarch(inout vec4 p, inout vec3 pLow, vec4 ray, float sharpness, float t0) {
+    float d = fractalDistanceEstimate(p, pLow, levelOfDetail(t0));
     float s = 0.0;
     float t = 0.0;
     float m = 1.0;
 
     for (; s < MAX_MARCHES; s += 1.0) {
         // If the distance from the surface is less than the distance per pixel we stop
-        float minDistance = max(1.0 / in_resolution.x * t, MIN_DIST);
+        float minDistance = max(1.0 / in_resolution.x * t, in_scene_min_distance);
 
         if (d < minDistance) {
             s += d / minDistance;
@@ -117,66 +264,181 @@ vec4 rayMarch(inout vec4 p, vec4 ray, float sharpness) {
         }
 
         t += d;
-        p += ray * d;
+        advance(p, pLow, ray.xyz * d);
         m = min(m, sharpness * d / t);
-        d = fractalDistanceEstimate(p);
+        d = fractalDistanceEstimate(p, pLow, levelOfDetail(t0 + t));
     }
 
     return vec4(d, s, t, m);
 }
 
-vec4 scene(vec4 p, vec4 ray) {
+// Marches a ray starting at distance t0 from the camera and determines whether it hits the fractal within maxDistance.
+// The number of march steps taken is added to steps.
+bool occluded(vec4 p, vec3 pLow, vec3 ray, float t0, float maxDistance, inout float steps) {
+    float t = 0.0;
+
+    for (int i = 0; i < MAX_MARCHES; ++i) {
+        float d = fractalDistanceEstimate(p, pLow, levelOfDetail(t0 + t));
+        steps += 1.0;
+
+        if (d < max(1.0 / in_resolution.x * t, in_scene_min_distance)) {
+            return true;
+        }
+
+        t += d;
+
+        if (t > maxDistance) {
+            return false;
+        }
+
+        advance(p, pLow, ray * d);
+    }
+
+    return false;
+}
+
+// Gets the i-th random point in [0, 1)^2 of this pixel in this frame. Neighbouring pixels start from neighbouring
+// values of the blue noise texture and every pixel steps through the R2 low-discrepancy sequence across samples and
+// frames, which spreads the noise of sampling evenly across the image and over time.
+vec2 lightingSample(int i) {
+    vec2 noise = vec2(texture2D(in_blue_noise, pixelPosition / BLUE_NOISE_SIZE).r,
+                      texture2D(in_blue_noise, (pixelPosition + vec2(17.0, 41.0)) / BLUE_NOISE_SIZE).r);
+
+    float index = in_frame_index * 2.0 * in_scene_lighting_samples + float(i);
+    return fract(noise + index * vec2(0.7548776662, 0.5698402910));
+}
+
+// Rotates the unit Z axis onto the unit vector z
+mat3 basis(vec3 z) {
+    vec3 up = abs(z.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);
+    vec3 x = normalize(cross(up, z));
+    return mat3(x, cross(z, x), z);
+}
+
+// Uniformly samples a direction within the cone around the unit vector axis
+vec3 sampleCone(vec3 axis, float cosMax, vec2 u) {
+    float cosTheta = mix(1.0, cosMax, u.x);
+    float sinTheta = sqrt(max(1.0 - cosTheta * cosTheta, 0.0));
+    float phi = 2.0 * PI * u.y;
+
+    return basis(axis) * vec3(cos(phi) * sinTheta, sin(phi) * sinTheta, cosTheta);
+}
+
+// Samples a direction in the hemisphere around the unit vector n with a cosine weighted distribution
+vec3 sampleHemisphere(vec3 n, vec2 u) {
+    float r = sqrt(u.x);
+    float phi = 2.0 * PI * u.y;
+
+    return basis(n) * vec3(r * cos(phi), r * sin(phi), sqrt(max(1.0 - u.x, 0.0)));
+}
+
+// Estimates the fraction of the light source visible from the surface point, and the fraction of the hemisphere around
+// the surface normal which is not occluded, by marching a few rays in each. The rays differ per pixel and per frame so
+// accumulating frames converges to the exact soft shadow and ambient occlusion. Counts the march steps of the rays.
+void sampleLighting(vec4 p, vec3 pLow, vec3 n, float t, out float shadow, out float occlusion, out float steps) {
+    advance(p, pLow, n * in_scene_min_distance * 100.0);
+
+    // The penumbra of the approximate soft shadows is 1 / sharpness radians wide, so the light source gets the same
+    // angular radius
+    float penumbra = 1.0 / max(in_scene_shadow_sharpness, 1e-3);
+    float cosLightRadius = inversesqrt(1.0 + penumbra * penumbra);
+
+    float samples = max(in_scene_lighting_samples, 1.0);
+    float visible = 0.0;
+    float unoccluded = 0.0;
+    steps = 0.0;
+
+    for (int i = 0; i < MAX_LIGHTING_SAMPLES; ++i) {
+        if (float(i) >= samples) {
+            break;
+        }
+
+        if (in_scene_shadows) {
+            vec3 lightRay = sampleCone(in_scene_light_direction, cosLightRadius, lightingSample(2 * i));
+            visible += occluded(p, pLow, lightRay, t, MAX_DIST, steps) ? 0.0 : 1.0;
+        }
+
+        vec3 occlusionRay = sampleHemisphere(n, lightingSample(2 * i + 1));
+        float occlusionDistance = in_scene_min_distance * AMBIENT_OCCLUSION_RADIUS;
+        unoccluded += occluded(p, pLow, occlusionRay, t, occlusionDistance, steps) ? 0.0 : 1.0;
+    }
+
+    shadow = in_scene_shadows ? visible / samples : 1.0;
+    occlusion = unoccluded / samples;
+}
+
+// Maps a number of march steps to a colour ramp from blue through green and yellow to red. The ramp is logarithmic so
+// that cheap rays are told apart as well as expensive ones, on the same scale as the bins of HeatmapStatistics.
+vec3 heatmap(float steps) {
+    float x = clamp(log2(1.0 + steps) / log2(1.0 + float(MAX_MARCHES)), 0.0, 1.0);
+    return clamp(vec3(1.5 - abs(4.0 * x - 3.0), 1.5 - abs(4.0 * x - 2.0), 1.5 - abs(4.0 * x - 1.0)), 0.0, 1.0);
+}
+
+// Computes the colour seen along the ray, along with the surface normal in XYZ and the distance to the surface in W of
+// the geometry, or a negative distance if the ray missed the fractal. The material holds the orbit trap colour of the
+// surface before lighting in XYZ and the shadow factor in W. The cost holds the number of march steps taken by the ray
+// in X and by the shadow and lighting rays in Y.
+vec4 scene(vec4 p, vec3 pLow, vec4 ray, out vec4 geometry, out vec4 material, out vec2 cost) {
     vec4 colour = vec4(0.0);
+    geometry = vec4(0.0, 0.0, 0.0, -1.0);
+    material = vec4(0.0, 0.0, 0.0, 1.0);
+    float shadowSteps = 0.0;
 
-    vec4 dstm = rayMarch(p, ray, 1.0f);
+    vec4 dstm = rayMarch(p, pLow, ray, 1.0f, 0.0);
 
     float d = dstm.x;
     float s = dstm.y;
     float t = dstm.z;
 
-    float minDistance = max(1.0 / in_resolution.x * t, MIN_DIST);
+    float minDistance = max(1.0 / in_resolution.x * t, in_scene_min_distance);
     if (d < minDistance) {
-        // Calculate the surfrance normal
+        // Calculate the surfrance normal from four taps at the vertices of a tetrahedron. The offsets are applied to
+        // the low part of the point so that they are not lost to rounding in deep zoom mode.
         // http://www.iquilezles.org/www/articles/normalsSDF/normalsSDF.htm
         const vec3 h = vec3(1.0, -1.0, 0.0);
-        vec3 n = normalize(h.xyy * fractalDistanceEstimate(p + h.xyyz * minDistance) +
-                           h.yyx * fractalDistanceEstimate(p + h.yyxz * minDistance) +
-                           h.yxy * fractalDistanceEstimate(p + h.yxyz * minDistance) +
-                           h.xxx * fractalDistanceEstimate(p + h.xxxz * minDistance));
+        float lod = levelOfDetail(t);
+        vec4 tap0 = fractalDistanceColour(p, pLow + h.xyy * minDistance, lod);
+        vec4 tap1 = fractalDistanceColour(p, pLow + h.yyx * minDistance, lod);
+        vec4 tap2 = fractalDistanceColour(p, pLow + h.yxy * minDistance, lod);
+        vec4 tap3 = fractalDistanceColour(p, pLow + h.xxx * minDistance, lod);
+        vec3 n = normalize(h.xyy * tap0.w + h.yyx * tap1.w + h.yxy * tap2.w + h.xxx * tap3.w);
+        geometry = vec4(n, t);
 
         // Find closest surface point because without this we get weird colouring artifacts
-        p.xyz -= n * d;
+        advance(p, pLow, -n * d);
 
         if (in_scene_filtering) {
-            // Cross product between the ray and the surface normal, should be parallel to the surface
-            vec3 s1 = normalize(cross(ray.xyz, n));
-
-            // Cross product between s1 and the surface normal
-            vec3 s2 = cross(s1, n);
-
-            // Find the average color of the fractal in a radius dx in plane s1 - s2
-            colour = (fractalColour(p + vec4(s1, 0.0) * minDistance) +
-                      fractalColour(p - vec4(s1, 0.0) * minDistance) +
-                      fractalColour(p + vec4(s2, 0.0) * minDistance) +
-                      fractalColour(p - vec4(s2, 0.0) * minDistance)) / 4;
+            // The taps surround the surface point within a radius of the pixel footprint, so the average of their
+            // orbit trap colours filters the colour for free
+            colour.xyz = (tap0.xyz + tap1.xyz + tap2.xyz + tap3.xyz) / 4.0;
         } else {
-            colour = fractalColour(p);
+            colour.xyz = fractalDistanceColour(p, pLow, lod).xyz;
         }
 
         colour = clamp(colour, 0.0, 1.0);
+        material.xyz = colour.xyz;
 
         // Shadow scaling factor
         float shadow = 1.0;
 
-        if (in_scene_shadows) {
-            vec4 lightPoint = vec4(p.xyz + n * MIN_DIST * 100, p.w);
+        // Fraction of the hemisphere around the surface normal which is not occluded, only used by sampled lighting
+        float occlusion = 1.0;
+
+        if (in_scene_sampled_lighting) {
+            sampleLighting(p, pLow, n, t, shadow, occlusion, shadowSteps);
+        } else if (in_scene_shadows) {
+            vec4 lightPoint = p;
+            vec3 lightPointLow = pLow;
+            advance(lightPoint, lightPointLow, n * in_scene_min_distance * 100);
 
             // March a ray from the surface normal towards to light source and check if we hit it via the minimum distance
-            dstm = rayMarch(lightPoint, vec4(in_scene_light_direction, 0.0), in_scene_shadow_sharpness);
+            vec4 lightRay = vec4(in_scene_light_direction, 0.0);
+            dstm = rayMarch(lightPoint, lightPointLow, lightRay, in_scene_shadow_sharpness, t);
 
             float lt = dstm.z;
             float lm = dstm.w;
             shadow = lm * min(lt, 1.0);
+            shadowSteps = dstm.y;
         }
 
         if (in_scene_specular_highlight > 0) {
@@ -192,16 +454,22 @@ vec4 scene(vec4 p, vec4 ray) {
 
         // Don't make shadows entirely dark
         shadow = max(shadow, 1.0 - in_scene_shadow_darkness);
+        material.w = shadow;
 
         // Actually apply the shadow
         colour.xyz *= in_scene_light_color * shadow;
 
-        // Add small amount of ambient occlusion
-        float a = 1.0 / (1.0 + s * in_scene_ambient_occlusion_strength);
-        colour.xyz += (1.0 - a) * vec3(in_scene_ambient_occlusion_delta);
+        if (in_scene_sampled_lighting) {
+            // Darken the surface by the occluded fraction of the hemisphere around it
+            colour.xyz *= mix(1.0, occlusion, in_scene_ambient_occlusion_delta);
+        } else {
+            // Add small amount of ambient occlusion
+            float a = 1.0 / (1.0 + s * in_scene_ambient_occlusion_strength);
+            colour.xyz += (1.0 - a) * vec3(in_scene_ambient_occlusion_delta);
+        }
 
         if (in_scene_fog) {
-            a = t / MAX_DIST;
+            float a = t / MAX_DIST;
             colour.xyz = (1.0 - a) * colour.xyz + a * in_scene_background_color;
         }
     } else {
@@ -209,31 +477,189 @@ vec4 scene(vec4 p, vec4 ray) {
         colour.xyz = in_scene_background_color;
     }
 
+    cost = vec2(s, shadowSteps);
+
+    if (in_scene_heatmap != HEATMAP_NONE) {
+        // Rays which missed the fractal are dimmed so the silhouette stays visible
+        colour.xyz = heatmap(in_scene_heatmap == HEATMAP_MARCH_STEPS ? s : shadowSteps);
+        colour.xyz *= geometry.w < 0.0 ? 0.25 : 1.0;
+    }
+
     return colour;
 }
 
-void main() {
+// Gets the ray from the camera through the specified position in pixels from the bottom left corner of the frame
+vec4 cameraRay(vec2 position) {
+    // Get normalized screen coordinate
+    vec2 screenPosition = (position + in_pixel_offset) / in_resolution.xy;
+
+    vec2 uv = 2.0 * screenPosition - 1;
+    uv.x *= in_resolution.x / in_resolution.y;
+
+    // Convert screen coordinate into a ray
+    return vec4(in_camera_rotation * normalize(vec3(uv.x, uv.y, -in_scene_focal_distance)), 0.0);
+}
+
+// Computes the colour of the sample at the specified offset in [0, 1)^2 from the bottom left corner of the pixel
+vec4 pixelSample(vec2 offset, out vec4 geometry, out vec4 material, out vec2 cost) {
+    vec4 ray = cameraRay(pixelPosition - 0.5 + offset);
+
+    // Reflect the light if the ray intersects the fractal
+    return scene(vec4(in_camera_position, 1.0), in_camera_position_low, ray, geometry, material, cost);
+}
+
+// Determines whether two neighbouring first pass samples lie on different sides of an edge
+bool isEdge(vec4 colour, vec4 geometry, vec4 neighbourColour, vec4 neighbourGeometry) {
+    if ((geometry.w < 0.0) != (neighbourGeometry.w < 0.0)) {
+        return true;
+    }
+
+    if (geometry.w >= 0.0) {
+        if (abs(geometry.w - neighbourGeometry.w) > EDGE_DEPTH_THRESHOLD * min(geometry.w, neighbourGeometry.w)) {
+            return true;
+        }
+
+        if (dot(geometry.xyz, neighbourGeometry.xyz) < EDGE_NORMAL_THRESHOLD) {
+            return true;
+        }
+    }
+
+    // Sampled lighting is noisy by design, which must not be mistaken for edges
+    if (in_scene_sampled_lighting) {
+        return false;
+    }
+
+    // Compared before exposure so that the frame drawn does not depend on it
+    const vec3 luminance = vec3(0.2126, 0.7152, 0.0722);
+    float a = dot(clamp(colour.xyz, 0.0, 1.0), luminance);
+    float b = dot(clamp(neighbourColour.xyz, 0.0, 1.0), luminance);
+
+    return abs(a - b) > EDGE_LUMINANCE_THRESHOLD;
+}
+
+// Gets the offset of the sample in row i and column j of the pixel. Samples lie in distinct cells of an n by n grid and
+// in distinct rows and columns of an n^2 by n^2 grid, like rotated grid supersampling, so near horizontal and vertical
+// edges get n^2 distinct coverage levels instead of n. In sampled lighting mode the pattern is shifted by a different
+// blue noise offset in every frame, so accumulating frames also accumulates the sample positions.
+vec2 refinementSample(float i, float j) {
+    float n = in_scene_anti_aliasing_samples;
+    vec2 offset = vec2(i + (j + 0.5) / n, j + (i + 0.5) / n) / n;
+
+    if (in_scene_sampled_lighting) {
+        vec2 noise = vec2(texture2D(in_blue_noise, (pixelPosition + vec2(29.0, 7.0)) / BLUE_NOISE_SIZE).r,
+                          texture2D(in_blue_noise, (pixelPosition + vec2(53.0, 23.0)) / BLUE_NOISE_SIZE).r);
+
+        offset = fract(offset + fract(noise + in_frame_index * vec2(0.7548776662, 0.5698402910)) / n);
+    }
+
+    return offset;
+}
+
+// Computes the colour of the pixel from all anti-aliasing samples on a regular grid. The geometry, the material and
+// the cost are those of the first sample, which lies at the centre of the pixel. The statistics of every sample are
+// added to statistics.
+vec4 uniformPixel(out vec4 geometry, out vec4 material, out vec2 cost, inout vec4 statistics) {
     vec4 colour = vec4(0.0);
 
+    // Additional samples only contribute their colour and their cost
+    vec4 sampleGeometry;
+    vec4 sampleMaterial;
+    vec2 sampleCost;
+
     for (int i = 0; i < in_scene_anti_aliasing_samples; ++i) {
         for (int j = 0; j < in_scene_anti_aliasing_samples; ++j) {
-            // Get normalized screen coordinate
-            vec2 aaDelta = vec2(i, j) / in_scene_anti_aliasing_samples;
-            vec2 screenPosition = (gl_FragCoord.xy + aaDelta) / in_resolution.xy;
+            colour += pixelSample(vec2(0.5) + vec2(i, j) / in_scene_anti_aliasing_samples, sampleGeometry,
+                                  sampleMaterial, sampleCost);
+            statistics += vec4(sampleCost, 1.0, sampleGeometry.w < 0.0 ? 0.0 : 1.0);
+
+            // The first sample lies at the centre of the pixel
+            if (i == 0 && j == 0) {
+                geometry = sampleGeometry;
+                material = sampleMaterial;
+                cost = sampleCost;
+            }
+        }
+    }
+
+    return colour / (in_scene_anti_aliasing_samples * in_scene_anti_aliasing_samples);
+}
+
+// The compute shader marches every pixel with its own main function instead
+#ifndef COMPUTE_SHADER
+
+// Writes the render passes of the sample at the centre of the pixel to the additional render targets, which are only
+// bound when keyframes are saved with render passes. The statistics of the heatmap sum up the march steps of the ray
+// and of the shadow and lighting rays, the number of samples and the number of hits over all samples traced for the
+// pixel, including the centre sample of the detection pass.
+void main() {
+    vec4 colour = vec4(0.0);
+    vec4 geometry;
+    vec4 material;
+    vec2 cost;
+
+    // Additional samples only contribute their colour and their cost
+    vec4 sampleGeometry;
+    vec4 sampleMaterial;
+    vec2 sampleCost;
+
+    if (in_anti_aliasing_pass == ANTI_ALIASING_DETECT) {
+        // Record a single sample at the centre of the pixel for the refinement pass to find edges in
+        colour = pixelSample(vec2(0.5), geometry, material, cost);
+
+        gl_FragData[0] = colour;
+        gl_FragData[1] = geometry;
+        gl_FragData[2] = material;
+        gl_FragData[3] = vec4(cost, 0.0, 0.0);
+        return;
+    }
 
-            vec2 uv = 2.0 * screenPosition - 1;
-            uv.x *= in_resolution.x / in_resolution.y;
+    float samples = in_scene_anti_aliasing_samples * in_scene_anti_aliasing_samples;
+    vec4 statistics = vec4(0.0);
 
-            // Convert screen coordinate into a ray
-            vec4 ray = vec4(in_camera_rotation * normalize(vec3(uv.x, uv.y, -in_scene_focal_distance)), 0.0);
+    if (in_anti_aliasing_pass == ANTI_ALIASING_REFINE) {
+        vec2 texel = 1.0 / in_resolution.xy;
+        vec2 position = gl_FragCoord.xy * texel;
 
-            // Reflect the light if the ray intersects the fractal
-            colour += scene(vec4(in_camera_position, 1.0), ray);
+        colour = texture2D(in_first_pass_colour, position);
+        geometry = texture2D(in_first_pass_geometry, position);
+        material = texture2D(in_first_pass_material, position);
+        cost = texture2D(in_first_pass_cost, position).xy;
+
+        statistics = vec4(cost, 1.0, geometry.w < 0.0 ? 0.0 : 1.0);
+
+        bool edge = false;
+
+        for (int k = 0; k < 4; ++k) {
+            vec2 neighbour = position + texel * (k < 2 ? vec2(k * 2 - 1, 0.0) : vec2(0.0, k * 2 - 5));
+            edge = edge || isEdge(colour, geometry, texture2D(in_first_pass_colour, neighbour),
+                                  texture2D(in_first_pass_geometry, neighbour));
         }
+
+        if (edge) {
+            for (int i = 0; i < in_scene_anti_aliasing_samples; ++i) {
+                for (int j = 0; j < in_scene_anti_aliasing_samples; ++j) {
+                    colour += pixelSample(refinementSample(float(i), float(j)), sampleGeometry, sampleMaterial,
+                                          sampleCost);
+                    statistics += vec4(sampleCost, 1.0, sampleGeometry.w < 0.0 ? 0.0 : 1.0);
+                }
+            }
+
+            // The centre sample of the first pass is averaged in with the refinement samples
+            colour /= samples + 1.0;
+        }
+    } else {
+        colour = uniformPixel(geometry, material, cost, statistics);
     }
 
-    // Apply exposure
-    colour *= in_fractal_exposure / (in_scene_anti_aliasing_samples * in_scene_anti_aliasing_samples);
+    // Exposure is applied by the tone mapping pass, which only has to rerun when it changes
+    gl_FragData[0] = vec4(colour.xyz, 1.0);
+
+    // The distance to the surface, the number of march steps and the shadow factor, the surface normal, and the orbit
+    // trap colour
+    gl_FragData[1] = vec4(geometry.w, cost.x, material.w, 1.0);
+    gl_FragData[2] = vec4(geometry.xyz, 1.0);
+    gl_FragData[3] = vec4(material.xyz, 1.0);
 
-    gl_FragColor = vec4(clamp(colour.xyz, 0.0, 1.0), 1.0);
+    gl_FragData[4] = statistics;
 }
+#endif
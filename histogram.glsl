@@ -0,0 +1,130 @@
+#version 120
+
+// Reduces the heatmap statistics of a frame, as drawn by the fractal shader, to a histogram in three passes. Every bin
+// counts the pixels whose march steps per sample fall into it in X and the pixels whose shadow and lighting steps per
+// sample fall into it in Y. The column after the last bin sums up the statistics of all pixels instead.
+//
+// The first pass is the only one which reads the statistics, and it reads every pixel exactly once. Every fragment bins
+// a segment of SEGMENT_LENGTH pixels of a row and writes the counts of all of its bins to four render targets, 16 bins
+// of one histogram per target, along with the sums of the statistics of the segment to a fifth target. The counts of a
+// segment never exceed its length, so every channel packs the counts of four bins as digits of base DIGIT_BASE, which
+// floats hold exactly. The second pass unpacks the segments of every row into one row of bins per row of the frame,
+// and the third pass sums up all rows into a single row.
+
+// Matches FractalRenderer::HistogramPass
+#define HISTOGRAM_SEGMENTS 0
+#define HISTOGRAM_ROWS 1
+#define HISTOGRAM_SUM 2
+
+// Matches MAX_MARCHES in frag.glsl
+#define MAX_MARCHES 1000.0
+
+// Matches FractalRenderer::HISTOGRAM_SEGMENT_LENGTH
+#define SEGMENT_LENGTH 63.0
+#define DIGIT_BASE 64.0
+
+// The statistics in the first pass, or the rows of the second pass in the third pass
+uniform sampler2D in_source;
+
+// The targets of the first pass, read by the second pass
+uniform sampler2D in_march_bins_low;
+uniform sampler2D in_march_bins_high;
+uniform sampler2D in_shadow_bins_low;
+uniform sampler2D in_shadow_bins_high;
+uniform sampler2D in_totals;
+
+uniform vec2 in_source_size;
+uniform int in_histogram_pass;
+uniform float in_bin_count;
+
+// Gets the bin of a number of march steps. Matches HeatmapStatistics::getBin.
+float getBin(float steps) {
+    return min(floor(log2(1.0 + steps) / log2(1.0 + MAX_MARCHES) * in_bin_count), in_bin_count - 1.0);
+}
+
+// Gets the channel which holds the count of a bin within the 16 bins of its target
+vec4 getChannel(float bin) {
+    return vec4(equal(vec4(floor(mod(bin, 16.0) / 4.0)), vec4(0.0, 1.0, 2.0, 3.0)));
+}
+
+// Gets the value of a single pixel counted in a bin within the channel holding it
+float getDigit(float bin) {
+    const vec4 digits = vec4(1.0, DIGIT_BASE, DIGIT_BASE * DIGIT_BASE, DIGIT_BASE * DIGIT_BASE * DIGIT_BASE);
+    return dot(vec4(equal(vec4(mod(bin, 4.0)), vec4(0.0, 1.0, 2.0, 3.0))), digits);
+}
+
+// Gets the count of a bin from the packed counts of the target holding it
+float unpackCount(vec4 counts, float bin) {
+    return mod(floor(dot(counts, getChannel(bin)) / getDigit(bin)), DIGIT_BASE);
+}
+
+void main() {
+    float bin = floor(gl_FragCoord.x);
+    vec4 result = vec4(0.0);
+
+    if (in_histogram_pass == HISTOGRAM_SEGMENTS) {
+        vec4 marchLow = vec4(0.0);
+        vec4 marchHigh = vec4(0.0);
+        vec4 shadowLow = vec4(0.0);
+        vec4 shadowHigh = vec4(0.0);
+
+        float y = gl_FragCoord.y / in_source_size.y;
+        float begin = floor(gl_FragCoord.x) * SEGMENT_LENGTH;
+        float end = min(begin + SEGMENT_LENGTH, in_source_size.x);
+
+        for (float x = begin + 0.5; x < end; x += 1.0) {
+            vec4 statistics = texture2D(in_source, vec2(x / in_source_size.x, y));
+            result += statistics;
+
+            if (statistics.z > 0.0) {
+                float march = getBin(statistics.x / statistics.z);
+                float shadow = getBin(statistics.y / statistics.z);
+
+                vec4 marchCount = getChannel(march) * getDigit(march);
+                vec4 shadowCount = getChannel(shadow) * getDigit(shadow);
+
+                if (march < 16.0) {
+                    marchLow += marchCount;
+                } else {
+                    marchHigh += marchCount;
+                }
+
+                if (shadow < 16.0) {
+                    shadowLow += shadowCount;
+                } else {
+                    shadowHigh += shadowCount;
+                }
+            }
+        }
+
+        gl_FragData[0] = marchLow;
+        gl_FragData[1] = marchHigh;
+        gl_FragData[2] = shadowLow;
+        gl_FragData[3] = shadowHigh;
+        gl_FragData[4] = result;
+    } else if (in_histogram_pass == HISTOGRAM_ROWS) {
+        float y = gl_FragCoord.y / in_source_size.y;
+
+        for (float x = 0.5; x < in_source_size.x; x += 1.0) {
+            vec2 coordinate = vec2(x / in_source_size.x, y);
+
+            if (bin >= in_bin_count) {
+                result += texture2D(in_totals, coordinate);
+            } else if (bin < 16.0) {
+                result.x += unpackCount(texture2D(in_march_bins_low, coordinate), bin);
+                result.y += unpackCount(texture2D(in_shadow_bins_low, coordinate), bin);
+            } else {
+                result.x += unpackCount(texture2D(in_march_bins_high, coordinate), bin);
+                result.y += unpackCount(texture2D(in_shadow_bins_high, coordinate), bin);
+            }
+        }
+
+        gl_FragData[0] = result;
+    } else {
+        for (float y = 0.5; y < in_source_size.y; y += 1.0) {
+            result += texture2D(in_source, vec2(gl_FragCoord.x / in_source_size.x, y / in_source_size.y));
+        }
+
+        gl_FragData[0] = result;
+    }
+}
@@ -0,0 +1,47 @@
+// Kaleidoscopic IFS with octahedral symmetry. Every iteration folds the point across the symmetry planes of an
+// octahedron, rotates it, and scales it away from the shift, which is the vertex of the octahedron kept fixed.
+
+#define KIFS_SIZE 2.0
+
+void kifsIterate(inout vec4 p) {
+    rotateZ(p, in_fractal_rotation_z);
+
+    if (p.x + p.y < 0.0) {
+        p.xy = -p.yx;
+    }
+
+    if (p.x + p.z < 0.0) {
+        p.xz = -p.zx;
+    }
+
+    if (p.x - p.y < 0.0) {
+        p.xy = p.yx;
+    }
+
+    if (p.x - p.z < 0.0) {
+        p.xz = p.zx;
+    }
+
+    rotateX(p, in_fractal_rotation_x);
+
+    p.xyz = p.xyz * in_fractal_scale - in_fractal_shift * (in_fractal_scale - 1.0);
+    p.w *= abs(in_fractal_scale);
+}
+
+vec4 fractalDistanceColour(vec4 p, vec3 pLow, float iterations) {
+    p = vec4((p.xyz + pLow) / KIFS_SIZE, 1.0);
+
+    vec3 orbit = vec3(0.0);
+
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        if (float(i) >= iterations) {
+            break;
+        }
+
+        kifsIterate(p);
+
+        orbit = max(orbit, abs(p.xyz) * in_fractal_color);
+    }
+
+    return vec4(orbit, length(p.xyz) / p.w * KIFS_SIZE);
+}
@@ -1,11 +1,91 @@
 #include "FractalPioneer.h"
+#include "FractalRenderer.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QStatusBar>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Explore 3D fractals and render keyframes along user defined waypoints.");
+    parser.addHelpOption();
+
+    QCommandLineOption renderOption("render",
+        "Animate all scenes in <scene-file> back-to-back and exit when finished.", "scene-file");
+    parser.addOption(renderOption);
+
+    QCommandLineOption sceneOption("scene",
+        "Load the scenes in <scene-file> before running the benchmark.", "scene-file");
+    parser.addOption(sceneOption);
+
+    QCommandLineOption benchmarkOption("benchmark",
+        "Benchmark the renderer on the waypoints of the loaded scenes, write the report to <report-file> and exit.",
+        "report-file");
+    parser.addOption(benchmarkOption);
+
+    QCommandLineOption cacheSizeOption("cache-size",
+        "Limit the render cache of previously drawn frames to <megabytes>, or disable it with 0. Defaults to 4096.",
+        "megabytes");
+    parser.addOption(cacheSizeOption);
+
+    QCommandLineOption backendOption("backend",
+        "Draw the fractal with the <backend> \"legacy\" fragment shader, or march it with the \"compute\" shader which "
+        "needs OpenGL 4.3. Defaults to legacy.",
+        "backend");
+    parser.addOption(backendOption);
+
+    parser.process(a);
+
+    // The backend decides the OpenGL context of every window, so it must be selected before any window is created
+    if (parser.isSet(backendOption)) {
+        FractalRenderer::Backend backend = FractalRenderer::BACKEND_LEGACY;
+
+        if (!FractalRenderer::findBackend(parser.value(backendOption), backend)) {
+            qWarning("Invalid backend \"%s\"", qPrintable(parser.value(backendOption)));
+            return 1;
+        }
+
+        FractalRenderer::setBackend(backend);
+    }
+
     FractalPioneer w;
+
+    if (parser.isSet(cacheSizeOption)) {
+        bool valid = false;
+        const qint64 megabytes = parser.value(cacheSizeOption).toLongLong(&valid);
+
+        if (!valid || megabytes < 0) {
+            qWarning("Invalid render cache size \"%s\"", qPrintable(parser.value(cacheSizeOption)));
+            return 1;
+        }
+
+        w.setRenderCacheCapacity(megabytes * 1024 * 1024);
+    }
+
+    if (parser.isSet(benchmarkOption)) {
+        if (parser.isSet(sceneOption) && !w.openScene(parser.value(sceneOption))) {
+            qWarning("%s", qPrintable(w.statusBar()->currentMessage()));
+            return 1;
+        }
+
+        return w.runBenchmark(parser.value(benchmarkOption)) ? 0 : 1;
+    }
+
     w.show();
+
+    if (parser.isSet(renderOption)) {
+        QObject::connect(w.getRenderQueue(), &RenderQueue::finished, &a, &QApplication::quit);
+
+        // Unattended renders which were cancelled exit as failed rather than waiting for a queue which never finishes
+        QObject::connect(w.getRenderQueue(), &RenderQueue::stopped, &a, []() { QApplication::exit(1); });
+
+        if (!w.renderScenes(parser.value(renderOption))) {
+            return 1;
+        }
+    }
+
     return a.exec();
 }
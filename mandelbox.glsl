@@ -0,0 +1,36 @@
+// Mandelbox. Every iteration folds the point into a box, inverts it in a sphere, rotates it, and scales it about the
+// original point offset by the shift. The w component of the point tracks the running derivative.
+
+#define MANDELBOX_MIN_RADIUS2 0.25
+#define MANDELBOX_FIXED_RADIUS2 1.0
+
+void mandelboxIterate(inout vec4 p, vec3 c) {
+    p.xyz = clamp(p.xyz, -1.0, 1.0) * 2.0 - p.xyz;
+
+    float r2 = dot(p.xyz, p.xyz);
+    p *= MANDELBOX_FIXED_RADIUS2 / clamp(r2, MANDELBOX_MIN_RADIUS2, MANDELBOX_FIXED_RADIUS2);
+
+    rotateZ(p, in_fractal_rotation_z);
+    rotateX(p, in_fractal_rotation_x);
+
+    p = p * vec4(vec3(in_fractal_scale), abs(in_fractal_scale)) + vec4(c + in_fractal_shift, 1.0);
+}
+
+vec4 fractalDistanceColour(vec4 p, vec3 pLow, float iterations) {
+    vec3 c = p.xyz + pLow;
+    p = vec4(c, 1.0);
+
+    vec3 orbit = vec3(0.0);
+
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        if (float(i) >= iterations) {
+            break;
+        }
+
+        mandelboxIterate(p, c);
+
+        orbit = max(orbit, abs(p.xyz) * in_fractal_color);
+    }
+
+    return vec4(orbit, length(p.xyz) / abs(p.w));
+}
@@ -0,0 +1,40 @@
+// Mandelbulb. The scale is the power of the bulb, the shift is added to the constant of every iteration, and the
+// rotation is applied to the point after every iteration.
+
+#define MANDELBULB_SIZE 2.0
+#define MANDELBULB_BAILOUT 2.0
+
+void mandelbulbIterate(inout vec4 z, inout float dr, vec3 c) {
+    float r = length(z.xyz);
+    float theta = acos(clamp(z.z / r, -1.0, 1.0)) * in_fractal_scale;
+    float phi = atan(z.y, z.x) * in_fractal_scale;
+    float rn = pow(r, in_fractal_scale - 1.0);
+
+    dr = rn * abs(in_fractal_scale) * dr + 1.0;
+    z.xyz = rn * r * vec3(sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta)) + c + in_fractal_shift;
+
+    rotateZ(z, in_fractal_rotation_z);
+    rotateX(z, in_fractal_rotation_x);
+}
+
+vec4 fractalDistanceColour(vec4 p, vec3 pLow, float iterations) {
+    vec3 c = (p.xyz + pLow) / MANDELBULB_SIZE;
+    vec4 z = vec4(c, 1.0);
+    float dr = 1.0;
+
+    vec3 orbit = vec3(0.0);
+
+    // The estimate relies on the escape radius being reached, so fewer iterations only smooth the surface
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        if (float(i) >= iterations || dot(z.xyz, z.xyz) > MANDELBULB_BAILOUT * MANDELBULB_BAILOUT) {
+            break;
+        }
+
+        mandelbulbIterate(z, dr, c);
+
+        orbit = max(orbit, abs(z.xyz) * in_fractal_color);
+    }
+
+    float r = max(length(z.xyz), 1e-6);
+    return vec4(orbit, 0.5 * log(r) * r / dr * MANDELBULB_SIZE);
+}
@@ -0,0 +1,111 @@
+// Original Copyright HackerPoet/MarbleMarcher (https://github.com/HackerPoet/MarbleMarcher).
+//
+// The following code is a derivative work of the code from the MarbleMarcher project,
+// which is licensed GPLv2. This code therefore is also licensed under the terms
+// of the GNU Public License, verison 2.
+//
+// For information on the license of this code when distributed with and used
+// in conjunction with the other modules in the MarbleMarcher project, please see
+// the root-level LICENSE file.
+
+// Menger sponge style IFS. Every iteration folds the point into the positive octant, sorts its coordinates, rotates
+// it, and scales it about the shift. Iterations can run in double-float precision in deep zoom mode.
+
+void mengerFold(inout vec4 p) {
+    float dxy = min(p.x - p.y, 0.0);
+    p += vec4(-dxy, +dxy, 0.0, 0.0);
+    float dxz = min(p.x - p.z, 0.0);
+    p += vec4(-dxz, 0.0, +dxz, 0.0);
+    float dyz = min(p.y - p.z, 0.0);
+    p += vec4(0.0, -dyz, +dyz, 0.0);
+}
+
+void dfMengerFold(inout vec3 hi, inout vec3 lo) {
+    // Each fold of mengerFold swaps a pair of coordinates if they are out of order, which is exact in any precision
+    if (dfLess(hi.x, lo.x, hi.y, lo.y)) {
+        hi.xy = hi.yx;
+        lo.xy = lo.yx;
+    }
+
+    if (dfLess(hi.x, lo.x, hi.z, lo.z)) {
+        hi.xz = hi.zx;
+        lo.xz = lo.zx;
+    }
+
+    if (dfLess(hi.y, lo.y, hi.z, lo.z)) {
+        hi.yz = hi.zy;
+        lo.yz = lo.zy;
+    }
+}
+
+// Distance estimate to a 6.0 box scaled by the accumulated fractal scale
+float boxDistanceEstimate(vec4 p) {
+    vec3 a = abs(p.xyz) - 6.0;
+    return (min(max(max(a.x, a.y), a.z), 0.0) + length(max(a, 0.0))) / p.w;
+}
+
+vec4 fractalDistanceColour(vec4 p, vec3 pLow, float iterations) {
+    vec3 orbit = vec3(0.0);
+    int n = 0;
+
+    if (in_deep_zoom) {
+        // The first iterations resolve the finest detail relative to the size of the fractal, so they are computed in
+        // double-float precision. Every iteration magnifies the point by the fractal scale, and once the detail being
+        // resolved is large enough the remaining iterations continue in float precision.
+        vec3 hi = p.xyz;
+        vec3 lo = pLow;
+
+        for (; n < MAX_ITERATIONS; ++n) {
+            if (n >= in_deep_zoom_iterations) {
+                break;
+            }
+
+            dfAbs(hi, lo);
+            dfRotateZ(hi, lo, in_fractal_rotation_z);
+            dfMengerFold(hi, lo);
+            dfRotateX(hi, lo, in_fractal_rotation_x);
+
+            dfMul(hi, lo, in_fractal_scale);
+            dfAdd(hi, lo, in_fractal_shift, vec3(0.0));
+            p.w *= in_fractal_scale;
+
+            orbit = max(orbit, hi * in_fractal_color);
+        }
+
+        p.xyz = hi + lo;
+    } else {
+        p.xyz += pLow;
+    }
+
+    // Blend between the estimates after the whole iteration counts either side of the requested level of detail so
+    // that detail fades in smoothly instead of popping as the camera approaches
+    int coarseIterations = int(iterations);
+    float blend = iterations - float(coarseIterations);
+    int fineIterations = blend > 0.0 ? coarseIterations + 1 : coarseIterations;
+
+    float coarse = 0.0;
+
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        if (i >= fineIterations) {
+            break;
+        }
+
+        if (i >= n) {
+            p = abs(p);
+            rotateZ(p, in_fractal_rotation_z);
+            mengerFold(p);
+            rotateX(p, in_fractal_rotation_x);
+
+            p *= vec4(in_fractal_scale);
+            p += vec4(in_fractal_shift, 0.0);
+
+            orbit = max(orbit, p.xyz * in_fractal_color);
+        }
+
+        if (i + 1 == coarseIterations) {
+            coarse = boxDistanceEstimate(p);
+        }
+    }
+
+    return vec4(orbit, mix(coarse, boxDistanceEstimate(p), blend));
+}
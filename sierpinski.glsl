@@ -0,0 +1,43 @@
+// Sierpinski tetrahedron. Every iteration folds the point across the symmetry planes of a tetrahedron, rotates it, and
+// scales it away from the shift, which is the vertex of the tetrahedron kept fixed.
+
+#define SIERPINSKI_SIZE 2.0
+
+void sierpinskiIterate(inout vec4 p) {
+    rotateZ(p, in_fractal_rotation_z);
+
+    if (p.x + p.y < 0.0) {
+        p.xy = -p.yx;
+    }
+
+    if (p.x + p.z < 0.0) {
+        p.xz = -p.zx;
+    }
+
+    if (p.y + p.z < 0.0) {
+        p.zy = -p.yz;
+    }
+
+    rotateX(p, in_fractal_rotation_x);
+
+    p.xyz = p.xyz * in_fractal_scale - in_fractal_shift * (in_fractal_scale - 1.0);
+    p.w *= abs(in_fractal_scale);
+}
+
+vec4 fractalDistanceColour(vec4 p, vec3 pLow, float iterations) {
+    p = vec4((p.xyz + pLow) / SIERPINSKI_SIZE, 1.0);
+
+    vec3 orbit = vec3(0.0);
+
+    for (int i = 0; i < MAX_ITERATIONS; ++i) {
+        if (float(i) >= iterations) {
+            break;
+        }
+
+        sierpinskiIterate(p);
+
+        orbit = max(orbit, abs(p.xyz) * in_fractal_color);
+    }
+
+    return vec4(orbit, length(p.xyz) / p.w * SIERPINSKI_SIZE);
+}
@@ -0,0 +1,22 @@
+#version 120
+
+// Maps the linear colour of a frame, as drawn by the fractal shader before exposure, to the colour written to the
+// output. Exposure is applied here rather than in the fractal shader so that changing it only reruns this pass.
+
+uniform sampler2D in_frame;
+uniform vec2 in_resolution;
+
+uniform float in_fractal_exposure;
+
+// Determines whether the colour is clamped to the displayable range, which linear float output keeps unbounded
+uniform bool in_tone_mapping;
+
+void main() {
+    vec3 colour = texture2D(in_frame, gl_FragCoord.xy / in_resolution).xyz * in_fractal_exposure;
+
+    if (in_tone_mapping) {
+        colour = clamp(colour, 0.0, 1.0);
+    }
+
+    gl_FragColor = vec4(colour, 1.0);
+}